@@ -0,0 +1,113 @@
+# include "../de.h"
+
+/*------------------------Fixed vs self-adaptive F and CR---------------*/
+/*------Evaluations needed to reach cost 1e-8 on the sphere, Rosen-----*/
+/*------brock's valley and Rastrigin's function (D=10, NP=50), for------*/
+/*------strategies 1..10 with the classic F=0.5, CR=0.9, and for jDE----*/
+/*------and SHADE, with and without population size reduction, on------*/
+/*------DE/rand/1/bin and DE/rand-to-best/1/bin. Mean NFEs over the-----*/
+/*------successful runs and the success rate over the seeds are--------*/
+/*------printed; a run fails after 5000*D evaluations.-----------------*/
+/*                                                                      */
+/*------cc -O2 bench/adapt.c de[a-z]*.c -lm -lpthread; ./a.out [seeds]-*/
+
+#define MAXNFE_D 5000     /* evaluation budget per parameter    */
+
+
+static double sphere(int D, const double x[], void *user)
+{
+   double s = 0;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j];
+   return s;
+}
+
+
+static double rosenbrock(int D, const double x[], void *user)
+{
+   double s = 0, a, b;
+   int j;
+
+   for (j=0; j<D-1; j++)
+   {
+      a  = x[j+1] - x[j]*x[j];
+      b  = 1.0 - x[j];
+      s += 100.0*a*a + b*b;
+   }
+   return s;
+}
+
+
+static double rastrigin(int D, const double x[], void *user)
+{
+   double s = 10.0*D;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j] - 10.0*cos(2.0*M_PI*x[j]);
+   return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+   static struct { char *name; de_objective fn; double bound; } fns[] =
+   {
+      {"sphere",     sphere,     5.12},
+      {"rosenbrock", rosenbrock, 2.048},
+      {"rastrigin",  rastrigin,  5.12},
+   };
+   static struct { int strategy, adapt, lpsr; } runs[] =
+   {
+      {1,0,0}, {2,0,0}, {3,0,0}, {4,0,0}, {5,0,0},
+      {6,0,0}, {7,0,0}, {8,0,0}, {9,0,0}, {10,0,0},
+      {7,DE_ADAPT_JDE,0},   {8,DE_ADAPT_JDE,0},
+      {7,DE_ADAPT_SHADE,0}, {8,DE_ADAPT_SHADE,0},
+      {7,DE_ADAPT_SHADE,1}, {8,DE_ADAPT_SHADE,1},
+   };
+   int nseed = (argc > 1) ? atoi(argv[1]) : 10;
+   de_config cfg;
+   de_result res;
+   double sum;
+   int f, r, s, ok;
+
+   de_defaults(&cfg);
+   cfg.D      = 10;
+   cfg.NP     = 50;
+   cfg.genmax = 1000000;
+   cfg.F      = 0.5;
+   cfg.CR     = 0.9;
+   cfg.vtr    = 1e-8;
+   cfg.max_nfeval = MAXNFE_D*cfg.D;
+   res.best   = NULL;
+
+   printf("%-12s %-24s %-6s %-4s %10s %8s\n","function","strategy","adapt",
+          "lpsr","mean NFE","success");
+   for (f=0; f<3; f++)
+   {
+      cfg.inibound_h =  fns[f].bound;
+      cfg.inibound_l = -fns[f].bound;
+      for (r=0; r<(int)(sizeof(runs)/sizeof(runs[0])); r++)
+      {
+         cfg.strategy = runs[r].strategy;
+         cfg.adapt    = runs[r].adapt;
+         cfg.np_min   = runs[r].lpsr ? 5 : 0;
+         sum = 0;
+         ok  = 0;
+         for (s=1; s<=nseed; s++)
+         {
+            cfg.seed = s;
+            if (de_solve(&cfg,fns[f].fn,NULL,&res) != DE_OK) return 1;
+            if (res.stop == DE_STOP_VTR)
+            {
+               sum += res.nfeval;
+               ok++;
+            }
+         }
+         printf("%-12s %-24s %-6s %-4s %10.0f %7.0f%%\n",fns[f].name,
+                de_strat[cfg.strategy],de_adapt_name[cfg.adapt],
+                runs[r].lpsr ? "yes" : "no",ok ? sum/ok : 0.0,100.0*ok/nseed);
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,65 @@
+# include "../de.h"
+# include <time.h>
+
+/*------------------------Synchronous vs asynchronous throughput--------*/
+/*------The objective is the dj9 sphere plus a sleep of 0.05..2 ms-----*/
+/*------(a heavy tail, like our 50 ms..20 s simulations scaled down),---*/
+/*------so threads are kept busy even on a small machine. Reports-------*/
+/*------evaluations/s, utilization and the final cost of both modes.----*/
+/*                                                                      */
+/*------cc -O2 bench/async.c de[a-z]*.c -lm -lpthread------------------*/
+
+
+static double slow_sphere(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Sphere with an evaluation time that depends on x: mostly short,  **
+** sometimes 40 times longer.                                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0, h;
+   struct timespec ts;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j];
+   h = fabs(sin(1e4*x[0]));                /* pseudo random in [0,1] */
+   ts.tv_sec  = 0;
+   ts.tv_nsec = (long)(50000 + 1950000*h*h*h*h*h*h);
+   nanosleep(&ts,NULL);
+   return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+   static int threads[] = {1, 4, 16};
+   de_config cfg;
+   de_result res;
+   int t, m;
+
+   de_defaults(&cfg);
+   cfg.strategy = 7;
+   cfg.D        = 10;
+   cfg.NP       = 32;
+   cfg.genmax   = (argc > 1) ? atoi(argv[1]) : 20;
+   cfg.F        = 0.7;
+   cfg.CR       = 0.9;
+   cfg.rng      = DE_RNG_XOSHIRO;
+   res.best     = NULL;
+
+   printf("%-6s %8s %10s %12s %12s %14s\n","mode","threads","wall s",
+          "evals/s","utilization","cmin");
+   for (t=0; t<3; t++)
+   {
+      for (m=DE_MODE_SYNC; m<=DE_MODE_ASYNC; m++)
+      {
+         cfg.threads = threads[t];
+         cfg.mode    = m;
+         if (de_solve(&cfg,slow_sphere,NULL,&res) != DE_OK) return 1;
+         printf("%-6s %8d %10.3f %12.1f %12.3f %14.6g\n",de_mode_name[m],
+                cfg.threads,res.wall,res.evals_per_sec,res.utilization,res.cmin);
+      }
+   }
+   return 0;
+}
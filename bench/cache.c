@@ -0,0 +1,98 @@
+# include "../de.h"
+# include <time.h>
+
+/*------------------------Quantization and evaluation cache-------------*/
+/*------An integer problem: a shifted Rosenbrock valley over integers---*/
+/*------in [-30,30]^D, D=8, plus a sleep of 0.2 ms per evaluation to-----*/
+/*------stand for a simulation. DE/rand/1/bin, NP=40, 4 threads, 300----*/
+/*------generations, continuous and on the integer grid (--quant=1)----*/
+/*------with caches of several sizes, in both modes. Per setting:-------*/
+/*------evaluations, cache hits, final cost and wall time, mean of 5----*/
+/*------seeds.-----------------------------------------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/cache.c de[a-z]*.c -lm -lpthread; ./a.out [gens]--*/
+
+#define NSEED 5
+
+
+static double int_rosen(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Rosenbrock's valley shifted to have its minimum 0 at x = 3,      **
+** rounded to integers, and a 0.2 ms sleep.                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0, a, b;
+   struct timespec ts;
+   int j;
+
+   for (j=0; j<D-1; j++)
+   {
+      a = floor(x[j] + 0.5) - 2;
+      b = floor(x[j+1] + 0.5) - 2;
+      s += 100*(b - a*a)*(b - a*a) + (1 - a)*(1 - a);
+   }
+   ts.tv_sec  = 0;
+   ts.tv_nsec = 200000;
+   nanosleep(&ts,NULL);
+   return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+   static long caches[] = {-1, 0, 256, 4096, 65536};
+   double step[8], lo[8], hi[8], nfe, hit, cost, wall;
+   de_config cfg;
+   de_result res;
+   int j, c, m, s;
+
+   de_defaults(&cfg);
+   cfg.strategy = 7;
+   cfg.D        = 8;
+   cfg.NP       = 40;
+   cfg.genmax   = (argc > 1) ? atoi(argv[1]) : 300;
+   cfg.F        = 0.5;
+   cfg.CR       = 0.9;
+   cfg.rng      = DE_RNG_XOSHIRO;
+   cfg.threads  = 4;
+   cfg.bound    = DE_BOUND_REFLECT;
+   for (j=0; j<cfg.D; j++)
+   {
+      step[j] = 1;
+      lo[j]   = -30;
+      hi[j]   = 30;
+   }
+   cfg.lo       = lo;
+   cfg.hi       = hi;
+   res.best     = NULL;
+
+   printf("%-6s %-10s %10s %10s %12s %8s\n","mode","grid/cache","NFEs",
+          "hits","cost","wall s");
+   for (m=DE_MODE_SYNC; m<=DE_MODE_ASYNC; m++)
+   {
+      for (c=0; c<(int)(sizeof(caches)/sizeof(caches[0])); c++)
+      {
+         cfg.quant = (caches[c] < 0) ? NULL : step;
+         cfg.cache = (caches[c] < 0) ? 0 : caches[c];
+         cfg.mode  = m;
+         nfe = hit = cost = wall = 0;
+         for (s=1; s<=NSEED; s++)
+         {
+            cfg.seed = s;
+            if (de_solve(&cfg,int_rosen,NULL,&res) != DE_OK) return 1;
+            nfe  += res.nfeval;
+            hit  += res.nhit;
+            cost += res.cmin;
+            wall += res.wall;
+         }
+         if (caches[c] < 0) printf("%-6s %-10s",de_mode_name[m],"none");
+         else               printf("%-6s 1/%-8ld",de_mode_name[m],caches[c]);
+         printf(" %10.0f %10.0f %12.4g %8.3f\n",nfe/NSEED,hit/NSEED,
+                cost/NSEED,wall/NSEED);
+         fflush(stdout);
+      }
+   }
+   return 0;
+}
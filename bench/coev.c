@@ -0,0 +1,82 @@
+# include "../de.h"
+
+/*------------------------Cooperative coevolution-----------------------*/
+/*------Shifted test functions, separable (sphere, rastrigin) and not---*/
+/*------(rosenbrock, ackley), with the same number of evaluations:------*/
+/*------plain DE over all D parameters against cooperative coevolution--*/
+/*------with fixed, random and differential grouping; the last only-----*/
+/*------while grouping takes at most half the budget. DE/rand/1/bin,----*/
+/*------F=0.5, CR=0.9, xoshiro streams, one seed. Per function and------*/
+/*------solver: final cost, cycles (generations for plain DE), number---*/
+/*------of evaluations and wall time.-------------------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/coev.c de[a-z]*.c -lm -lpthread; ./a.out [D nfe]---*/
+/*------default D=1000, nfe=1000*D; threads for parallel subcomponents,-*/
+/*------default 1, as a third argument.----------------------------------*/
+
+
+int main(int argc, char *argv[])
+{
+   static char *names[] = {"sphere", "rastrigin", "rosenbrock", "ackley"};
+   static char *solver[] = {"plain", "fixed", "random", "diff"};
+   const de_func *f;
+   de_problem *prob;
+   de_coev_config cc;
+   de_config cfg;
+   de_result res;
+   long nfe;
+   int D, n, s, ret;
+
+   D   = (argc > 1) ? atoi(argv[1]) : 1000;
+   nfe = (argc > 2) ? atol(argv[2]) : 1000L*D;
+   de_defaults(&cfg);
+   cfg.D          = D;
+   cfg.strategy   = 7;
+   cfg.F          = 0.5;
+   cfg.CR         = 0.9;
+   cfg.rng        = DE_RNG_XOSHIRO;
+   cfg.threads    = (argc > 3) ? atoi(argv[3]) : 1;
+   cfg.seed       = 1;
+   cfg.max_nfeval = nfe;
+   res.best       = NULL;
+   cc.size        = 50;
+   cc.gens        = 50;
+   cc.cycles      = 1000000;
+   cc.parallel    = (cfg.threads > 1);
+   cc.eps         = 1e-3;
+
+   printf("D=%d  NFEs=%ld  threads=%d  subcomponents of %d, %d generations\n",
+          D,nfe,cfg.threads,cc.size,cc.gens);
+   printf("%-11s %-7s %14s %9s %11s %9s\n","function","solver","cost","cycles",
+          "NFEs","wall s");
+   for (n=0; n<(int)(sizeof(names)/sizeof(names[0])); n++)
+   {
+      f    = de_func_find(names[n]);
+      prob = de_problem_create(f,D,0,1);
+      if (prob == NULL) return 1;
+      cfg.inibound_l = f->lo;
+      cfg.inibound_h = f->hi;
+      for (s=0; s<4; s++)
+      {
+         if (s == 3 && (double)D*D/2 > nfe/2) continue;
+         if (s == 0)
+         {
+            cfg.NP     = 100;
+            cfg.genmax = 1000000000;
+            ret = de_solve(&cfg,de_problem_eval,prob,&res);
+         }
+         else
+         {
+            cfg.NP      = 30;
+            cc.grouping = s-1;
+            ret = de_coev(&cc,&cfg,de_problem_eval,prob,&res);
+         }
+         if (ret != DE_OK) return 1;
+         printf("%-11s %-7s %14.6g %9d %11ld %9.2f\n",names[n],solver[s],
+                res.cmin,res.gen,res.nfeval,res.wall);
+         fflush(stdout);
+      }
+      de_problem_free(prob);
+   }
+   return 0;
+}
@@ -0,0 +1,80 @@
+# include "../de.h"
+
+/*------------------------Full vs incremental evaluation----------------*/
+/*------dj9's sum of squares at D=1000, NP=100, through evaluate() and--*/
+/*------through evaluate_delta(), which only resums the blocks of 32----*/
+/*------parameters a trial changed. For the exponential strategies and--*/
+/*------DE/rand/1/bin as a reference, at several CR, the time per-------*/
+/*------evaluation spent in the objective and in the whole run is-------*/
+/*------printed together with the mean length L of the changed span----*/
+/*------and the best costs, which agree up to rounding.-----------------*/
+/*                                                                      */
+/*------cc -O2 bench/delta.c de[a-z]*.c dj9.c -lm -lpthread; ./a.out----*/
+/*------[D] [genmax]---------------------------------------------------*/
+
+double extern evaluate(int D, double tmp[], long *nfeval);
+double extern evaluate_delta(int D, const double tmp[], int lo, int len,
+                             const double *pstate, double *state);
+int    extern evaluate_delta_state(int D);
+
+
+static double full(int D, const double x[], void *user)
+{
+   return evaluate(D,(double *)x,NULL);
+}
+
+
+static double delta(int D, const double x[], int lo, int len,
+                    const double *pstate, double *state, void *user)
+{
+   if (pstate != NULL) *(long *)user += len;   /* not the initial ones */
+   return evaluate_delta(D,x,lo,len,pstate,state);
+}
+
+
+int main(int argc, char *argv[])
+{
+   static int    strategies[] = {1, 2, 3, 4, 5, 7};
+   static double crs[] = {0.5, 0.9, 0.99};
+   de_config cfg;
+   de_result rf, rd;
+   long   nlen;
+   double obj_f, obj_d;
+   int s, c;
+
+   de_defaults(&cfg);
+   cfg.D      = (argc > 1) ? atoi(argv[1]) : 1000;
+   cfg.genmax = (argc > 2) ? atoi(argv[2]) : 500;
+   cfg.NP     = 100;
+   cfg.F      = 0.5;
+   cfg.seed   = 7;
+   rf.best = rd.best = NULL;
+
+   printf("%-22s %5s %7s %12s %12s %8s %12s %12s %13s %13s\n","strategy","CR",
+          "mean L","full ns/eval","delta ns/ev","speedup","full run ns","delta run ns",
+          "full cmin","delta cmin");
+   for (s=0; s<(int)(sizeof(strategies)/sizeof(strategies[0])); s++)
+   {
+      for (c=0; c<(int)(sizeof(crs)/sizeof(crs[0])); c++)
+      {
+         cfg.strategy    = strategies[s];
+         cfg.CR          = crs[c];
+         cfg.delta       = NULL;
+         cfg.delta_state = 0;
+         if (de_solve(&cfg,full,NULL,&rf) != DE_OK) return 1;
+
+         nlen = 0;
+         cfg.delta       = delta;
+         cfg.delta_state = evaluate_delta_state(cfg.D);
+         if (de_solve(&cfg,NULL,&nlen,&rd) != DE_OK) return 1;
+
+         obj_f = 1e9*rf.utilization*rf.wall/rf.nfeval;   /* inside the objective */
+         obj_d = 1e9*rd.utilization*rd.wall/rd.nfeval;
+         printf("%-22s %5.2f %7.1f %12.1f %12.1f %7.1fx %12.1f %12.1f %13.6g %13.6g\n",
+                de_strat[cfg.strategy],cfg.CR,(double)nlen/(rd.nfeval-cfg.NP),obj_f,obj_d,
+                obj_f/obj_d,1e9*rf.wall/rf.nfeval,1e9*rd.wall/rd.nfeval,
+                rf.cmin,rd.cmin);
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,142 @@
+# include "../de.h"
+# include <string.h>
+
+/*------------------------Performance and convergence harness-----------*/
+/*------Sweeps test functions x strategies 1..10 x D x NP x seeds and---*/
+/*------prints one CSV line per function, strategy, D and NP:----------*/
+/*------  ns per generation and evaluations/s (engine throughput),------*/
+/*------  mean NFEs of the runs that reached vtr and their share.-------*/
+/*------NFEs and success are deterministic for given seeds, so two------*/
+/*------versions can be compared line by line; the timings show---------*/
+/*------throughput regressions.-----------------------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/harness.c de[a-z]*.c -lm -lpthread -o harness-----*/
+/*------./harness [--functions=sphere,rotated-rastrigin] [--dims=10,30]-*/
+/*------          [--np=5,10] [--seeds=5] [--vtr=1e-8] [--nfe-per-d=5000]*/
+/*------          [--F=0.5] [--CR=0.9] [--adapt=0|1|2] [--threads=1]----*/
+/*--------np gives NP as multiples of D.-------------------------------*/
+
+#define MAXLIST 32
+
+
+static int list(const char *s, double v[])
+/**C*F****************************************************************
+**                                                                  **
+** Reads the comma separated numbers s into v. Returns their count. **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char *end;
+   int n = 0;
+
+   while (n < MAXLIST)
+   {
+      v[n++] = strtod(s,&end);
+      if (*end != ',') break;
+      s = end + 1;
+   }
+   return n;
+}
+
+
+int main(int argc, char *argv[])
+{
+   char   fnames[512] = "sphere,rosenbrock,rastrigin";
+   char   *name, *save;
+   double dims[MAXLIST] = {10}, nps[MAXLIST] = {5, 10};
+   int    ndim = 1, nnp = 2, nseed = 5, per_d = 5000;
+   const de_func *f;
+   de_problem *prob;
+   de_config cfg;
+   de_result res;
+   double wall, gens, evals, nfe;
+   int    k, d, n, st, s, ok, shift, rotate;
+
+   de_defaults(&cfg);
+   cfg.F      = 0.5;
+   cfg.CR     = 0.9;
+   cfg.vtr    = 1e-8;
+   cfg.rng    = DE_RNG_XOSHIRO;
+   cfg.genmax = 1000000;
+   res.best   = NULL;
+
+   for (k=1; k<argc; k++)
+   {
+      if      (strncmp(argv[k],"--functions=",12) == 0)
+      {
+         strncpy(fnames,argv[k]+12,sizeof(fnames)-1);
+      }
+      else if (strncmp(argv[k],"--dims=",7) == 0)  ndim  = list(argv[k]+7,dims);
+      else if (strncmp(argv[k],"--np=",5) == 0)    nnp   = list(argv[k]+5,nps);
+      else if (strncmp(argv[k],"--seeds=",8) == 0) nseed = atoi(argv[k]+8);
+      else if (strncmp(argv[k],"--vtr=",6) == 0)   cfg.vtr = atof(argv[k]+6);
+      else if (strncmp(argv[k],"--nfe-per-d=",12) == 0) per_d = atoi(argv[k]+12);
+      else if (strncmp(argv[k],"--F=",4) == 0)     cfg.F  = atof(argv[k]+4);
+      else if (strncmp(argv[k],"--CR=",5) == 0)    cfg.CR = atof(argv[k]+5);
+      else if (strncmp(argv[k],"--adapt=",8) == 0) cfg.adapt = atoi(argv[k]+8);
+      else if (strncmp(argv[k],"--threads=",10) == 0) cfg.threads = atoi(argv[k]+10);
+      else
+      {
+         printf("\nError! unknown option %s\n",argv[k]);
+         exit(1);
+      }
+   }
+
+   printf("function,strategy,D,NP,seeds,ns_per_gen,evals_per_s,mean_nfe_vtr,success\n");
+   for (name=strtok_r(fnames,",",&save); name!=NULL; name=strtok_r(NULL,",",&save))
+   {
+      shift = rotate = 0;
+      f = NULL;
+      if (strncmp(name,"shifted-",8) == 0)      f = de_func_find(name+8), shift = 1;
+      else if (strncmp(name,"rotated-",8) == 0) f = de_func_find(name+8), shift = rotate = 1;
+      else f = de_func_find(name);
+      if (f == NULL)
+      {
+         printf("\nError! unknown function %s\n",name);
+         exit(1);
+      }
+      cfg.inibound_l = f->lo;
+      cfg.inibound_h = f->hi;
+
+      for (d=0; d<ndim; d++)
+      {
+         cfg.D = (int)dims[d];
+         cfg.max_nfeval = (long)per_d*cfg.D;
+         prob = shift ? de_problem_create(f,cfg.D,rotate,1) : NULL;
+         for (n=0; n<nnp; n++)
+         {
+            cfg.NP = (int)(nps[n]*cfg.D);
+            for (st=1; st<=10; st++)
+            {
+               cfg.strategy = st;
+               wall = gens = evals = nfe = 0;
+               ok = 0;
+               for (s=1; s<=nseed; s++)
+               {
+                  cfg.seed = s;
+                  if (de_solve(&cfg,shift ? de_problem_eval : f->fn,prob,&res) != DE_OK)
+                  {
+                     printf("\nde_solve() failed\n");
+                     exit(1);
+                  }
+                  wall  += res.wall;
+                  gens  += res.gen;
+                  evals += res.nfeval;
+                  if (res.stop == DE_STOP_VTR)
+                  {
+                     nfe += res.nfeval;
+                     ok++;
+                  }
+               }
+               printf("%s,%d,%d,%d,%d,%.1f,%.1f,%.1f,%.3f\n",name,st,cfg.D,
+                      cfg.NP,nseed,gens > 0 ? 1e9*wall/gens : 0.0,
+                      wall > 0 ? evals/wall : 0.0,ok ? nfe/ok : 0.0,
+                      (double)ok/nseed);
+               fflush(stdout);
+            }
+         }
+         de_problem_free(prob);
+      }
+   }
+   return 0;
+}
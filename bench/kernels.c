@@ -0,0 +1,192 @@
+# include "../de.h"
+# include <time.h>
+
+/*------------------------Kernel microbenchmark-------------------------*/
+/*------Compares ns per trial vector of the de_kernels[] against the----*/
+/*------strategy chain of de36.c 3.6, for every strategy and D in-------*/
+/*------{10,100,1000}. Both draw from ran2 with the same seed, so the---*/
+/*------trials must agree bit for bit; an untimed pass compares every---*/
+/*------trial and reports a mismatch. The last column runs the kernels--*/
+/*------with the xoshiro generator.-------------------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/kernels.c de[a-z]*.c -lm -lpthread----------------*/
+
+#define NPOP   64         /* rows to pick r1..r5 from           */
+#define NTRIAL 200000     /* trials per measurement at D=10     */
+
+
+static void assignd(int D, double a[], const double b[])
+{
+   int j;
+   for (j=0; j<D; j++)
+   {
+      a[j] = b[j];
+   }
+}
+
+
+static void legacy(int strategy, de_trial *t, rnd_state *rnd)
+/**C*F****************************************************************
+**                                                                  **
+** The strategy chain of de36.c version 3.6, one trial vector.      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = t->D, L, n;
+   double F = t->F, CR = t->CR;
+   const double *bestit = t->bestit;
+   const double *p1 = t->p1, *p2 = t->p2, *p3 = t->p3, *p4 = t->p4;
+   const double *p5 = t->p5;
+   double *tmp = t->tmp;
+
+   assignd(D,tmp,t->old);
+   n = (int)(rnd_uni(rnd)*D);
+   if (strategy <= 5)
+   {
+      L = 0;
+      do
+      {
+         if (strategy == 1)
+            tmp[n] = bestit[n] + F*(p2[n]-p3[n]);
+         else if (strategy == 2)
+            tmp[n] = p1[n] + F*(p2[n]-p3[n]);
+         else if (strategy == 3)
+            tmp[n] = tmp[n] + F*(bestit[n] - tmp[n]) + F*(p1[n]-p2[n]);
+         else if (strategy == 4)
+            tmp[n] = bestit[n] + (p1[n]+p2[n]-p3[n]-p4[n])*F;
+         else
+            tmp[n] = p5[n] + (p1[n]+p2[n]-p3[n]-p4[n])*F;
+         n = (n+1)%D;
+         L++;
+      }while((rnd_uni(rnd) < CR) && (L < D));
+      return;
+   }
+   for (L=0; L<D; L++) /* perform D binomial trials */
+   {
+      if ((rnd_uni(rnd) < CR) || L == (D-1)) /* change at least one parameter */
+      {
+         if (strategy == 6)
+            tmp[n] = bestit[n] + F*(p2[n]-p3[n]);
+         else if (strategy == 7)
+            tmp[n] = p1[n] + F*(p2[n]-p3[n]);
+         else if (strategy == 8)
+            tmp[n] = tmp[n] + F*(bestit[n] - tmp[n]) + F*(p1[n]-p2[n]);
+         else if (strategy == 9)
+            tmp[n] = bestit[n] + (p1[n]+p2[n]-p3[n]-p4[n])*F;
+         else
+            tmp[n] = p5[n] + (p1[n]+p2[n]-p3[n]-p4[n])*F;
+      }
+      n = (n+1)%D;
+   }
+}
+
+
+static double now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+   return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+
+static void setup(de_trial *t, double *pop, size_t stride, int k)
+/**C*F****************************************************************
+**                                                                  **
+** Points t at rows of pop for trial number k.                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   t->old    = pop + (size_t)( k    % NPOP)*stride;
+   t->bestit = pop + (size_t)((k+1) % NPOP)*stride;
+   t->p1     = pop + (size_t)((k+2) % NPOP)*stride;
+   t->p2     = pop + (size_t)((k+3) % NPOP)*stride;
+   t->p3     = pop + (size_t)((k+5) % NPOP)*stride;
+   t->p4     = pop + (size_t)((k+7) % NPOP)*stride;
+   t->p5     = pop + (size_t)((k+11)% NPOP)*stride;
+}
+
+
+int main(void)
+{
+   static int Ds[] = {10, 100, 1000};
+   int    s, d, k, D, ntrial, bad;
+   size_t stride;
+   double *pop, *a, *b, t0, t_old, t_new, t_xo;
+   rnd_state r;
+   de_rng g;
+   de_trial t;
+
+   printf("%-24s %6s %12s %12s %8s %12s\n","strategy","D","legacy ns",
+          "kernel ns","speedup","xoshiro ns");
+   for (d=0; d<3; d++)
+   {
+      D      = Ds[d];
+      stride = de_stride(D);
+      ntrial = NTRIAL/(D/10);
+      if (posix_memalign((void **)&pop,DE_ALIGN,NPOP*stride*sizeof(double)) ||
+          posix_memalign((void **)&a,DE_ALIGN,stride*sizeof(double)) ||
+          posix_memalign((void **)&b,DE_ALIGN,stride*sizeof(double)))
+      {
+         printf("\nOut of memory\n");
+         return 1;
+      }
+      rnd_init(&r,7);
+      for (k=0; k<NPOP*(int)stride; k++) pop[k] = rnd_uni(&r) - 0.5;
+
+      for (s=1; s<=10; s++)
+      {
+         t.D  = D;
+         t.F  = 0.7;
+         t.CR = 0.9;
+
+         rnd_init(&r,11);            /* every trial of both, untimed */
+         de_rng_init(&g,DE_RNG_RAN2,11,0);
+         for (k=0, bad=0; k<ntrial && !bad; k++)
+         {
+            setup(&t,pop,stride,k);
+            t.tmp = a;
+            legacy(s,&t,&r);
+            t.tmp = b;
+            de_kernels[s](&t,&g);
+            bad = memcmp(a,b,D*sizeof(double)) != 0;
+         }
+
+         rnd_init(&r,11);
+         t.tmp = a;
+         t0 = now();
+         for (k=0; k<ntrial; k++)
+         {
+            setup(&t,pop,stride,k);
+            legacy(s,&t,&r);
+         }
+         t_old = now() - t0;
+
+         de_rng_init(&g,DE_RNG_RAN2,11,0);
+         t.tmp = b;
+         t0 = now();
+         for (k=0; k<ntrial; k++)
+         {
+            setup(&t,pop,stride,k);
+            de_kernels[s](&t,&g);
+         }
+         t_new = now() - t0;
+
+         de_rng_init(&g,DE_RNG_XOSHIRO,11,0);
+         t0 = now();
+         for (k=0; k<ntrial; k++)
+         {
+            setup(&t,pop,stride,k);
+            de_kernels[s](&t,&g);
+         }
+         t_xo = now() - t0;
+
+         printf("%-24s %6d %12.1f %12.1f %8.2f %12.1f%s\n",de_strat[s],D,
+                1e9*t_old/ntrial,1e9*t_new/ntrial,t_old/t_new,
+                1e9*t_xo/ntrial,bad ? "  MISMATCH" : "");
+      }
+      free(pop);
+      free(a);
+      free(b);
+   }
+   return 0;
+}
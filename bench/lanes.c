@@ -0,0 +1,86 @@
+# include "../de.h"
+
+/*------------------------Lane-batched vs one run at a time-------------*/
+/*------R=256 small runs of Rastrigin's function, one seed each,--------*/
+/*------DE/rand/1/bin, F=0.5, CR=0.9, 200 generations, for D and NP in--*/
+/*------the dj9.dat range. Runs per second on one thread of de_solve()--*/
+/*------with ran2, which is what R calls of de36.c do, of de_solve()----*/
+/*------with xoshiro and of de_lanes(), with the mean final cost of-----*/
+/*------each. The objective is cheap, so the solver overhead shows.-----*/
+/*                                                                      */
+/*------cc -O2 bench/lanes.c de[a-z]*.c -lm -lpthread; ./a.out [R gens]*/
+
+
+static double rastrigin(int D, const double x[], void *user)
+{
+   double s = 10.0*D;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j] - 10.0*cos(2*M_PI*x[j]);
+   return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+   static int Ds[]  = {5, 10, 30};
+   static int NPs[] = {20, 50, 100};
+   int    R = (argc > 1) ? atoi(argv[1]) : 256;
+   de_config *cfg;
+   de_result *res;
+   double t, ts[3], cs[3];
+   int    d, n, m, r;
+
+   cfg = (de_config *)calloc(R,sizeof(de_config));
+   res = (de_result *)calloc(R,sizeof(de_result));
+   if (cfg == NULL || res == NULL) return 1;
+
+   printf("R=%d  lanes=%d\n",R,DE_LANES);
+   printf("%4s %4s %12s %12s %12s %8s   %s\n","D","NP","ran2 runs/s",
+          "xoshiro","lanes","speedup","mean cost ran2/xoshiro/lanes");
+   for (d=0; d<3; d++)
+   {
+      for (n=0; n<3; n++)
+      {
+         for (r=0; r<R; r++)
+         {
+            de_defaults(&cfg[r]);
+            cfg[r].strategy   = 7;
+            cfg[r].D          = Ds[d];
+            cfg[r].NP         = NPs[n];
+            cfg[r].genmax     = (argc > 2) ? atoi(argv[2]) : 200;
+            cfg[r].F          = 0.5;
+            cfg[r].CR         = 0.9;
+            cfg[r].seed       = r+1;
+            cfg[r].rng        = DE_RNG_XOSHIRO;
+            res[r].best       = NULL;
+         }
+         for (m=0; m<3; m++)
+         {
+            cs[m] = 0;
+            t = de_time();
+            if (m == 2)
+            {
+               if (de_lanes(R,cfg,rastrigin,NULL,res) != DE_OK) return 1;
+               for (r=0; r<R; r++) cs[m] += res[r].cmin;
+            }
+            else
+            {
+               for (r=0; r<R; r++)
+               {
+                  cfg[r].rng = (m == 0) ? DE_RNG_RAN2 : DE_RNG_XOSHIRO;
+                  if (de_solve(&cfg[r],rastrigin,NULL,&res[r]) != DE_OK) return 1;
+                  cs[m] += res[r].cmin;
+               }
+            }
+            ts[m] = de_time() - t;
+         }
+         printf("%4d %4d %12.1f %12.1f %12.1f %7.2fx   %.3g/%.3g/%.3g\n",Ds[d],
+                NPs[n],R/ts[0],R/ts[1],R/ts[2],ts[0]/ts[2],cs[0]/R,cs[1]/R,cs[2]/R);
+         fflush(stdout);
+      }
+   }
+   free(cfg);
+   free(res);
+   return 0;
+}
@@ -0,0 +1,76 @@
+# include "../de.h"
+
+/*------------------------Local search polishing------------------------*/
+/*------Shifted test functions at D=20, NP=50, DE/rand/1/bin, F=0.5,----*/
+/*------CR=0.9, xoshiro streams, solved to vtr=1e-8 within 400000-------*/
+/*------evaluations, without polishing and with each local search, run--*/
+/*------every 50 generations and after 20 without improvement, with the-*/
+/*------default budget. Per function and search, over 5 seeds: runs----*/
+/*------that reached vtr, mean evaluations to get there (the budget for-*/
+/*------runs that did not), the share of them spent polishing, the-----*/
+/*------mean final cost and the mean wall time.-------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/local.c de[a-z]*.c -lm -lpthread; ./a.out [D every]*/
+
+#define NSEED 5
+
+
+int main(int argc, char *argv[])
+{
+   static char *names[] = {"sphere", "rosenbrock", "ackley", "griewank",
+                           "rastrigin"};
+   const de_func *f;
+   de_problem *prob;
+   de_config cfg;
+   de_result res;
+   double nfe, loc, cost, wall;
+   int n, l, s, ok;
+
+   de_defaults(&cfg);
+   cfg.D           = (argc > 1) ? atoi(argv[1]) : 20;
+   cfg.NP          = 50;
+   cfg.strategy    = 7;
+   cfg.F           = 0.5;
+   cfg.CR          = 0.9;
+   cfg.rng         = DE_RNG_XOSHIRO;
+   cfg.vtr         = 1e-8;
+   cfg.genmax      = 1000000;
+   cfg.max_nfeval  = 400000;
+   cfg.local_every = (argc > 2) ? atoi(argv[2]) : 50;
+   cfg.local_stall = 20;
+   res.best        = NULL;
+
+   printf("D=%d  NP=%d  every=%d  stall=%d  budget=%d\n",cfg.D,cfg.NP,
+          cfg.local_every,cfg.local_stall,DE_LOCAL_BUDGET*(cfg.D+1));
+   printf("%-11s %-8s %4s %10s %7s %12s %8s\n","function","local","ok",
+          "NFEs","local","cost","wall s");
+   for (n=0; n<(int)(sizeof(names)/sizeof(names[0])); n++)
+   {
+      f    = de_func_find(names[n]);
+      prob = de_problem_create(f,cfg.D,0,1);
+      if (prob == NULL) return 1;
+      cfg.inibound_l = f->lo;
+      cfg.inibound_h = f->hi;
+      for (l=DE_LOCAL_NONE; l<=DE_LOCAL_LBFGS; l++)
+      {
+         cfg.local = l;
+         nfe = loc = cost = wall = 0;
+         ok = 0;
+         for (s=1; s<=NSEED; s++)
+         {
+            cfg.seed = s;
+            if (de_solve(&cfg,de_problem_eval,prob,&res) != DE_OK) return 1;
+            nfe  += res.nfeval;
+            loc  += res.nlocal;
+            cost += res.cmin;
+            wall += res.wall;
+            ok   += (res.stop == DE_STOP_VTR);
+         }
+         printf("%-11s %-8s %4d %10.0f %6.1f%% %12.4g %8.3f\n",names[n],
+                de_local_name[l],ok,nfe/NSEED,100*loc/nfe,cost/NSEED,wall/NSEED);
+         fflush(stdout);
+      }
+      de_problem_free(prob);
+   }
+   return 0;
+}
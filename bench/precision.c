@@ -0,0 +1,76 @@
+# include "../de.h"
+
+/*------------------------Population precision--------------------------*/
+/*------The test functions with DE/rand/1/bin, F=0.5, CR=0.9 and-------*/
+/*------xoshiro streams on one thread, for a fixed number of------------*/
+/*------generations. Per function over 3 seeds: generations/s and the--*/
+/*------mean, best and worst final cost. Built once as is and once with-*/
+/*------DE_FLOAT, the two tables compare double and float rows. The-----*/
+/*------shifted functions have their optimum away from 0, where float---*/
+/*------rows cannot come as close to it.-------------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/precision.c de[a-z]*.c -lm -lpthread -o prec_d-----*/
+/*------cc -O2 -DDE_FLOAT bench/precision.c de[a-z]*.c -lm -lpthread \---*/
+/*------   -o prec_f------------------------------------------------------*/
+/*------./prec_d [D NP genmax], default 30 300 2000---------------------*/
+
+#define NSEED 3
+
+
+int main(int argc, char *argv[])
+{
+   static char *names[] = {"sphere", "rosenbrock", "rastrigin", "ackley",
+                           "griewank", "shifted-sphere", "shifted-rastrigin"};
+   const de_func *f;
+   de_problem *prob;
+   de_config cfg;
+   de_result res;
+   double gens, wall, sum, lo, hi;
+   int n, s, shift;
+
+   de_defaults(&cfg);
+   cfg.D        = (argc > 1) ? atoi(argv[1]) : 30;
+   cfg.NP       = (argc > 2) ? atoi(argv[2]) : 300;
+   cfg.strategy = 7;
+   cfg.F        = 0.5;
+   cfg.CR       = 0.9;
+   cfg.rng      = DE_RNG_XOSHIRO;
+   cfg.genmax   = (argc > 3) ? atoi(argv[3]) : 2000;
+   cfg.vtr      = -HUGE_VAL;
+   res.best     = NULL;
+
+   printf("de_real: %s  D=%d  NP=%d  genmax=%d\n",
+          (sizeof(de_real) == sizeof(float)) ? "float" : "double",cfg.D,
+          cfg.NP,cfg.genmax);
+   printf("%-18s %9s %12s %12s %12s\n","function","gens/s","mean cost",
+          "best","worst");
+   for (n=0; n<(int)(sizeof(names)/sizeof(names[0])); n++)
+   {
+      shift = (names[n][0] == 's' && names[n][1] == 'h');
+      f = de_func_find(shift ? names[n]+8 : names[n]);
+      prob = shift ? de_problem_create(f,cfg.D,0,1) : NULL;
+      cfg.inibound_l = f->lo;
+      cfg.inibound_h = f->hi;
+      gens = wall = sum = 0;
+      lo = HUGE_VAL;
+      hi = -HUGE_VAL;
+      for (s=1; s<=NSEED; s++)
+      {
+         cfg.seed = s;
+         if (de_solve(&cfg,shift ? de_problem_eval : f->fn,prob,&res) != DE_OK)
+         {
+            return 1;
+         }
+         gens += res.gen;
+         wall += res.wall;
+         sum  += res.cmin;
+         if (res.cmin < lo) lo = res.cmin;
+         if (res.cmin > hi) hi = res.cmin;
+      }
+      de_problem_free(prob);
+      printf("%-18s %9.0f %12.4g %12.4g %12.4g\n",names[n],gens/wall,
+             sum/NSEED,lo,hi);
+      fflush(stdout);
+   }
+   return 0;
+}
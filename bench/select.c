@@ -0,0 +1,83 @@
+# include "../de.h"
+
+/*------------------------Copy-free selection---------------------------*/
+/*------Time per generation at large D and NP with a cheap objective,---*/
+/*------where copying population rows is a visible share of the run.---*/
+/*------Selection swaps row indexes, so rejected trials, which used to--*/
+/*------copy their member into the next generation, cost nothing. The---*/
+/*------bench replays the selection on the costs it sees (one thread,---*/
+/*------ran2: trials arrive in member order) to count the rejections----*/
+/*------and prints the bytes of row copies (read and write) saved per---*/
+/*------generation. Built against the tree before the change, the same--*/
+/*------file gives the old times for comparison.------------------------*/
+/*                                                                      */
+/*------cc -O2 bench/select.c de[a-z]*.c -lm -lpthread; ./a.out [gens]-*/
+
+typedef struct replay
+{
+   int    NP;
+   long   k;              /* evaluations so far                 */
+   long   rejected;       /* trials that lost against their member */
+   double *cost;          /* member costs                       */
+} replay;
+
+
+static double sphere(int D, const double x[], void *user)
+{
+   replay *r = (replay *)user;
+   double s = 0;
+   int j, i;
+
+   for (j=0; j<D; j++) s += x[j]*x[j];
+   i = (int)(r->k % r->NP);
+   if (r->k++ < r->NP) r->cost[i] = s;          /* initial population */
+   else if (s <= r->cost[i]) r->cost[i] = s;
+   else r->rejected++;
+   return s;
+}
+
+
+int main(int argc, char *argv[])
+{
+   static int dims[] = {100, 1000, 10000};
+   static int nps[]  = {50, 200};
+   static int strategies[] = {2, 7};
+   de_config cfg;
+   de_result res;
+   replay r;
+   double gens, rej;
+   int d, n, s;
+
+   de_defaults(&cfg);
+   cfg.genmax = (argc > 1) ? atoi(argv[1]) : 200;
+   cfg.F      = 0.5;
+   cfg.CR     = 0.9;
+   res.best   = NULL;
+
+   printf("%-16s %6s %5s %12s %12s %14s\n","strategy","D","NP","ns/gen",
+          "rejected/gen","MB saved/gen");
+   for (s=0; s<2; s++)
+   {
+      for (d=0; d<3; d++)
+      {
+         for (n=0; n<2; n++)
+         {
+            cfg.strategy = strategies[s];
+            cfg.D        = dims[d];
+            cfg.NP       = nps[n];
+            r.NP         = cfg.NP;
+            r.k          = 0;
+            r.rejected   = 0;
+            r.cost       = (double *)malloc(cfg.NP*sizeof(double));
+            if (r.cost == NULL) return 1;
+            if (de_solve(&cfg,sphere,&r,&res) != DE_OK) return 1;
+            gens = res.gen;
+            rej  = r.rejected/gens;
+            printf("%-16s %6d %5d %12.0f %12.1f %14.3f\n",de_strat[cfg.strategy],
+                   cfg.D,cfg.NP,1e9*res.wall/gens,rej,rej*16.0*cfg.D/1e6);
+            free(r.cost);
+         }
+      }
+   }
+   return 0;
+}
@@ -0,0 +1,83 @@
+# include "../de.h"
+# include <time.h>
+
+/*------------------------Surrogate pre-screening-----------------------*/
+/*------The test functions at D=10, NP=50, DE/rand/1/bin, F=0.5, CR=0.9,*/
+/*------made expensive by a sleep per evaluation, solved to vtr=1e-6----*/
+/*------within 100000 evaluations, without and with the k-NN surrogate--*/
+/*------(k=5) passing on half and 30% of the trials. Per function and---*/
+/*------setting, over 3 seeds: runs that reached vtr, mean evaluations--*/
+/*------and generations, share of trials held back, wall time and its---*/
+/*------speedup against the run without surrogate.---------------------*/
+/*                                                                      */
+/*------cc -O2 bench/surrogate.c de[a-z]*.c -lm -lpthread; ./a.out [us]-*/
+/*------us is the sleep per evaluation, default 100.--------------------*/
+
+static long sleep_ns;
+
+
+static double expensive(int D, const double x[], void *user)
+{
+   struct timespec ts;
+
+   ts.tv_sec  = 0;
+   ts.tv_nsec = sleep_ns;
+   if (sleep_ns > 0) nanosleep(&ts,NULL);
+   return ((const de_func *)user)->fn(D,x,NULL);
+}
+
+
+int main(int argc, char *argv[])
+{
+   static char  *names[] = {"sphere", "rosenbrock", "rastrigin", "ackley", "griewank"};
+   static double keeps[] = {0, 0.5, 0.3};
+   const de_func *f;
+   de_config cfg;
+   de_result res;
+   double wall, wall0 = 0, nfe, gens, scr;
+   int n, k, s, ok;
+
+   sleep_ns = 1000L*((argc > 1) ? atoi(argv[1]) : 100);
+   de_defaults(&cfg);
+   cfg.D          = 10;
+   cfg.NP         = 50;
+   cfg.strategy   = 7;
+   cfg.F          = 0.5;
+   cfg.CR         = 0.9;
+   cfg.vtr        = 1e-6;
+   cfg.genmax     = 1000000;
+   cfg.max_nfeval = 100000;
+   res.best       = NULL;
+
+   printf("%-11s %5s %4s %10s %8s %7s %9s %8s\n","function","keep","ok",
+          "NFEs","gens","saved","wall s","speedup");
+   for (n=0; n<(int)(sizeof(names)/sizeof(names[0])); n++)
+   {
+      f = de_func_find(names[n]);
+      cfg.inibound_l = f->lo;
+      cfg.inibound_h = f->hi;
+      for (k=0; k<3; k++)
+      {
+         cfg.surr_k    = (keeps[k] > 0) ? 5 : 0;
+         cfg.surr_keep = (keeps[k] > 0) ? keeps[k] : 0.5;
+         wall = nfe = gens = scr = 0;
+         ok = 0;
+         for (s=1; s<=3; s++)
+         {
+            cfg.seed = s;
+            if (de_solve(&cfg,expensive,(void *)f,&res) != DE_OK) return 1;
+            wall += res.wall;
+            nfe  += res.nfeval;
+            gens += res.gen;
+            scr  += res.nscreened;
+            ok   += (res.stop == DE_STOP_VTR);
+         }
+         if (k == 0) wall0 = wall;
+         printf("%-11s %5.2g %4d %10.0f %8.0f %7.3f %9.3f %7.2fx\n",names[n],
+                keeps[k] > 0 ? keeps[k] : 1.0,ok,nfe/3,gens/3,scr/(nfe+scr),
+                wall/3,wall0/wall);
+         fflush(stdout);
+      }
+   }
+   return 0;
+}
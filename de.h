@@ -1,11 +1,25 @@
+#ifndef DE_H
+#define DE_H
+
 #include "stdio.h"
 #include "stdlib.h"
 #include "math.h"
 #include "memory.h"
+#include "stdint.h"
+#include "signal.h"
+
+
+#define DE_ALIGN  64      /* bytes, alignment of population rows */
 
+/*------Precision of the population and trial vectors. Costs, best------*/
+/*------members and the objective stay double; -DDE_FLOAT halves the----*/
+/*------rows and doubles the SIMD lanes of the kernels.-----------------*/
 
-#define MAXPOP  500
-#define MAXDIM  35
+#ifdef DE_FLOAT
+typedef float  de_real;
+#else
+typedef double de_real;
+#endif
 
 /*------Constants for rnd_uni()--------------------------------------------*/
 
@@ -23,3 +37,417 @@
 #define NDIV (1+IMM1/NTAB)
 #define EPS 1.2e-7
 #define RNMX (1.0-EPS)
+
+/*------Return codes of de_solve()-----------------------------------------*/
+
+#define DE_OK      0
+#define DE_EINVAL  1      /* configuration rejected by de_check()  */
+#define DE_ENOMEM  2      /* could not allocate the solver context */
+#define DE_EFAIL   3      /* an island did not finish              */
+#define DE_EIO     4      /* checkpoint missing, damaged, unwritable */
+
+/*------State of rnd_uni(), formerly hidden in static variables------------*/
+
+typedef struct rnd_state
+{
+   long  idum;            /* seed, must be negative before first call */
+   long  idum2;
+   long  iy;
+   long  iv[NTAB];        /* shuffle table                          */
+} rnd_state;
+
+/*------Random number layer (derand.c)-------------------------------------*/
+
+#define DE_RNG_RAN2     0      /* rnd_uni(), reproduces old runs          */
+#define DE_RNG_XOSHIRO  1      /* xoshiro256+, per-member streams         */
+#define DE_RNG_LANES    4      /* interleaved xoshiro generators          */
+#define DE_RNG_BUF      32     /* buffered numbers, multiple of LANES     */
+
+typedef struct de_rng
+{
+   int   kind;            /* DE_RNG_RAN2 or DE_RNG_XOSHIRO          */
+   rnd_state ran2;        /* state for DE_RNG_RAN2                  */
+   uint64_t s[4][DE_RNG_LANES]; /* xoshiro state, word-major        */
+   double buf[DE_RNG_BUF]; /* xoshiro numbers not yet handed out    */
+   int   pos;             /* next unused entry of buf               */
+} de_rng;
+
+/*------Iteration modes----------------------------------------------------*/
+
+#define DE_MODE_SYNC    0      /* generation-synchronous, deterministic   */
+#define DE_MODE_ASYNC   1      /* steady-state, no generation barrier     */
+
+/*------Adaptation of the control variables (deadapt.c)-------------------*/
+
+#define DE_ADAPT_NONE   0      /* F and CR fixed, as given               */
+#define DE_ADAPT_JDE    1      /* per-member F and CR, Brest et al. 2006  */
+#define DE_ADAPT_SHADE  2      /* success-history memory, Tanabe and      */
+                               /* Fukunaga 2013                           */
+#define DE_ADAPT_H      6      /* entries of the SHADE memory             */
+
+/*------Surrogate pre-screening (desurr.c)--------------------------------*/
+
+#define DE_SURR_KMAX    32     /* largest cfg->surr_k                     */
+#define DE_SURR_ARCHIVE 20     /* default archive, multiples of NP        */
+
+/*------Local search polishing of the best member (delocal.c)-----------*/
+
+#define DE_LOCAL_NONE    0     /* no polishing                            */
+#define DE_LOCAL_NM      1     /* Nelder-Mead simplex                     */
+#define DE_LOCAL_PATTERN 2     /* coordinate pattern search               */
+#define DE_LOCAL_LBFGS   3     /* L-BFGS, finite-difference gradients     */
+#define DE_LOCAL_BUDGET  20    /* default budget, multiples of D+1        */
+
+/*------Handling of trial parameters outside the bounds, cfg->bound-------*/
+
+#define DE_BOUND_NONE    0     /* trials may leave the bounds             */
+#define DE_BOUND_CLAMP   1     /* set to the violated bound               */
+#define DE_BOUND_REFLECT 2     /* mirrored at the violated bound          */
+#define DE_BOUND_BOUNCE  3     /* random point between target and bound   */
+#define DE_BOUND_REINIT  4     /* random point within the bounds          */
+
+/*------Reasons for the end of a run, de_result.stop-----------------------*/
+
+#define DE_STOP_GENMAX  0      /* genmax generations done                 */
+#define DE_STOP_VTR     1      /* cmin <= vtr                             */
+#define DE_STOP_STALL   2      /* no improvement of cmin for stall gens.  */
+#define DE_STOP_CVAR    3      /* cost variance < cvar_min                */
+#define DE_STOP_NFEVAL  4      /* nfeval >= max_nfeval                    */
+#define DE_STOP_WALL    5      /* run time >= max_wall seconds            */
+#define DE_STOP_USER    6      /* *stop became nonzero                    */
+
+/*------Objective function and progress monitor callbacks-----------------*/
+
+typedef double (*de_objective)(int D, const double x[], void *user);
+typedef void   (*de_batch)(int D, int n, const double *X, size_t stride,
+                           double *costs, void *user);
+
+typedef int    (*de_feasible)(int D, const double x[], void *user);
+
+/*------Incremental objective: x differs from its parent only in the----*/
+/*------len parameters x[(lo+k)%D], k < len. pstate is the state the---*/
+/*------objective cached for the parent, or NULL for a full evaluation;-*/
+/*------the state of x (de_config.delta_state doubles) goes to state.--*/
+typedef double (*de_delta)(int D, const double x[], int lo, int len,
+                           const double *pstate, double *state, void *user);
+
+typedef struct de_progress
+{
+   int    gen;            /* generation just completed              */
+   long   nfeval;         /* number of function evaluations so far  */
+   int    D;              /* dimension of parameter vector          */
+   int    NP;             /* number of population members           */
+   double cmin;           /* best-so-far cost                       */
+   double cmean;          /* mean cost of the population            */
+   double cvar;           /* cost variance of the population        */
+   const double *best;    /* best-so-far member                     */
+} de_progress;
+
+typedef void (*de_monitor)(const de_progress *p, void *user);
+
+typedef int  (*de_migrate)(int gen, int D, const double *best, double cmin,
+                           double *in, double *in_cost, int max, void *user);
+
+/*------Solver configuration and result-----------------------------------*/
+
+typedef struct de_config
+{
+   int    strategy;       /* choice of strategy 1..10               */
+   int    genmax;         /* maximum number of generations          */
+   int    D;              /* number of parameters                   */
+   int    NP;             /* population size                        */
+   double inibound_h;     /* upper parameter bound for init         */
+   double inibound_l;     /* lower parameter bound for init         */
+   double F;              /* weight factor                          */
+   double CR;             /* crossing over factor                   */
+   int    seed;           /* random seed, > 0                       */
+   int    threads;        /* threads evaluating trials, >= 1        */
+   int    rng;            /* DE_RNG_RAN2 or DE_RNG_XOSHIRO          */
+   int    mode;           /* DE_MODE_SYNC or DE_MODE_ASYNC          */
+   de_batch batch;        /* evaluates n rows of X at once, or NULL */
+   de_monitor monitor;    /* called after every generation, or NULL */
+   void  *monitor_user;   /* passed through to monitor              */
+   de_migrate migrate;    /* exchanges members with other runs      */
+   void  *migrate_user;   /* passed through to migrate              */
+   int    migrate_every;  /* generations between calls of migrate   */
+   int    nimm;           /* immigrants accepted per call           */
+   const char *checkpoint; /* snapshot file, or NULL                */
+   int    checkpoint_every; /* generations between snapshots        */
+   int    resume;         /* start from the snapshot if nonzero     */
+   const char *trace;     /* binary trace file, or NULL             */
+   int    trace_every;    /* generations between trace records      */
+   int    trace_pop;      /* generations between population dumps,  */
+                          /* 0 for none                             */
+   double vtr;            /* value to reach, -HUGE_VAL for none     */
+   int    stall;          /* generations without improvement, or 0  */
+   double cvar_min;       /* cost variance to stop at, or 0         */
+   long   max_nfeval;     /* evaluation budget, or 0                */
+   double max_wall;       /* run time budget in seconds, or 0       */
+   volatile sig_atomic_t *stop; /* stop as soon as *stop != 0, or NULL */
+   int    adapt;          /* DE_ADAPT_NONE, _JDE or _SHADE          */
+   int    np_min;         /* final NP of a linear population size   */
+                          /* reduction, or 0 for a fixed NP         */
+   de_delta delta;        /* incremental objective, or NULL         */
+   int    delta_state;    /* doubles of cached state per member     */
+   const double *lo, *hi; /* bounds of the parameters, D each, or   */
+                          /* NULL for inibound_l, inibound_h        */
+   int    bound;          /* DE_BOUND_*, for trials out of bounds   */
+   de_feasible feasible;  /* cheap test before the objective; a     */
+                          /* trial it rejects is not evaluated      */
+   void  *feasible_user;  /* passed through to feasible             */
+   int    surr_k;         /* neighbours of the k-NN surrogate that  */
+                          /* pre-screens the trials, or 0 for none  */
+   double surr_keep;      /* share of the trials evaluated per gen. */
+   int    surr_archive;   /* evaluated points the surrogate keeps,  */
+                          /* 0 for DE_SURR_ARCHIVE*NP               */
+   const double *init_pop; /* NP rows of D to start from, or NULL   */
+                          /* for random ones within the bounds      */
+   double *final_pop;     /* receives the final population, NP rows */
+                          /* of D, or NULL; with np_min only the    */
+                          /* first rows are written                 */
+   int    local;          /* DE_LOCAL_*, polishing of the best      */
+   int    local_every;    /* generations between polishings, or 0   */
+   int    local_stall;    /* polish after this many generations     */
+                          /* without improvement, or 0              */
+   long   local_budget;   /* evaluations per polishing, 0 for       */
+                          /* DE_LOCAL_BUDGET*(D+1)                  */
+   const double *quant;   /* grid step of every parameter, D each,  */
+                          /* 0 for a continuous one; or NULL        */
+   long   cache;          /* entries of the evaluation cache, or 0  */
+} de_config;
+
+/*------Phase profiling (deprof.c), compiled in with -DDE_PROFILE only---*/
+
+#ifdef DE_PROFILE
+#define DE_PH_SAMPLE    0      /* drawing r1..r5                          */
+#define DE_PH_MUTATE    1      /* mutation, crossover, boundary handling  */
+#define DE_PH_EVAL      2      /* feasibility test, surrogate, objective  */
+#define DE_PH_SELECT    3      /* selection and copies of members         */
+#define DE_PH_STATS     4      /* cmean and cvar                          */
+#define DE_PH_OTHER     5      /* adaptation, migration, polishing, ckpt  */
+#define DE_PH_GEN       6      /* whole generation, wall                  */
+#define DE_PH_N         7
+#define DE_HW_N         3      /* cycles, instructions, cache misses      */
+#define DE_HIST         64     /* log2 buckets of ticks per generation    */
+
+typedef struct de_profile
+{
+   uint64_t tick[DE_PH_N];    /* ticks per phase, summed over threads   */
+   double   hz;               /* ticks per second, measured             */
+   int      hw;               /* hardware counters were available       */
+   uint64_t hwc[DE_PH_N][DE_HW_N]; /* counters of the calling thread    */
+   long     hist[DE_PH_N][DE_HIST]; /* generations by ticks in [2^b,2^(b+1)) */
+} de_profile;
+
+extern char *de_phase_name[];
+void  de_profile_print(FILE *fp, const de_profile *p);
+#endif
+
+typedef struct de_result
+{
+   double cmin;           /* best-so-far cost                       */
+   double *best;          /* caller supplied buffer of D doubles    */
+   int    gen;            /* generations performed                  */
+   long   nfeval;         /* number of function evaluations         */
+   double cmean;          /* mean cost of the final population      */
+   double cvar;           /* cost variance of the final population  */
+   double wall;           /* run time in seconds                    */
+   double evals_per_sec;  /* nfeval/wall                            */
+   double utilization;    /* share of thread time spent in fn       */
+   int    stop;           /* DE_STOP_* reason for the end of the run*/
+   long   nrejected;      /* trials rejected by feasible, not       */
+                          /* counted in nfeval                      */
+   long   nscreened;      /* trials held back by the surrogate, not */
+                          /* counted in nfeval                      */
+   long   nlocal;         /* evaluations of the local search,       */
+                          /* counted in nfeval                      */
+   long   nhit;           /* trials whose cost came from the cache, */
+                          /* not counted in nfeval                  */
+   long   nmiss;          /* trials evaluated with the cache on     */
+#ifdef DE_PROFILE
+   de_profile prof;       /* time and counters by phase             */
+#endif
+} de_result;
+
+/*------Mutation/crossover kernels (dekern.c)------------------------------*/
+
+typedef struct de_trial
+{
+   int    D;              /* dimension of parameter vector          */
+   double F, CR;          /* control variables of DE                */
+   const de_real *old;    /* target member                          */
+   const de_real *bestit; /* best member of the last generation     */
+   const de_real *p1, *p2, *p3, *p4, *p5; /* random members r1..r5 */
+   de_real *tmp;          /* receives the trial vector              */
+   int    lo, len;        /* changed parameters lo..lo+len-1 mod D  */
+} de_trial;
+
+typedef void (*de_kernel)(de_trial *t, de_rng *rnd);
+
+extern de_kernel de_kernels[];  /* indexed by strategy               */
+
+/*------Thread pool (dethr.c)---------------------------------------------*/
+
+typedef void (*de_task)(void *arg, int i);
+typedef struct de_pool de_pool;
+
+de_pool *de_pool_create(int nthreads);
+void     de_pool_run(de_pool *p, int n, de_task fn, void *arg);
+int      de_pool_size(const de_pool *p);
+int      de_pool_self(const de_pool *p);
+void     de_pool_free(de_pool *p);
+
+/*------External evaluator pool (deext.c)-----------------------------------*/
+
+#define DE_EXT_MAGIC     "DEEVAL1"
+
+typedef struct de_ext_hello  /* first bytes sent to a worker            */
+{
+   char    magic[8];      /* DE_EXT_MAGIC                           */
+   int32_t D;             /* doubles per row of a frame             */
+   int32_t pad;
+} de_ext_hello;
+
+typedef struct de_ext de_ext;
+
+de_ext *de_ext_create(const char *cmd, int N, int D, double timeout,
+                      int retries);
+void    de_ext_batch(int D, int n, const double *X, size_t stride,
+                     double *costs, void *user);
+void    de_ext_counts(de_ext *e, long *restarts, long *timeouts, long *failed);
+void    de_ext_free(de_ext *e);
+
+/*------Trace file format (detrace.c), native byte order------------------*/
+/*------A de_trace_head, then records: a de_trace_rec followed by len----*/
+/*------bytes, a de_trace_gen for DE_TRACE_GEN, or a de_trace_pop and----*/
+/*------its NP rows of D doubles and NP costs for DE_TRACE_POP. A resumed*/
+/*------run appends its records to the same file.------------------------*/
+
+#define DE_TRACE_MAGIC   "DETRACE"
+#define DE_TRACE_VERSION 1
+#define DE_TRACE_GEN     1    /* statistics of one generation            */
+#define DE_TRACE_POP     2    /* snapshot of the whole population        */
+
+typedef struct de_trace_head
+{
+   char   magic[8];       /* DE_TRACE_MAGIC                         */
+   int32_t version;
+   int32_t D, NP;
+   int32_t strategy;
+} de_trace_head;
+
+typedef struct de_trace_rec
+{
+   int32_t type;          /* DE_TRACE_GEN or DE_TRACE_POP           */
+   int32_t len;           /* bytes following this header            */
+} de_trace_rec;
+
+typedef struct de_trace_gen
+{
+   int32_t gen;
+   int32_t pad;
+   int64_t nfeval;
+   double cmin, cmean, cvar;
+   double wall;           /* seconds since the start of the run     */
+} de_trace_gen;
+
+typedef struct de_trace_pop
+{
+   int32_t gen;
+   int32_t NP;            /* members in this snapshot               */
+} de_trace_pop;
+
+/*------Test functions (defunc.c)------------------------------------------*/
+
+typedef struct de_func
+{
+   char  *name;
+   de_objective fn;       /* ignores user                           */
+   double lo, hi;         /* usual search range of every parameter  */
+   double opt;            /* every parameter of the minimum         */
+} de_func;
+
+typedef struct de_problem de_problem;   /* shifted/rotated de_func */
+
+extern de_func de_funcs[]; /* ends with a NULL name                  */
+
+const de_func *de_func_find(const char *name);
+de_problem *de_problem_create(const de_func *f, int D, int rotate, long seed);
+double de_problem_eval(int D, const double x[], void *user);
+void   de_problem_free(de_problem *p);
+
+/*------Island model (deisland.c)-----------------------------------------*/
+
+#define DE_TOPO_RING      0    /* island k takes from island k-1          */
+#define DE_TOPO_RANDOM    1    /* from one other island, chosen anew      */
+#define DE_TOPO_FULL      2    /* from all other islands                  */
+#define DE_ISLAND_PROCESS 0    /* one forked process per island           */
+#define DE_ISLAND_THREAD  1    /* one thread per island                   */
+
+typedef struct de_island_config
+{
+   int    K;              /* number of islands                      */
+   int    every;          /* generations between migrations         */
+   int    topology;       /* DE_TOPO_RING, _RANDOM or _FULL         */
+   int    exec;           /* DE_ISLAND_PROCESS or DE_ISLAND_THREAD  */
+   int    slots;          /* messages kept per island outbox        */
+} de_island_config;
+
+/*------Cooperative coevolution (decoev.c)--------------------------------*/
+
+#define DE_GROUP_FIXED    0    /* blocks of size consecutive parameters   */
+#define DE_GROUP_RANDOM   1    /* blocks of a new permutation every cycle */
+#define DE_GROUP_DIFF     2    /* differential grouping, Omidvar et al.   */
+                               /* 2014, once before the first cycle       */
+
+typedef struct de_coev_config
+{
+   int    grouping;       /* DE_GROUP_FIXED, _RANDOM or _DIFF       */
+   int    size;           /* parameters per subcomponent; _DIFF     */
+                          /* keeps larger interacting groups whole  */
+   int    cycles;         /* rounds over all subcomponents          */
+   int    gens;           /* generations of a subcomponent per cycle */
+   int    parallel;       /* 0: one after another, each against the */
+                          /* context improved by the previous ones; */
+                          /* 1: all against the same context, on    */
+                          /* cfg->threads threads, then merged      */
+   double eps;            /* _DIFF: interaction threshold           */
+} de_coev_config;
+
+/*------Lane-batched runs (delanes.c)-------------------------------------*/
+
+#define DE_LANES          8    /* runs advanced together, one per lane    */
+
+/*------Library entry points-----------------------------------------------*/
+
+extern char *de_strat[];   /* strategy-indicator, indexed by strategy */
+extern char *de_rng_name[]; /* generator names, indexed by DE_RNG_*    */
+extern char *de_mode_name[]; /* mode names, indexed by DE_MODE_*       */
+extern char *de_adapt_name[]; /* indexed by DE_ADAPT_*                */
+extern char *de_stop_name[]; /* indexed by DE_STOP_*                  */
+extern char *de_bound_name[]; /* indexed by DE_BOUND_*                */
+extern char *de_topo_name[]; /* topology names, indexed by DE_TOPO_*   */
+extern char *de_exec_name[]; /* indexed by DE_ISLAND_*                 */
+extern char *de_group_name[]; /* indexed by DE_GROUP_*                */
+extern char *de_local_name[]; /* indexed by DE_LOCAL_*                */
+
+void   rnd_init(rnd_state *s, long seed);
+double rnd_uni(rnd_state *s);
+void   de_rng_init(de_rng *r, int kind, long seed, long stream);
+double de_rng_uni(de_rng *r);
+void   de_rng_fill(de_rng *r, double u[], int n);
+double de_time(void);
+size_t de_stride(int D);
+void   de_defaults(de_config *cfg);
+int    de_check(const de_config *cfg, char *msg, int len);
+int    de_solve(const de_config *cfg, de_objective fn, void *user,
+                de_result *res);
+int    de_islands(const de_island_config *ic, const de_config cfg[],
+                  de_objective fn, void *user, de_result res[],
+                  de_result *total);
+int    de_coev(const de_coev_config *cc, const de_config *cfg,
+               de_objective fn, void *user, de_result *res);
+int    de_lanes(int R, const de_config cfg[], de_objective fn,
+                void *const user[], de_result res[]);
+
+#endif
@@ -1,98 +1,1019 @@
 # include "de.h"
+# include <stddef.h>
+# include <string.h>
+# include <ctype.h>
+# include <unistd.h>
 
-/*------------------------Globals---------------------------------------*/
+/*---------Function declarations----------------------------------------*/
 
-long  rnd_uni_init;                 /* serves as a seed for rnd_uni()   */
-double c[MAXPOP][MAXDIM], d[MAXPOP][MAXDIM];
-double (*pold)[MAXPOP][MAXDIM], (*pnew)[MAXPOP][MAXDIM], (*pswap)[MAXPOP][MAXDIM];
+double extern evaluate(int D, double tmp[], long *nfeval); /* obj. funct. */
+void   extern evaluate_batch(int D, int n, const double *X, size_t stride,
+                             double *costs) __attribute__((weak));
+double extern evaluate_delta(int D, const double tmp[], int lo, int len,
+                             const double *pstate, double *state)
+                             __attribute__((weak));
+int    extern evaluate_delta_state(int D) __attribute__((weak));
+int    extern evaluate_feasible(int D, const double tmp[]) __attribute__((weak));
 
+/*---------Function definitions-----------------------------------------*/
 
+/*------Command line options. Each one sets a field of cli_args,------*/
+/*------named by its offset, from the text after "--name=".-----------*/
 
-/*---------Function declarations----------------------------------------*/
+#define OPT_INT  0        /* integer                            */
+#define OPT_DBL  1        /* double                             */
+#define OPT_KEY  2        /* one of the names in keys, as int   */
+#define OPT_STR  3        /* the text itself, as char *         */
+#define OPT_LONG 4        /* long integer                       */
+#define OPT_LIST 5        /* comma list, as char *; not swept   */
 
-void  assignd(int D, double a[], double b[]);
-double rnd_uni(long *idum);    /* uniform pseudo random number generator */
-double extern evaluate(int D, double tmp[], long *nfeval); /* obj. funct. */
+#define MAXDIMS  16       /* keys with several values in a sweep */
+#define MAXRUNS  100000   /* runs of a sweep                    */
 
-/*---------Function definitions-----------------------------------------*/
+typedef struct cli_args
+{
+   de_config cfg;         /* settings passed on to de_solve()   */
+   de_island_config isl;  /* settings passed on to de_islands() */
+   char  *isl_strategy;   /* comma lists, cycled over islands   */
+   char  *isl_F;
+   char  *isl_CR;
+   de_coev_config cc;     /* settings passed on to de_coev()    */
+   int   quiet;           /* no console output during the run   */
+   int   delta;           /* evaluate with evaluate_delta()     */
+   char  *function;       /* built-in test function, or NULL    */
+   char  *bounds;         /* file of per-parameter bounds       */
+   char  *quant;          /* grid steps, comma list cycled over */
+                          /* the parameters                     */
+   char  *eval_cmd;       /* command of external evaluators     */
+   int   eval_workers;
+   double eval_timeout;
+   int   eval_retries;
+   int   refresh;         /* refresh rate of screen output      */
+   int   jobs;            /* runs of a sweep at once, 0 for all */
+                          /* cores                              */
+   de_ext *ext;           /* external evaluators, --eval-cmd    */
+   de_objective fn;       /* objective passed to the solver     */
+   void  *fn_user;
+} cli_args;
+
+typedef struct cli_opt
+{
+   char  *name;
+   int   type;            /* OPT_INT, OPT_DBL, OPT_KEY, ...     */
+   size_t off;            /* offset of the field in cli_args    */
+   char  **keys;          /* value names for OPT_KEY            */
+   int   nkeys;
+   char  *help;
+} cli_opt;
+
+static cli_opt opts[] =
+{
+   {"strategy", OPT_INT, offsetof(cli_args,cfg.strategy), NULL, 0,
+    "choice of strategy 1..10 (input file)"},
+   {"genmax", OPT_INT, offsetof(cli_args,cfg.genmax), NULL, 0,
+    "maximum number of generations (input file)"},
+   {"refresh", OPT_INT, offsetof(cli_args,refresh), NULL, 0,
+    "output refresh cycle (input file)"},
+   {"D", OPT_INT, offsetof(cli_args,cfg.D), NULL, 0,
+    "number of parameters (input file)"},
+   {"NP", OPT_INT, offsetof(cli_args,cfg.NP), NULL, 0,
+    "population size (input file)"},
+   {"inibound-h", OPT_DBL, offsetof(cli_args,cfg.inibound_h), NULL, 0,
+    "upper parameter bound for init (input file)"},
+   {"inibound-l", OPT_DBL, offsetof(cli_args,cfg.inibound_l), NULL, 0,
+    "lower parameter bound for init (input file)"},
+   {"F", OPT_DBL, offsetof(cli_args,cfg.F), NULL, 0,
+    "weight factor (input file)"},
+   {"CR", OPT_DBL, offsetof(cli_args,cfg.CR), NULL, 0,
+    "crossing over factor (input file)"},
+   {"seed", OPT_INT, offsetof(cli_args,cfg.seed), NULL, 0,
+    "random seed (input file)"},
+   {"threads", OPT_INT, offsetof(cli_args,cfg.threads), NULL, 0,
+    "threads per run (input file, default 1)"},
+   {"jobs", OPT_INT, offsetof(cli_args,jobs), NULL, 0,
+    "runs of a sweep at once (default 0, all cores)"},
+   {"function", OPT_STR, offsetof(cli_args,function), NULL, 0,
+    "built-in test function instead of evaluate(), see below"},
+   {"rng", OPT_KEY, offsetof(cli_args,cfg.rng), de_rng_name, 2,
+    "random number generator: ran2 (default) or xoshiro"},
+   {"mode", OPT_KEY, offsetof(cli_args,cfg.mode), de_mode_name, 2,
+    "iteration: sync (default) or async steady-state"},
+   {"checkpoint", OPT_STR, offsetof(cli_args,cfg.checkpoint), NULL, 0,
+    "snapshot file written every checkpoint-every generations"},
+   {"checkpoint-every", OPT_INT, offsetof(cli_args,cfg.checkpoint_every), NULL, 0,
+    "generations between snapshots (default 100)"},
+   {"resume", OPT_INT, offsetof(cli_args,cfg.resume), NULL, 0,
+    "continue from the checkpoint, appending to the output file"},
+   {"trace", OPT_STR, offsetof(cli_args,cfg.trace), NULL, 0,
+    "binary trace file, replaces the per-generation output lines"},
+   {"trace-every", OPT_INT, offsetof(cli_args,cfg.trace_every), NULL, 0,
+    "generations between trace records (default 1)"},
+   {"trace-pop", OPT_INT, offsetof(cli_args,cfg.trace_pop), NULL, 0,
+    "generations between population snapshots (default 0, none)"},
+   {"quiet", OPT_INT, offsetof(cli_args,quiet), NULL, 0,
+    "no console output during the run"},
+   {"delta", OPT_INT, offsetof(cli_args,delta), NULL, 0,
+    "incremental evaluation with evaluate_delta(), sync mode only"},
+   {"adapt", OPT_KEY, offsetof(cli_args,cfg.adapt), de_adapt_name, 3,
+    "self-adaptive F and CR: none (default), jde or shade"},
+   {"np-min", OPT_INT, offsetof(cli_args,cfg.np_min), NULL, 0,
+    "shrink NP linearly to this size over the run (default 0, off)"},
+   {"bounds", OPT_STR, offsetof(cli_args,bounds), NULL, 0,
+    "file with lower and upper bound of every parameter, one pair a line"},
+   {"bound", OPT_KEY, offsetof(cli_args,cfg.bound), de_bound_name, 5,
+    "trials out of bounds: none (default), clamp, reflect, bounce, reinit"},
+   {"surrogate", OPT_INT, offsetof(cli_args,cfg.surr_k), NULL, 0,
+    "pre-screen trials with a k-NN surrogate of k neighbours (default 0, off)"},
+   {"surr-keep", OPT_DBL, offsetof(cli_args,cfg.surr_keep), NULL, 0,
+    "share of the trials the surrogate passes on (default 0.5)"},
+   {"surr-archive", OPT_INT, offsetof(cli_args,cfg.surr_archive), NULL, 0,
+    "evaluated points the surrogate keeps (default 20*NP)"},
+   {"local", OPT_KEY, offsetof(cli_args,cfg.local), de_local_name, 4,
+    "polish the best member: none (default), nm, pattern or lbfgs"},
+   {"local-every", OPT_INT, offsetof(cli_args,cfg.local_every), NULL, 0,
+    "generations between polishings, 0 for none (default 100)"},
+   {"local-stall", OPT_INT, offsetof(cli_args,cfg.local_stall), NULL, 0,
+    "polish after this many generations without improvement (default 0, off)"},
+   {"local-budget", OPT_LONG, offsetof(cli_args,cfg.local_budget), NULL, 0,
+    "evaluations per polishing (default 20*(D+1))"},
+   {"quant", OPT_LIST, offsetof(cli_args,quant), NULL, 0,
+    "grid steps of the parameters, e.g. 1,1,0.5, cycled; 0 continuous"},
+   {"cache", OPT_LONG, offsetof(cli_args,cfg.cache), NULL, 0,
+    "entries of the evaluation cache (default 0, off)"},
+   {"vtr", OPT_DBL, offsetof(cli_args,cfg.vtr), NULL, 0,
+    "stop when the best cost is <= this value to reach"},
+   {"stall", OPT_INT, offsetof(cli_args,cfg.stall), NULL, 0,
+    "stop after this many generations without improvement"},
+   {"cvar-min", OPT_DBL, offsetof(cli_args,cfg.cvar_min), NULL, 0,
+    "stop when the cost variance falls below this value"},
+   {"max-nfe", OPT_LONG, offsetof(cli_args,cfg.max_nfeval), NULL, 0,
+    "stop after this many function evaluations"},
+   {"max-wall", OPT_DBL, offsetof(cli_args,cfg.max_wall), NULL, 0,
+    "stop after this many seconds"},
+   {"eval-cmd", OPT_STR, offsetof(cli_args,eval_cmd), NULL, 0,
+    "evaluate in worker processes started with this command"},
+   {"eval-workers", OPT_INT, offsetof(cli_args,eval_workers), NULL, 0,
+    "number of worker processes (default 1)"},
+   {"eval-timeout", OPT_DBL, offsetof(cli_args,eval_timeout), NULL, 0,
+    "seconds a worker may take per frame, 0 (default) waits forever"},
+   {"eval-retries", OPT_INT, offsetof(cli_args,eval_retries), NULL, 0,
+    "restarts per frame before its costs are set to HUGE_VAL (default 1)"},
+   {"islands", OPT_INT, offsetof(cli_args,isl.K), NULL, 0,
+    "number of islands, 0 (default) runs a single population"},
+   {"migrate", OPT_INT, offsetof(cli_args,isl.every), NULL, 0,
+    "generations between migrations (default 10)"},
+   {"topology", OPT_KEY, offsetof(cli_args,isl.topology), de_topo_name, 3,
+    "migration topology: ring (default), random or full"},
+   {"island-exec", OPT_KEY, offsetof(cli_args,isl.exec), de_exec_name, 2,
+    "run islands as process (default) or thread"},
+   {"island-strategy", OPT_LIST, offsetof(cli_args,isl_strategy), NULL, 0,
+    "strategies of the islands, e.g. 1,7,10"},
+   {"island-F", OPT_LIST, offsetof(cli_args,isl_F), NULL, 0,
+    "weight factors of the islands, e.g. 0.5,0.9"},
+   {"island-CR", OPT_LIST, offsetof(cli_args,isl_CR), NULL, 0,
+    "crossing over factors of the islands, e.g. 0.1,0.9"},
+   {"coev", OPT_INT, offsetof(cli_args,cc.size), NULL, 0,
+    "parameters per subcomponent of cooperative coevolution, 0 (default) off"},
+   {"grouping", OPT_KEY, offsetof(cli_args,cc.grouping), de_group_name, 3,
+    "subcomponents: fixed (default), random every cycle or diff"},
+   {"coev-gens", OPT_INT, offsetof(cli_args,cc.gens), NULL, 0,
+    "generations of a subcomponent per cycle (default 50); genmax cycles"},
+   {"coev-parallel", OPT_INT, offsetof(cli_args,cc.parallel), NULL, 0,
+    "solve the subcomponents of a cycle side by side on the threads"},
+   {"coev-eps", OPT_DBL, offsetof(cli_args,cc.eps), NULL, 0,
+    "interaction threshold of --grouping=diff (default 1e-3)"},
+};
+
+#define NOPTS ((int)(sizeof(opts)/sizeof(opts[0])))
+
+typedef struct cli_out
+{
+   FILE  *fpout_ptr;      /* output file                        */
+   int   refresh;         /* refresh rate of screen output      */
+   int   strategy;        /* choice parameter for screen output */
+   double F,CR;           /* control variables of DE            */
+   int   quiet;           /* no console output                  */
+   int   lines;           /* one line per generation in file    */
+} cli_out;
 
-void  assignd(int D, double a[], double b[])
+typedef struct cli_dim    /* a key of a config file with a list */
+{
+   const char *name;      /* option name                        */
+   char  **vals;          /* its values as text                 */
+   int   n;
+} cli_dim;
+
+typedef struct cli_run    /* one run of a sweep                 */
+{
+   cli_args  a;
+   de_result res;
+   int   ok;              /* de_solve() returned DE_OK          */
+} cli_run;
+
+typedef struct cli_sweep
+{
+   cli_dim dim[MAXDIMS];  /* the last one varies fastest        */
+   int   ndim;
+   cli_run *run;
+   int   nrun;
+   int   done;            /* runs finished so far               */
+} cli_sweep;
+
+
+static volatile sig_atomic_t stop_flag;  /* set by SIGINT and SIGTERM */
+
+static void on_signal(int sig)
 /**C*F****************************************************************
 **                                                                  **
-** Assigns D-dimensional vector b to vector a.                      **
-** You might encounter problems with the macro ASSIGND on some      **
-** machines. If yes, better use this function although it's slower. **
+** Asks the run to stop after the current generation, so that the   **
+** final results are still written. A second signal ends the        **
+** process at once, in case a generation does not finish.           **
 **                                                                  **
 ***C*F*E*************************************************************/
 {
-   int j;
+   stop_flag = 1;
+   signal(SIGINT,SIG_DFL);
+   signal(SIGTERM,SIG_DFL);
+}
+
+
+static int find_option(const char *name)
+/**C*F****************************************************************
+**                                                                  **
+** Returns the index of option name in opts[], or -1.               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   for (k=0; k<NOPTS; k++)
+   {
+      if (strcmp(opts[k].name,name) == 0) return k;
+   }
+   return -1;
+}
+
+
+static int set_option(cli_args *a, const char *name, const char *val)
+/**C*F****************************************************************
+**                                                                  **
+** Sets option name to the text val. Returns 0 on success, -1 for   **
+** an unknown name and -2 for an invalid value.                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char *end;
+   char *field;
+   int  k, j;
+
+   if ((k = find_option(name)) < 0) return -1;
+   field = (char *)a + opts[k].off;
+
+   if (opts[k].type == OPT_INT)
+   {
+      *(int *)field = (int)strtol(val,&end,10);
+      return (end == val || *end != '\0') ? -2 : 0;
+   }
+   if (opts[k].type == OPT_LONG)
+   {
+      *(long *)field = strtol(val,&end,10);
+      return (end == val || *end != '\0') ? -2 : 0;
+   }
+   if (opts[k].type == OPT_DBL)
+   {
+      *(double *)field = strtod(val,&end);
+      return (end == val || *end != '\0') ? -2 : 0;
+   }
+   if (opts[k].type == OPT_STR || opts[k].type == OPT_LIST)
+   {
+      *(const char **)field = val;
+      return 0;
+   }
+   for (j=0; j<opts[k].nkeys; j++)
+   {
+      if (strcmp(opts[k].keys[j],val) == 0)
+      {
+         *(int *)field = j;
+         return 0;
+      }
+   }
+   return -2;
+}
+
+
+static void usage(void)
+/**C*F****************************************************************
+**                                                                  **
+** Prints the command line syntax, the list of options and the      **
+** test functions.                                                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   printf("\nUsage : de [--option=value ...] <input-file> <output-file>\n");
+   printf("The input file is the positional dj9.dat format or lines of\n");
+   printf("option = value, value, lo:hi[:step] ...; lists sweep all combinations.\n");
+   for (k=0; k<NOPTS; k++)
+   {
+      printf("  --%-16s %s\n",opts[k].name,opts[k].help);
+   }
+   printf("\nTest functions, also as shifted-<name> and rotated-<name>:\n ");
+   for (k=0; de_funcs[k].name != NULL; k++) printf(" %s",de_funcs[k].name);
+   printf("\n");
+}
+
+
+static int list_item(const char *list, int k, double *v)
+/**C*F****************************************************************
+**                                                                  **
+** Sets *v to item k of the comma separated list, counting cycli-   **
+** cally. Returns 0 on success and -1 for an empty or bad list.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const char *p;
+   char *end;
+   int  n = 1;
+
+   for (p=list; *p; p++)
+   {
+      if (*p == ',') n++;
+   }
+   for (p=list, k%=n; k>0; k--) p = strchr(p,',') + 1;
+   *v = strtod(p,&end);
+   return (end == p || (*end != ',' && *end != '\0')) ? -1 : 0;
+}
+
+
+static char *trim(char *p)
+/**C*F****************************************************************
+**                                                                  **
+** Strips leading and trailing white space from p in place.         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char *e;
+
+   while (isspace((unsigned char)*p)) p++;
+   for (e=p+strlen(p); e>p && isspace((unsigned char)e[-1]); e--);
+   *e = '\0';
+   return p;
+}
+
+
+static char *squeeze(const char *p)
+/**C*F****************************************************************
+**                                                                  **
+** Returns a copy of p without white space, so that a list such as  **
+** "1, 7" is one value for list_item().                             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char *q, *e;
+
+   q = (char *)malloc(strlen(p)+1);
+   if (q == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+   for (e=q; *p; p++)
+   {
+      if (!isspace((unsigned char)*p)) *e++ = *p;
+   }
+   *e = '\0';
+   return q;
+}
+
+
+static int expand(const char *name, char *list, char ***vals)
+/**C*F****************************************************************
+**                                                                  **
+** Splits the value list of a config file line into *vals: items    **
+** separated by commas, and for numeric options ranges lo:hi or     **
+** lo:hi:step (default step 1) with both ends included. Returns     **
+** the number of values, or -1 for a bad range.                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char  buf[64];
+   char  *item, *save, *end;
+   double r[3];
+   int   k = find_option(name), n = 0, cap = 0, m, i, j;
+   char  **v = NULL;
+
+   for (item=strtok_r(list,",",&save); item!=NULL; item=strtok_r(NULL,",",&save))
+   {
+      item = trim(item);
+      m = 1;
+      r[2] = 1;
+      if (opts[k].type != OPT_STR && opts[k].type != OPT_KEY && strchr(item,':'))
+      {
+         for (i=0, end=item; i<3; i++)
+         {
+            r[i] = strtod(end,&end);
+            if (*end != ':') break;
+            end++;
+         }
+         if (i < 1 || i > 2 || *end != '\0' || !(r[2] > 0) || !(r[1] >= r[0]))
+         {
+            return -1;
+         }
+         m = (int)floor((r[1] - r[0])/r[2] + 1e-9) + 1;
+         if (m > MAXRUNS) return -1;
+      }
+      if (n + m > cap)
+      {
+         cap = 2*(n + m);
+         v = (char **)realloc(v,cap*sizeof(char *));
+         if (v == NULL) return -1;
+      }
+      for (j=0; j<m; j++)
+      {
+         if (m > 1 || strchr(item,':'))
+         {
+            snprintf(buf,sizeof(buf),"%.15g",r[0] + j*r[2]);
+            v[n++] = strdup(buf);
+         }
+         else v[n++] = strdup(item);
+      }
+   }
+   *vals = v;
+   return n;
+}
+
+
+static void drop_dim(cli_sweep *sw, const char *name)
+/**C*F****************************************************************
+**                                                                  **
+** Removes key name from the swept keys, if it is one, because a    **
+** later setting overrides it.                                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int d;
+
+   for (d=0; d<sw->ndim; d++)
+   {
+      if (strcmp(sw->dim[d].name,name) != 0) continue;
+      sw->ndim--;
+      memmove(&sw->dim[d],&sw->dim[d+1],(sw->ndim-d)*sizeof(cli_dim));
+      return;
+   }
+}
+
+
+static int is_keyed(FILE *fp)
+/**C*F****************************************************************
+**                                                                  **
+** Tells a keyed config file from a positional one by its first     **
+** character: a positional file starts with a number.               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int c;
+
+   while ((c = getc(fp)) != EOF && isspace(c));
+   if (c != EOF) ungetc(c,fp);
+   return c == '#' || isalpha(c);
+}
+
+
+static void read_keyed(cli_args *a, cli_sweep *sw, FILE *fp)
+/**C*F****************************************************************
+**                                                                  **
+** Reads a keyed config file: "name = value" lines, name being any  **
+** option, # starting a comment. A single value is set right away,  **
+** a list of several becomes a swept key, except for options whose  **
+** value is a list already (OPT_LIST). Later lines override         **
+** earlier ones.                                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char  line[4096];
+   char  *key, *val, *eq;
+   char  **vals;
+   cli_args tmp;
+   int   n, i, lineno = 0;
+
+   while (fgets(line,sizeof(line),fp) != NULL)
+   {
+      lineno++;
+      if ((eq = strchr(line,'#')) != NULL) *eq = '\0';
+      key = trim(line);
+      if (*key == '\0') continue;
+      eq = strchr(key,'=');
+      if (eq == NULL)
+      {
+         printf("\nError! input file line %d, should be name = value\n",lineno);
+         exit(1);
+      }
+      *eq = '\0';
+      key = trim(key);
+      val = trim(eq+1);
+      if (find_option(key) < 0)
+      {
+         printf("\nError! input file line %d, unknown name %s\n",lineno,key);
+         exit(1);
+      }
+      drop_dim(sw,key);
+      if (opts[find_option(key)].type == OPT_LIST)
+      {
+         set_option(a,key,squeeze(val));
+         continue;
+      }
+      n = expand(key,val,&vals);
+      for (i=0, tmp=*a; i<n; i++)
+      {
+         if (set_option(&tmp,key,vals[i]) != 0) n = -1;
+      }
+      if (n <= 0)
+      {
+         printf("\nError! input file line %d, invalid value for %s\n",lineno,key);
+         exit(1);
+      }
+      if (n == 1)
+      {
+         set_option(a,key,vals[0]);
+         free(vals);
+         continue;
+      }
+      if (sw->ndim == MAXDIMS)
+      {
+         printf("\nError! more than %d keys with several values\n",MAXDIMS);
+         exit(1);
+      }
+      sw->dim[sw->ndim].name = opts[find_option(key)].name;
+      sw->dim[sw->ndim].vals = vals;
+      sw->dim[sw->ndim].n    = n;
+      sw->ndim++;
+   }
+}
+
+
+static double objective(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Adapts the linked-in evaluate() to the de_objective interface.   **
+** de_solve() counts the evaluations itself.                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   long nfeval = 0;
+   return evaluate(D,(double *)x,&nfeval);
+}
+
+
+static void objective_batch(int D, int n, const double *X, size_t stride,
+                            double *costs, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Adapts evaluate_batch() to the de_batch interface. Only used if  **
+** the objective file defines evaluate_batch().                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   evaluate_batch(D,n,X,stride,costs);
+}
+
+
+static double objective_delta(int D, const double x[], int lo, int len,
+                              const double *pstate, double *state, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Adapts evaluate_delta() to the de_delta interface. Only used     **
+** with --delta.                                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   return evaluate_delta(D,x,lo,len,pstate,state);
+}
+
+
+static int feasible(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Adapts evaluate_feasible() to the de_feasible interface. Used if **
+** the objective file defines evaluate_feasible().                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   return evaluate_feasible(D,x);
+}
+
+
+static void read_bounds(cli_args *a)
+/**C*F****************************************************************
+**                                                                  **
+** Reads D pairs of lower and upper bound from the --bounds file    **
+** into a->cfg.lo and a->cfg.hi.                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   FILE  *fp;
+   double *lo;
+   int   j, D = a->cfg.D;
+
+   fp = fopen(a->bounds,"r");
+   if (fp == NULL)
+   {
+      printf("\nCannot open bounds file %s\n",a->bounds);
+      exit(1);
+   }
+   lo = (double *)malloc(2*D*sizeof(double));
+   if (lo == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+   for (j=0; j<D; j++)
+   {
+      if (fscanf(fp,"%lf %lf",&lo[j],&lo[D+j]) != 2)
+      {
+         printf("\nError! bounds file %s has fewer than D=%d pairs\n",a->bounds,D);
+         exit(1);
+      }
+   }
+   fclose(fp);
+   a->cfg.lo = lo;
+   a->cfg.hi = lo + D;
+}
+
+
+static void read_quant(cli_args *a)
+/**C*F****************************************************************
+**                                                                  **
+** Sets a->cfg.quant from the --quant list, cycled over the D       **
+** parameters.                                                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double *q;
+   int   j, D = a->cfg.D;
+
+   q = (double *)malloc(D*sizeof(double));
+   if (q == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
    for (j=0; j<D; j++)
    {
-      a[j] = b[j];
+      if (list_item(a->quant,j,&q[j]) != 0)
+      {
+         printf("\nError! invalid list --quant=%s\n",a->quant);
+         exit(1);
+      }
    }
+   a->cfg.quant = q;
 }
 
 
-double rnd_uni(long *idum)
+static void set_function(cli_args *a)
 /**C*F****************************************************************
 **                                                                  **
-** SRC-FUNCTION   :rnd_uni()                                        **
-** LONG_NAME      :random_uniform                                   **
-** AUTHOR         :(see below)                                      **
+** Selects the objective: evaluate(), or the test function named by **
+** --function, shifted and rotated with the seed if so prefixed.    **
 **                                                                  **
-** DESCRIPTION    :rnd_uni() generates an equally distributed ran-  **
-**                 dom number in the interval [0,1]. For further    **
-**                 reference see Press, W.H. et alii, Numerical     **
-**                 Recipes in C, Cambridge University Press, 1992.  **
+***C*F*E*************************************************************/
+{
+   const de_func *f;
+   const char *name = a->function;
+   int shift = 0, rotate = 0;
+
+   a->fn      = objective;
+   a->fn_user = NULL;
+   if (name == NULL) return;
+
+   if (strncmp(name,"shifted-",8) == 0) shift = 1, name += 8;
+   else if (strncmp(name,"rotated-",8) == 0) shift = rotate = 1, name += 8;
+   f = de_func_find(name);
+   if (f == NULL)
+   {
+      printf("\nError! unknown function %s\n",a->function);
+      usage();
+      exit(1);
+   }
+   if (!shift)
+   {
+      a->fn = f->fn;
+      return;
+   }
+   a->fn      = de_problem_eval;
+   a->fn_user = de_problem_create(f,a->cfg.D,rotate,a->cfg.seed);
+   if (a->fn_user == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+}
+
+
+static void set_objective(cli_args *a)
+/**C*F****************************************************************
 **                                                                  **
-** FUNCTIONS      :none                                             **
+** Sets up the evaluation of a run from scratch: set_function(),    **
+** then the external evaluators of --eval-cmd, or evaluate_batch(), **
+** evaluate_delta() and evaluate_feasible() if the objective file   **
+** defines them and the options ask for or allow them.              **
 **                                                                  **
-** GLOBALS        :none                                             **
+***C*F*E*************************************************************/
+{
+   a->cfg.batch       = NULL;
+   a->cfg.delta       = NULL;
+   a->cfg.delta_state = 0;
+   a->cfg.feasible    = NULL;
+   set_function(a);
+   if (evaluate_feasible != NULL && a->function == NULL && a->cc.size == 0)
+   {
+      a->cfg.feasible = feasible;
+   }
+   if (a->delta)
+   {
+      if (evaluate_delta == NULL || evaluate_delta_state == NULL || a->function != NULL)
+      {
+         printf("\nError! --delta needs evaluate_delta() and evaluate_delta_state()\n");
+         exit(1);
+      }
+      a->cfg.delta       = objective_delta;
+      a->cfg.delta_state = evaluate_delta_state(a->cfg.D);
+   }
+   if (a->ext != NULL)
+   {
+      a->cfg.batch = de_ext_batch;
+      a->fn        = NULL;
+      a->fn_user   = a->ext;
+   }
+   else if (evaluate_batch != NULL && a->function == NULL && !a->delta &&
+            a->isl.K == 0 && a->cc.size == 0)
+   {
+      a->cfg.batch = objective_batch;
+   }
+}
+
+
+static void monitor(const de_progress *p, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Console output every refresh generations and one line per        **
+** generation in the output file, unless --quiet or --trace.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cli_out *o = (cli_out *)user;
+   int j;
+
+   if (!o->quiet && p->gen%o->refresh==1)   /* display after every refresh generations */
+   {
+     printf("\n\n                         PRESS CTRL-C TO STOP  ");
+     printf("\n\n\n Best-so-far cost funct. value=%-15.10g\n",p->cmin);
+
+     for (j=0;j<p->D;j++)
+     {
+       printf("\n best[%d]=%-15.10g",j,p->best[j]);
+     }
+     printf("\n\n Generation=%d  NFEs=%ld   Strategy: %s    ",p->gen,p->nfeval,de_strat[o->strategy]);
+     printf("\n NP=%d    F=%-4.2g    CR=%-4.2g   cost-variance=%-10.5g\n",
+            p->NP,o->F,o->CR,p->cvar);
+   }
+
+   if (o->lines) fprintf(o->fpout_ptr,"%ld   %-15.10g\n",p->nfeval,p->cmin);
+}
+
+
+static void run_islands(cli_args *a, FILE *fpout_ptr)
+/**C*F****************************************************************
 **                                                                  **
-** PARAMETERS     :*idum    serves as a seed value                  **
+** Runs a.isl.K islands with the strategy, F and CR lists applied   **
+** and seeds seed, seed+1, ..., and writes the best member of all   **
+** islands and one line per island to the output file.              **
 **                                                                  **
-** PRECONDITIONS  :*idum must be negative on the first call.        **
+***C*F*E*************************************************************/
+{
+   char  msg[128];
+   int   K = a->isl.K;
+   int   k, j;
+   double v;
+   de_config *cfg;
+   de_result *res, total;
+
+   cfg = (de_config *)calloc(K,sizeof(de_config));
+   res = (de_result *)calloc(K,sizeof(de_result));
+   total.best = (double *)malloc(a->cfg.D*sizeof(double));
+   if (cfg == NULL || res == NULL || total.best == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+
+   for (k=0; k<K; k++)
+   {
+      cfg[k] = a->cfg;
+      cfg[k].seed += k;
+      cfg[k].stop  = &stop_flag;
+      if (a->isl_strategy != NULL)
+      {
+         if (list_item(a->isl_strategy,k,&v) != 0)
+         {
+            printf("\nError! invalid list --island-strategy=%s\n",a->isl_strategy);
+            exit(1);
+         }
+         cfg[k].strategy = (int)v;
+      }
+      if (a->isl_F != NULL && list_item(a->isl_F,k,&cfg[k].F) != 0)
+      {
+         printf("\nError! invalid list --island-F=%s\n",a->isl_F);
+         exit(1);
+      }
+      if (a->isl_CR != NULL && list_item(a->isl_CR,k,&cfg[k].CR) != 0)
+      {
+         printf("\nError! invalid list --island-CR=%s\n",a->isl_CR);
+         exit(1);
+      }
+      if (de_check(&cfg[k],msg,sizeof(msg)) != DE_OK)
+      {
+         printf("\nIsland %d: %s\n",k,msg);
+         exit(1);
+      }
+      res[k].best = NULL;
+   }
+
+   signal(SIGINT,on_signal);
+   signal(SIGTERM,on_signal);
+   if (de_islands(&a->isl,cfg,a->fn,a->fn_user,res,&total) != DE_OK)
+   {
+      printf("\nde_islands() failed\n");
+      exit(1);
+   }
+
+   printf("\n\n Best-so-far cost funct. value=%-15.10g\n",total.cmin);
+
+   fprintf(fpout_ptr,"\n\n\n Best-so-far obj. funct. value = %-15.10g\n",total.cmin);
+   for (j=0;j<a->cfg.D;j++)
+   {
+     fprintf(fpout_ptr,"\n best[%d]=%-15.10g",j,total.best[j]);
+   }
+   fprintf(fpout_ptr,"\n\n Islands=%d  NFEs=%ld   migrate=%d  topology=%s  %s\n",
+           K,total.nfeval,a->isl.every,de_topo_name[a->isl.topology],
+           de_exec_name[a->isl.exec]);
+   for (k=0; k<K; k++)
+   {
+      fprintf(fpout_ptr," Island %d: Strategy: %s  F=%-4.2g  CR=%-4.2g  seed=%d  best=%-15.10g  NFEs=%ld  Generation=%d  Stop: %s\n",
+              k,de_strat[cfg[k].strategy],cfg[k].F,cfg[k].CR,cfg[k].seed,
+              res[k].cmin,res[k].nfeval,res[k].gen,de_stop_name[res[k].stop]);
+   }
+   fprintf(fpout_ptr," wall=%.5gs  evals/s=%.5g\n",total.wall,total.evals_per_sec);
+
+   free(total.best);
+   free(res);
+   free(cfg);
+}
+
+
+static int value_index(const cli_sweep *sw, int i, int d)
+/**C*F****************************************************************
 **                                                                  **
-** POSTCONDITIONS :*idum will be changed                            **
+** Index of the value of swept key d in run i.                      **
 **                                                                  **
 ***C*F*E*************************************************************/
 {
-  long j;
-  long k;
-  static long idum2=123456789;
-  static long iy=0;
-  static long iv[NTAB];
-  double temp;
+   int k;
 
-  if (*idum <= 0)
-  {
-    if (-(*idum) < 1) *idum=1;
-    else *idum = -(*idum);
-    idum2=(*idum);
-    for (j=NTAB+7;j>=0;j--)
-    {
-      k=(*idum)/IQ1;
-      *idum=IA1*(*idum-k*IQ1)-k*IR1;
-      if (*idum < 0) *idum += IM1;
-      if (j < NTAB) iv[j] = *idum;
-    }
-    iy=iv[0];
-  }
-  k=(*idum)/IQ1;
-  *idum=IA1*(*idum-k*IQ1)-k*IR1;
-  if (*idum < 0) *idum += IM1;
-  k=idum2/IQ2;
-  idum2=IA2*(idum2-k*IQ2)-k*IR2;
-  if (idum2 < 0) idum2 += IM2;
-  j=iy/NDIV;
-  iy=iv[j]-idum2;
-  iv[j] = *idum;
-  if (iy < 1) iy += IMM1;
-  if ((temp=AM*iy) > RNMX) return RNMX;
-  else return temp;
+   for (k=sw->ndim-1; k>d; k--) i /= sw->dim[k].n;
+   return i%sw->dim[d].n;
+}
+
+
+static void sweep_task(void *arg, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: does run i of the sweep and reports it on the console.**
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cli_sweep *sw = (cli_sweep *)arg;
+   cli_run *r = &sw->run[i];
+   int n;
+
+   r->res.best = NULL;
+   r->ok = (de_solve(&r->a.cfg,r->a.fn,r->a.fn_user,&r->res) == DE_OK);
+   if (r->a.ext == NULL) de_problem_free((de_problem *)r->a.fn_user);
+   n = __atomic_add_fetch(&sw->done,1,__ATOMIC_RELAXED);
+   if (r->a.quiet) return;
+   if (r->ok)
+   {
+      printf(" Run %d (%d/%d): best=%-15.10g NFEs=%ld  Stop: %s\n",i,n,sw->nrun,
+             r->res.cmin,r->res.nfeval,de_stop_name[r->res.stop]);
+   }
+   else printf(" Run %d (%d/%d): de_solve() failed\n",i,n,sw->nrun);
+   fflush(stdout);
+}
 
-}/*------End of rnd_uni()--------------------------*/
 
+static void run_sweep(cli_args *a, cli_sweep *sw, FILE *fpout_ptr)
+/**C*F****************************************************************
+**                                                                  **
+** Does one run for every combination of the values of the swept    **
+** keys, a.jobs at a time, and writes one line per run to the       **
+** output file: the swept values, best cost, NFEs, generations,     **
+** wall time and stop reason.                                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char  msg[128];
+   long  n = 1;
+   int   i, d, b = -1;
+   cli_run *r;
+   de_pool *pool;
+
+   for (d=0; d<sw->ndim; d++) n *= sw->dim[d].n;
+   if (n > MAXRUNS)
+   {
+      printf("\nError! the sweep has %ld runs, more than %d\n",n,MAXRUNS);
+      exit(1);
+   }
+   sw->nrun = (int)n;
+   sw->done = 0;
+   sw->run  = (cli_run *)calloc(n,sizeof(cli_run));
+   if (sw->run == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+
+   for (i=0; i<sw->nrun; i++)
+   {
+      r = &sw->run[i];
+      r->a = *a;
+      for (d=0; d<sw->ndim; d++)
+      {
+         set_option(&r->a,sw->dim[d].name,sw->dim[d].vals[value_index(sw,i,d)]);
+      }
+      set_objective(&r->a);
+      r->a.cfg.stop    = &stop_flag;
+      r->a.cfg.monitor = NULL;
+      if (de_check(&r->a.cfg,msg,sizeof(msg)) != DE_OK)
+      {
+         printf("\nRun %d: %s\n",i,msg);
+         exit(1);
+      }
+      if ((a->ext != NULL || a->bounds != NULL || a->quant != NULL) &&
+          r->a.cfg.D != a->cfg.D)
+      {
+         printf("\nRun %d: D cannot be swept with --eval-cmd, --bounds or --quant\n",i);
+         exit(1);
+      }
+      if (a->ext != NULL && (r->a.function != NULL || r->a.delta))
+      {
+         printf("\nRun %d: --eval-cmd cannot be used with --function or --delta\n",i);
+         exit(1);
+      }
+   }
+
+   if (a->jobs == 0) a->jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+   if (a->jobs < 1) a->jobs = 1;
+   if (a->jobs > sw->nrun) a->jobs = sw->nrun;
+   pool = de_pool_create(a->jobs);
+   if (pool == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+   if (!a->quiet) printf("\n Sweep: %d runs, %d at a time\n",sw->nrun,a->jobs);
+   signal(SIGINT,on_signal);
+   signal(SIGTERM,on_signal);
+   de_pool_run(pool,sw->nrun,sweep_task,sw);
+   de_pool_free(pool);
+
+/*-------Results table, one line per run in run order-------------------*/
+
+   fprintf(fpout_ptr,"run");
+   for (d=0; d<sw->ndim; d++) fprintf(fpout_ptr,",%s",sw->dim[d].name);
+   fprintf(fpout_ptr,",best_cost,nfe,gens,wall_s,stop\n");
+   for (i=0; i<sw->nrun; i++)
+   {
+      r = &sw->run[i];
+      fprintf(fpout_ptr,"%d",i);
+      for (d=0; d<sw->ndim; d++)
+      {
+         fprintf(fpout_ptr,",%s",sw->dim[d].vals[value_index(sw,i,d)]);
+      }
+      if (!r->ok)
+      {
+         fprintf(fpout_ptr,",,,,,failed\n");
+         continue;
+      }
+      fprintf(fpout_ptr,",%.10g,%ld,%d,%.4g,%s\n",r->res.cmin,r->res.nfeval,
+              r->res.gen,r->res.wall,de_stop_name[r->res.stop]);
+      if (b < 0 || r->res.cmin < sw->run[b].res.cmin) b = i;
+   }
+   if (!a->quiet && b >= 0)
+   {
+      printf("\n\n Best run %d: cost=%-15.10g\n",b,sw->run[b].res.cmin);
+   }
+   free(sw->run);
+}
 
 
 int main(int argc, char *argv[])
@@ -103,20 +1024,23 @@ int main(int argc, char *argv[])
 ** AUTHOR         :Rainer Storn, Kenneth Price                      **
 **                                                                  **
 ** DESCRIPTION    :driver program for differential evolution.       **
+**                 The optimization itself is done by de_solve().   **
 **                                                                  **
-** FUNCTIONS      :rnd_uni(), evaluate(), printf(), fprintf(),      **
+** FUNCTIONS      :de_solve(), evaluate(), printf(), fprintf(),     **
 **                 fopen(), fclose(), fscanf().                     **
 **                                                                  **
-** GLOBALS        :rnd_uni_init    input variable for rnd_uni()     **
+** GLOBALS        :none                                             **
 **                                                                  **
-** PARAMETERS     :argc            #arguments = 3                   **
+** PARAMETERS     :argc            #arguments >= 3                  **
 **                 argv            pointer to argument strings      **
 **                                                                  **
 ** PRECONDITIONS  :main must be called with three parameters        **
 **                 e.g. like de1 <input-file> <output-file>, if     **
-**                 the executable file is called de1.               **
+**                 the executable file is called de1. Options of    **
+**                 the form --name=value may precede the files.     **
 **                 The input file must contain valid inputs accor-  **
-**                 ding to the fscanf() section of main().          **
+**                 ding to the fscanf() section of main(). The      **
+**                 number of threads may be omitted in old files.   **
 **                                                                  **
 ** POSTCONDITIONS :main() produces consecutive console outputs and  **
 **                 writes the final results in an output file if    **
@@ -125,58 +1049,54 @@ int main(int argc, char *argv[])
 ***C*F*E*************************************************************/
 
 {
-   char  chr;             /* y/n choice variable                */
-   char  *strat[] =       /* strategy-indicator                 */
-   {
-            "",
-            "DE/best/1/exp",
-            "DE/rand/1/exp",
-            "DE/rand-to-best/1/exp",
-            "DE/best/2/exp",
-            "DE/rand/2/exp",
-            "DE/best/1/bin",
-            "DE/rand/1/bin",
-            "DE/rand-to-best/1/bin",
-            "DE/best/2/bin",
-            "DE/rand/2/bin"
-   };
-
-   int   i, j, L, n;      /* counting variables                 */
-   int   r1, r2, r3, r4;  /* placeholders for random indexes    */
-   int   r5;              /* placeholders for random indexes    */
-   int   D;               /* Dimension of parameter vector      */
-   int   NP;              /* number of population members       */
-   int   imin;            /* index to member with lowest energy */
-   int   refresh;         /* refresh rate of screen output      */
-   int   strategy;        /* choice parameter for screen output */
-   int   gen, genmax, seed;   
-
-   long  nfeval;          /* number of function evaluations     */
-
-   double trial_cost;      /* buffer variable                    */
-   double inibound_h;      /* upper parameter bound              */
-   double inibound_l;      /* lower parameter bound              */
-   double tmp[MAXDIM], best[MAXDIM], bestit[MAXDIM]; /* members  */
-   double cost[MAXPOP];    /* obj. funct. values                 */
-   double cvar;            /* computes the cost variance         */
-   double cmean;           /* mean cost                          */
-   double F,CR;            /* control variables of DE            */
-   double cmin;            /* help variables                     */
+   char  msg[128];        /* error text from de_check()         */
+   char  name[64];        /* option name                        */
+   char  *arg[2];         /* input and output file              */
+   char  *eq;
+   int   narg;            /* number of file arguments           */
+   int   k;
+   int   j;               /* counting variable                  */
+   double *best;          /* best member found                  */
+   long  restarts, timeouts, failed;
+
+   cli_args  a;
+   cli_sweep sw;
+   de_result res;
+   cli_out   out;
 
    FILE  *fpin_ptr;
    FILE  *fpout_ptr;
 
 /*------Initializations----------------------------*/
 
- if (argc != 3)                                 /* number of arguments */
+ memset(&a,0,sizeof(a));
+ de_defaults(&a.cfg);
+ a.isl.every = 10;
+ a.isl.slots = 8;
+ a.cc.gens   = 50;
+ a.cc.eps    = 1e-3;
+ a.cfg.checkpoint_every = 100;
+ a.eval_workers = 1;
+ a.eval_retries = 1;
+ a.refresh = 10;           /* for keyed input files */
+ sw.ndim = 0;
+
+ narg = 0;
+ for (k=1; k<argc; k++)                /* the files first */
  {
-    printf("\nUsage : de <input-file> <output-file>\n");
+    if (strncmp(argv[k],"--",2) == 0) continue;
+    if (narg == 2) narg = 3;
+    else arg[narg++] = argv[k];
+ }
+ if (narg != 2)                                 /* number of arguments */
+ {
+    usage();
     exit(1);
  }
 
 /*-----Read input data------------------------------------------------*/
 
- fpin_ptr   = fopen(argv[1],"r");
+ fpin_ptr   = fopen(arg[0],"r");
 
  if (fpin_ptr == NULL)
  {
@@ -184,77 +1104,105 @@ int main(int argc, char *argv[])
     exit(1);                                 /* input file is necessary */
  }
 
- fscanf(fpin_ptr,"%d",&strategy);       /*---choice of strategy-----------------*/
- fscanf(fpin_ptr,"%d",&genmax);         /*---maximum number of generations------*/
- fscanf(fpin_ptr,"%d",&refresh);        /*---output refresh cycle---------------*/
- fscanf(fpin_ptr,"%d",&D);              /*---number of parameters---------------*/
- fscanf(fpin_ptr,"%d",&NP);             /*---population size.-------------------*/
- fscanf(fpin_ptr,"%lf",&inibound_h);    /*---upper parameter bound for init-----*/
- fscanf(fpin_ptr,"%lf",&inibound_l);    /*---lower parameter bound for init-----*/
- fscanf(fpin_ptr,"%lf",&F);             /*---weight factor----------------------*/
- fscanf(fpin_ptr,"%lf",&CR);            /*---crossing over factor---------------*/
- fscanf(fpin_ptr,"%d",&seed);           /*---random seed------------------------*/
-
+ if (is_keyed(fpin_ptr)) read_keyed(&a,&sw,fpin_ptr);
+ else
+ {
+    fscanf(fpin_ptr,"%d",&a.cfg.strategy);    /*---choice of strategy-----------------*/
+    fscanf(fpin_ptr,"%d",&a.cfg.genmax);      /*---maximum number of generations------*/
+    fscanf(fpin_ptr,"%d",&a.refresh);         /*---output refresh cycle---------------*/
+    fscanf(fpin_ptr,"%d",&a.cfg.D);           /*---number of parameters---------------*/
+    fscanf(fpin_ptr,"%d",&a.cfg.NP);          /*---population size.-------------------*/
+    fscanf(fpin_ptr,"%lf",&a.cfg.inibound_h); /*---upper parameter bound for init-----*/
+    fscanf(fpin_ptr,"%lf",&a.cfg.inibound_l); /*---lower parameter bound for init-----*/
+    fscanf(fpin_ptr,"%lf",&a.cfg.F);          /*---weight factor----------------------*/
+    fscanf(fpin_ptr,"%lf",&a.cfg.CR);         /*---crossing over factor---------------*/
+    fscanf(fpin_ptr,"%d",&a.cfg.seed);        /*---random seed------------------------*/
+    if (fscanf(fpin_ptr,"%d",&a.cfg.threads) != 1) /*---threads, optional-----*/
+    {
+       a.cfg.threads = 1;
+    }
+ }
 
  fclose(fpin_ptr);
 
+/*-----Options on the command line override the input file-------------*/
+
+ for (k=1; k<argc; k++)
+ {
+    if (strncmp(argv[k],"--",2) != 0) continue;
+    eq = strchr(argv[k],'=');       /* --name alone means --name=1 */
+    if (eq == NULL) eq = argv[k] + strlen(argv[k]);
+    if (eq-argv[k]-2 >= (int)sizeof(name))
+    {
+       printf("\nError! option %s, should be --name=value\n",argv[k]);
+       exit(1);
+    }
+    memcpy(name,argv[k]+2,eq-argv[k]-2);
+    name[eq-argv[k]-2] = '\0';
+    switch (set_option(&a,name,(*eq == '=') ? eq+1 : "1"))
+    {
+       case -1: printf("\nError! unknown option --%s\n",name);
+                usage();
+                exit(1);
+       case -2: printf("\nError! invalid value in %s\n",argv[k]);
+                exit(1);
+    }
+    drop_dim(&sw,name);
+ }
+
 /*-----Checking input variables for proper range----------------------------*/
 
-  if (D > MAXDIM)
-  {
-     printf("\nError! D=%d > MAXDIM=%d\n",D,MAXDIM);
-     exit(1);
-  }
-  if (D <= 0)
-  {
-     printf("\nError! D=%d, should be > 0\n",D);
-     exit(1);
-  }
-  if (NP > MAXPOP)
+  if (a.bounds != NULL) read_bounds(&a);
+  if (a.quant != NULL) read_quant(&a);
+  set_objective(&a);
+  if (sw.ndim == 0 && de_check(&a.cfg,msg,sizeof(msg)) != DE_OK)
   {
-     printf("\nError! NP=%d > MAXPOP=%d\n",NP,MAXPOP);
+     printf("\n%s\n",msg);
      exit(1);
   }
-  if (NP <= 0)
+  if (a.isl.K > 0 && (a.cfg.checkpoint != NULL || a.cfg.trace != NULL))
   {
-     printf("\nError! NP=%d, should be > 0\n",NP);
+     printf("\nError! --checkpoint and --trace cannot be used with --islands\n");
      exit(1);
   }
-  if ((CR < 0) || (CR > 1.0))
+  if (sw.ndim > 0 && (a.isl.K > 0 || a.cfg.checkpoint != NULL || a.cfg.trace != NULL))
   {
-     printf("\nError! CR=%f, should be ex [0,1]\n",CR);
+     printf("\nError! --islands, --checkpoint and --trace cannot be used in a sweep\n");
      exit(1);
   }
-  if (seed <= 0)
+  if (a.eval_cmd != NULL && (a.function != NULL || a.delta || a.isl.K > 0))
   {
-     printf("\nError! seed=%d, should be > 0\n",seed);
+     printf("\nError! --eval-cmd cannot be used with --function, --delta or --islands\n");
      exit(1);
   }
-  if (refresh <= 0)
+  if (a.cc.size > 0 && (sw.ndim > 0 || a.isl.K > 0 || a.delta || a.eval_cmd != NULL ||
+                        a.quant != NULL || a.cfg.checkpoint != NULL || a.cfg.trace != NULL))
   {
-     printf("\nError! refresh=%d, should be > 0\n",refresh);
+     printf("\nError! --coev cannot be used with --islands, --delta, --eval-cmd,\n");
+     printf("--quant, --checkpoint, --trace or in a sweep\n");
      exit(1);
   }
-  if (genmax <= 0)
+  if (a.cc.size < 0 || (a.cc.size > 0 && (a.cc.gens <= 0 || a.cc.eps < 0)))
   {
-     printf("\nError! genmax=%d, should be > 0\n",genmax);
+     printf("\nError! coev=%d, coev-gens=%d, coev-eps=%g, should be >= 0, > 0, >= 0\n",
+            a.cc.size,a.cc.gens,a.cc.eps);
      exit(1);
   }
-  if ((strategy < 0) || (strategy > 10))
+  if (a.eval_cmd != NULL && (a.eval_workers < 1 || a.eval_timeout < 0 || a.eval_retries < 0))
   {
-     printf("\nError! strategy=%d, should be ex {1,2,3,4,5,6,7,8,9,10}\n",strategy);
+     printf("\nError! --eval-workers should be > 0, --eval-timeout and --eval-retries >= 0\n");
      exit(1);
   }
-  if (inibound_h < inibound_l)
+  if (a.refresh <= 0 || a.jobs < 0)
   {
-     printf("\nError! inibound_h=%f < inibound_l=%f\n",inibound_h, inibound_l);
+     printf("\nError! refresh=%d, jobs=%d, should be > 0, >= 0\n",a.refresh,a.jobs);
      exit(1);
   }
 
 
 /*-----Open output file-----------------------------------------------*/
 
-   fpout_ptr   = fopen(argv[2],"w");  /* open output file for writing */
+   fpout_ptr   = fopen(arg[1],a.cfg.resume ? "a" : "w");  /* open output file for writing */
 
    if (fpout_ptr == NULL)
    {
@@ -262,344 +1210,147 @@ int main(int argc, char *argv[])
       exit(1);
    }
 
+/*-----Run the optimization---------------------------------------------*/
 
-/*-----Initialize random number generator-----------------------------*/
-
- rnd_uni_init = -(long)seed;  /* initialization of rnd_uni() */
- nfeval       =  0;  /* reset number of function evaluations */
-
-
-
-/*------Initialization------------------------------------------------*/
-/*------Right now this part is kept fairly simple and just generates--*/
-/*------random numbers in the range [-initfac, +initfac]. You might---*/
-/*------want to extend the init part such that you can initialize-----*/
-/*------each parameter separately.------------------------------------*/
-
-   for (i=0; i<NP; i++)
+   if (a.eval_cmd != NULL)
    {
-      for (j=0; j<D; j++) /* spread initial population members */
+      a.ext = de_ext_create(a.eval_cmd,a.eval_workers,a.cfg.D,a.eval_timeout,
+                            a.eval_retries);
+      if (a.ext == NULL)
       {
-	 c[i][j] = inibound_l + rnd_uni(&rnd_uni_init)*(inibound_h - inibound_l);
+         printf("\nCannot start evaluator %s\n",a.eval_cmd);
+         exit(1);
       }
-      cost[i] = evaluate(D,c[i],&nfeval); /* obj. funct. value */
+      set_objective(&a);
    }
-   cmin = cost[0];
-   imin = 0;
-   for (i=1; i<NP; i++)
+   if (sw.ndim > 0)
    {
-      if (cost[i]<cmin)
-      {
-	 cmin = cost[i];
-	 imin = i;
-      }
+      de_problem_free((de_problem *)a.fn_user);   /* each run has its own */
+      a.fn_user = NULL;
+      run_sweep(&a,&sw,fpout_ptr);
+      fclose(fpout_ptr);
+      if (a.ext != NULL) de_ext_free(a.ext);
+      free((double *)a.cfg.lo);
+      free((double *)a.cfg.quant);
+      return(0);
+   }
+   if (a.isl.K > 0)
+   {
+      run_islands(&a,fpout_ptr);
+      fclose(fpout_ptr);
+      de_problem_free((de_problem *)a.fn_user);
+      return(0);
    }
 
-   assignd(D,best,c[imin]);            /* save best member ever          */
-   assignd(D,bestit,c[imin]);          /* save best member of generation */
-
-   pold = &c; /* old population (generation G)   */
-   pnew = &d; /* new population (generation G+1) */
-
-/*=======================================================================*/
-/*=========Iteration loop================================================*/
-/*=======================================================================*/
-
-   gen = 0;                          /* generation counter reset */
-   while ((gen < genmax) /*&& (kbhit() == 0)*/) /* remove comments if conio.h */
-   {                                            /* is accepted by compiler    */
-      gen++;
-      imin = 0;
-
-      for (i=0; i<NP; i++)         /* Start of loop through ensemble  */
-      {
-	 do                        /* Pick a random population member */
-	 {                         /* Endless loop for NP < 2 !!!     */
-	   r1 = (int)(rnd_uni(&rnd_uni_init)*NP);
-	 }while(r1==i);            
-
-	 do                        /* Pick a random population member */
-	 {                         /* Endless loop for NP < 3 !!!     */
-	   r2 = (int)(rnd_uni(&rnd_uni_init)*NP);
-	 }while((r2==i) || (r2==r1));
-
-	 do                        /* Pick a random population member */
-	 {                         /* Endless loop for NP < 4 !!!     */
-	   r3 = (int)(rnd_uni(&rnd_uni_init)*NP);
-	 }while((r3==i) || (r3==r1) || (r3==r2));
-
-	 do                        /* Pick a random population member */
-	 {                         /* Endless loop for NP < 5 !!!     */
-	   r4 = (int)(rnd_uni(&rnd_uni_init)*NP);
-	 }while((r4==i) || (r4==r1) || (r4==r2) || (r4==r3));
-
-	 if (NP >= 6) {
-	   do                        /* Pick a random population member */
-	     {                         /* Endless loop for NP < 6 !!!     */
-	       r5 = (int)(rnd_uni(&rnd_uni_init)*NP);
-	     }while((r5==i) || (r5==r1) || (r5==r2) || (r5==r3) || (r5==r4));
-	 }
-
-
-/*=======Choice of strategy===============================================================*/
-/*=======We have tried to come up with a sensible naming-convention: DE/x/y/z=============*/
-/*=======DE :  stands for Differential Evolution==========================================*/
-/*=======x  :  a string which denotes the vector to be perturbed==========================*/
-/*=======y  :  number of difference vectors taken for perturbation of x===================*/
-/*=======z  :  crossover method (exp = exponential, bin = binomial)=======================*/
-/*                                                                                        */
-/*=======There are some simple rules which are worth following:===========================*/
-/*=======1)  F is usually between 0.5 and 1 (in rare cases > 1)===========================*/
-/*=======2)  CR is between 0 and 1 with 0., 0.3, 0.7 and 1. being worth to be tried first=*/
-/*=======3)  To start off NP = 10*D is a reasonable choice. Increase NP if misconvergence=*/
-/*           happens.                                                                     */
-/*=======4)  If you increase NP, F usually has to be decreased============================*/
-/*=======5)  When the DE/best... schemes fail DE/rand... usually works and vice versa=====*/
-
-
-/*=======EXPONENTIAL CROSSOVER============================================================*/
-
-/*-------DE/best/1/exp--------------------------------------------------------------------*/
-/*-------Our oldest strategy but still not bad. However, we have found several------------*/
-/*-------optimization problems where misconvergence occurs.-------------------------------*/
-	 if (strategy == 1) /* strategy DE0 (not in our paper) */
-	 {
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D);
-	   L = 0;
-	   do
-	   {                       
-	     tmp[n] = bestit[n] + F*((*pold)[r2][n]-(*pold)[r3][n]);
-	     n = (n+1)%D;
-	     L++;
-	   }while((rnd_uni(&rnd_uni_init) < CR) && (L < D));
-	 }
-/*-------DE/rand/1/exp-------------------------------------------------------------------*/
-/*-------This is one of my favourite strategies. It works especially well when the-------*/
-/*-------"bestit[]"-schemes experience misconvergence. Try e.g. F=0.7 and CR=0.5---------*/
-/*-------as a first guess.---------------------------------------------------------------*/
-	 else if (strategy == 2) /* strategy DE1 in the techreport */
-	 {
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D);
-	   L = 0;
-	   do
-	   {                       
-	     tmp[n] = (*pold)[r1][n] + F*((*pold)[r2][n]-(*pold)[r3][n]);
-	     n = (n+1)%D;
-	     L++;
-	   }while((rnd_uni(&rnd_uni_init) < CR) && (L < D));
-	 }
-/*-------DE/rand-to-best/1/exp-----------------------------------------------------------*/
-/*-------This strategy seems to be one of the best strategies. Try F=0.85 and CR=1.------*/
-/*-------If you get misconvergence try to increase NP. If this doesn't help you----------*/
-/*-------should play around with all three control variables.----------------------------*/
-	 else if (strategy == 3) /* similiar to DE2 but generally better */
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-	   L = 0;
-	   do
-	   {                       
-	     tmp[n] = tmp[n] + F*(bestit[n] - tmp[n]) + F*((*pold)[r1][n]-(*pold)[r2][n]);
-	     n = (n+1)%D;
-	     L++;
-	   }while((rnd_uni(&rnd_uni_init) < CR) && (L < D));
-	 }
-/*-------DE/best/2/exp is another powerful strategy worth trying--------------------------*/
-	 else if (strategy == 4)
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-	   L = 0;
-	   do
-	   {                           
-	     tmp[n] = bestit[n] + 
-		      ((*pold)[r1][n]+(*pold)[r2][n]-(*pold)[r3][n]-(*pold)[r4][n])*F;
-	     n = (n+1)%D;
-	     L++;
-	   }while((rnd_uni(&rnd_uni_init) < CR) && (L < D));
-	 }
-/*-------DE/rand/2/exp seems to be a robust optimizer for many functions-------------------*/
-	 else if (strategy == 5)
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-	   L = 0;
-	   do
-	   {                           
-	     tmp[n] = (*pold)[r5][n] + 
-		      ((*pold)[r1][n]+(*pold)[r2][n]-(*pold)[r3][n]-(*pold)[r4][n])*F;
-	     n = (n+1)%D;
-	     L++;
-	   }while((rnd_uni(&rnd_uni_init) < CR) && (L < D));
-	 }
-
-/*=======Essentially same strategies but BINOMIAL CROSSOVER===============================*/
-
-/*-------DE/best/1/bin--------------------------------------------------------------------*/
-	 else if (strategy == 6) 
-	 {
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-           for (L=0; L<D; L++) /* perform D binomial trials */
-           {
-	     if ((rnd_uni(&rnd_uni_init) < CR) || L == (D-1)) /* change at least one parameter */
-	     {                       
-	       tmp[n] = bestit[n] + F*((*pold)[r2][n]-(*pold)[r3][n]);
-	     }
-	     n = (n+1)%D;
-           }
-	 }
-/*-------DE/rand/1/bin-------------------------------------------------------------------*/
-	 else if (strategy == 7) 
-	 {
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-           for (L=0; L<D; L++) /* perform D binomial trials */
-           {
-	     if ((rnd_uni(&rnd_uni_init) < CR) || L == (D-1)) /* change at least one parameter */
-	     {                       
-	       tmp[n] = (*pold)[r1][n] + F*((*pold)[r2][n]-(*pold)[r3][n]);
-	     }
-	     n = (n+1)%D;
-           }
-	 }
-/*-------DE/rand-to-best/1/bin-----------------------------------------------------------*/
-	 else if (strategy == 8) 
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-           for (L=0; L<D; L++) /* perform D binomial trials */
-           {
-	     if ((rnd_uni(&rnd_uni_init) < CR) || L == (D-1)) /* change at least one parameter */
-	     {                       
-	       tmp[n] = tmp[n] + F*(bestit[n] - tmp[n]) + F*((*pold)[r1][n]-(*pold)[r2][n]);
-	     }
-	     n = (n+1)%D;
-           }
-	 }
-/*-------DE/best/2/bin--------------------------------------------------------------------*/
-	 else if (strategy == 9)
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-           for (L=0; L<D; L++) /* perform D binomial trials */
-           {
-	     if ((rnd_uni(&rnd_uni_init) < CR) || L == (D-1)) /* change at least one parameter */
-	     {                       
-	       tmp[n] = bestit[n] + 
-		      ((*pold)[r1][n]+(*pold)[r2][n]-(*pold)[r3][n]-(*pold)[r4][n])*F;
-	     }
-	     n = (n+1)%D;
-           }
-	 }
-/*-------DE/rand/2/bin--------------------------------------------------------------------*/
-	 else
-	 { 
-	   assignd(D,tmp,(*pold)[i]);
-	   n = (int)(rnd_uni(&rnd_uni_init)*D); 
-           for (L=0; L<D; L++) /* perform D binomial trials */
-           {
-	     if ((rnd_uni(&rnd_uni_init) < CR) || L == (D-1)) /* change at least one parameter */
-	     {                       
-	       tmp[n] = (*pold)[r5][n] + 
-		      ((*pold)[r1][n]+(*pold)[r2][n]-(*pold)[r3][n]-(*pold)[r4][n])*F;
-	     }
-	     n = (n+1)%D;
-           }
-	 }
-
-
-/*=======Trial mutation now in tmp[]. Test how good this choice really was.==================*/
-
-	 trial_cost = evaluate(D,tmp,&nfeval);  /* Evaluate new vector in tmp[] */
-
-	 if (trial_cost <= cost[i])   /* improved objective function value ? */
-	 {                                  
-	    cost[i]=trial_cost;         
-	    assignd(D,(*pnew)[i],tmp);
-	    if (trial_cost<cmin)          /* Was this a new minimum? */
-	    {                               /* if so...*/
-	       cmin=trial_cost;           /* reset cmin to new low...*/
-	       imin=i;
-	       assignd(D,best,tmp);           
-	    }                           
-	 }                            
-	 else
-	 {
-	    assignd(D,(*pnew)[i],(*pold)[i]); /* replace target with old value */
-	 }
-      }   /* End mutation loop through pop. */
-					   
-      assignd(D,bestit,best);  /* Save best population member of current iteration */
-
-      /* swap population arrays. New generation becomes old one */
-
-      pswap = pold;
-      pold  = pnew;
-      pnew  = pswap;
-
-/*----Compute the energy variance (just for monitoring purposes)-----------*/
-
-      cmean = 0.;          /* compute the mean value first */
-      for (j=0; j<NP; j++)
-      {
-         cmean += cost[j];
-      }
-      cmean = cmean/NP;
-
-      cvar = 0.;           /* now the variance              */
-      for (j=0; j<NP; j++)
-      {
-         cvar += (cost[j] - cmean)*(cost[j] - cmean);
-      }
-      cvar = cvar/(NP-1);
-
-
-/*----Output part----------------------------------------------------------*/
-
-      if (gen%refresh==1)   /* display after every refresh generations */
-      { /* ABORT works only if conio.h is accepted by your compiler */
-	printf("\n\n                         PRESS ANY KEY TO ABORT"); 
-	printf("\n\n\n Best-so-far cost funct. value=%-15.10g\n",cmin);
-
-	for (j=0;j<D;j++)
-	{
-	  printf("\n best[%d]=%-15.10g",j,best[j]);
-	}
-	printf("\n\n Generation=%d  NFEs=%ld   Strategy: %s    ",gen,nfeval,strat[strategy]);
-	printf("\n NP=%d    F=%-4.2g    CR=%-4.2g   cost-variance=%-10.5g\n",
-               NP,F,CR,cvar);
-      }
+   best = (double *)malloc(a.cfg.D*sizeof(double));
+   if (best == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
 
-      fprintf(fpout_ptr,"%ld   %-15.10g\n",nfeval,cmin);
+   out.fpout_ptr    = fpout_ptr;
+   out.refresh      = a.refresh;
+   out.strategy     = a.cfg.strategy;
+   out.F            = a.cfg.F;
+   out.CR           = a.cfg.CR;
+   out.quiet        = a.quiet;
+   out.lines        = (a.cfg.trace == NULL);
+   if (!out.quiet || out.lines) a.cfg.monitor = monitor;
+   a.cfg.stop       = &stop_flag;
+   signal(SIGINT,on_signal);
+   signal(SIGTERM,on_signal);
+   a.cfg.monitor_user = &out;
+   res.best         = best;
+
+   res.gen          = -1;   /* stays so if de_solve() did not run */
+   a.cc.cycles      = a.cfg.genmax;
+
+   switch ((a.cc.size > 0) ? de_coev(&a.cc,&a.cfg,a.fn,a.fn_user,&res) :
+                             de_solve(&a.cfg,a.fn,a.fn_user,&res))
+   {
+      case DE_OK:  break;
+      case DE_EIO: if (res.gen < 0)
+                   {
+                      if (a.cfg.resume) printf("\nCannot read checkpoint %s\n",a.cfg.checkpoint);
+                      else printf("\nCannot open trace file %s\n",a.cfg.trace);
+                      exit(1);
+                   }
+                   printf("\nWarning! could not write checkpoint or trace file\n");
+                   break;
+      case DE_EINVAL:
+                   if (a.cfg.resume)  /* de_check() passed above */
+                   {
+                      printf("\nCheckpoint %s was written with other settings\n",a.cfg.checkpoint);
+                      exit(1);
+                   }
+                   /* fall through */
+      default:     printf("\nde_solve() failed\n");
+                   exit(1);
    }
-/*=======================================================================*/
-/*=========End of iteration loop=========================================*/
-/*=======================================================================*/
 
 /*-------Final output in file-------------------------------------------*/
 
 
-   fprintf(fpout_ptr,"\n\n\n Best-so-far obj. funct. value = %-15.10g\n",cmin);
+   fprintf(fpout_ptr,"\n\n\n Best-so-far obj. funct. value = %-15.10g\n",res.cmin);
 
-   for (j=0;j<D;j++)
+   for (j=0;j<a.cfg.D;j++)
    {
      fprintf(fpout_ptr,"\n best[%d]=%-15.10g",j,best[j]);
    }
-   fprintf(fpout_ptr,"\n\n Generation=%d  NFEs=%ld   Strategy: %s    ",gen,nfeval,strat[strategy]);
+   fprintf(fpout_ptr,"\n\n Generation=%d  NFEs=%ld",res.gen,res.nfeval);
+   if (a.cfg.cache > 0) fprintf(fpout_ptr,"  cache-hits=%ld  cache-misses=%ld",res.nhit,res.nmiss);
+   fprintf(fpout_ptr,"   Strategy: %s    ",de_strat[a.cfg.strategy]);
    fprintf(fpout_ptr,"\n NP=%d    F=%-4.2g    CR=%-4.2g    cost-variance=%-10.5g\n",
-           NP,F,CR,cvar); 
+           a.cfg.NP,a.cfg.F,a.cfg.CR,res.cvar);
+   fprintf(fpout_ptr," Stop: %s\n",de_stop_name[res.stop]);
+   if (a.cfg.adapt != DE_ADAPT_NONE || a.cfg.np_min != 0)
+   {
+      fprintf(fpout_ptr," Adapt: %s  np-min=%d\n",de_adapt_name[a.cfg.adapt],a.cfg.np_min);
+   }
+   if (a.cfg.bound != DE_BOUND_NONE || a.cfg.feasible != NULL)
+   {
+      fprintf(fpout_ptr," Bound: %s  rejected=%ld\n",de_bound_name[a.cfg.bound],res.nrejected);
+   }
+   if (a.cfg.surr_k > 0)
+   {
+      fprintf(fpout_ptr," Surrogate: k=%d  keep=%g  screened=%ld  saved=%.3g\n",
+              a.cfg.surr_k,a.cfg.surr_keep,res.nscreened,
+              (double)res.nscreened/(res.nfeval + res.nscreened));
+   }
+   if (a.cfg.local != DE_LOCAL_NONE)
+   {
+      fprintf(fpout_ptr," Local: %s  every=%d  stall=%d  evaluations=%ld\n",
+              de_local_name[a.cfg.local],a.cfg.local_every,a.cfg.local_stall,
+              res.nlocal);
+   }
+   fprintf(fpout_ptr," Mode: %s  threads=%d  wall=%.5gs  evals/s=%.5g  utilization=%.3g\n",
+           de_mode_name[a.cfg.mode],a.cfg.threads,res.wall,res.evals_per_sec,
+           res.utilization);
+   if (a.cc.size > 0)
+   {
+      fprintf(fpout_ptr," Coev: grouping=%s  size=%d  gens=%d  parallel=%d  cycles=%d\n",
+              de_group_name[a.cc.grouping],a.cc.size,a.cc.gens,a.cc.parallel,res.gen);
+   }
+   if (a.function != NULL) fprintf(fpout_ptr," Function: %s\n",a.function);
+   if (a.ext != NULL)
+   {
+      de_ext_counts(a.ext,&restarts,&timeouts,&failed);
+      fprintf(fpout_ptr," Evaluators: %d  restarts=%ld timeouts=%ld failed=%ld\n",
+              a.eval_workers,restarts,timeouts,failed);
+   }
+#ifdef DE_PROFILE
+   de_profile_print(fpout_ptr,&res.prof);
+#endif
 
    fclose(fpout_ptr);
+   free(best);
+   free((double *)a.cfg.lo);
+   free((double *)a.cfg.quant);
+   if (a.ext != NULL) de_ext_free(a.ext);
+   else de_problem_free((de_problem *)a.fn_user);
 
    return(0);
 }
 
 /*-----------End of main()------------------------------------------*/
-
-
-
-
-
@@ -0,0 +1,181 @@
+# include "de.h"
+# include "deint.h"
+
+/*------------------------Self-adaptive control variables---------------*/
+/*------With cfg->adapt every trial gets its own F and CR, drawn before-*/
+/*------it is built, and the values of successful trials are learnt:---*/
+/*------DE_ADAPT_JDE    each member keeps F and CR; a trial replaces----*/
+/*------                F by 0.1+0.9*rand and CR by rand with pro-------*/
+/*------                bability 0.1 each and hands them on to the------*/
+/*------                member if it is selected (Brest et al. 2006).---*/
+/*------DE_ADAPT_SHADE  F and CR are drawn around a random entry of a---*/
+/*------                memory, Cauchy and normal with scale 0.1. After-*/
+/*------                every generation one entry is set to the means--*/
+/*------                of the successful values, weighted by the-------*/
+/*------                improvement (Tanabe, Fukunaga 2013).------------*/
+/*------Either works with every strategy 1..10; cfg->F and cfg->CR are-*/
+/*------the starting values.-------------------------------------------*/
+/*                                                                      */
+/*------cfg->np_min shrinks the population linearly from cfg->NP at the-*/
+/*------start to np_min at the end of the evaluation budget, dropping---*/
+/*------the worst members (L-SHADE, Tanabe and Fukunaga 2014).---------*/
+
+#define JDE_TAU   0.1     /* probability to change F or CR      */
+#define JDE_FL    0.1     /* smallest F                         */
+#define JDE_FU    0.9     /* range of F                         */
+#define SHADE_S   0.1     /* scale of the F and CR distributions */
+
+
+void de_adapt_init(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Sets all member values and memory entries to cfg->F, cfg->CR.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   int i;
+
+   if (cfg->adapt == DE_ADAPT_NONE) return;
+   for (i=0; i<cfg->NP; i++)
+   {
+      x->mF[i]  = cfg->F;
+      x->mCR[i] = cfg->CR;
+   }
+   for (i=0; i<DE_ADAPT_H; i++)
+   {
+      x->hF[i]  = cfg->F;
+      x->hCR[i] = cfg->CR;
+   }
+   x->hk = 0;
+   x->ns = 0;
+}
+
+
+void de_adapt_sample(de_ctx *x, int i, de_rng *rnd)
+/**C*F****************************************************************
+**                                                                  **
+** Draws F and CR for the trial of member i into tF[i], tCR[i].     **
+** A fixed count of numbers is drawn for jDE; SHADE redraws F       **
+** until it is positive.                                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double u[4], F, CR;
+   int r;
+
+   if (x->cfg->adapt == DE_ADAPT_JDE)
+   {
+      de_rng_fill(rnd,u,4);
+      x->tF[i]  = (u[0] < JDE_TAU) ? JDE_FL + JDE_FU*u[1] : x->mF[i];
+      x->tCR[i] = (u[2] < JDE_TAU) ? u[3] : x->mCR[i];
+      return;
+   }
+
+   de_rng_fill(rnd,u,3);
+   r  = (int)(u[0]*DE_ADAPT_H);
+   CR = x->hCR[r] + SHADE_S*sqrt(-2.0*log(1.0-u[1]))*cos(2.0*M_PI*u[2]);
+   CR = (CR < 0.0) ? 0.0 : (CR > 1.0) ? 1.0 : CR;
+   do                        /* Cauchy, redrawn while F <= 0    */
+   {
+      F = x->hF[r] + SHADE_S*tan(M_PI*(de_rng_uni(rnd)-0.5));
+   }while(F <= 0.0);
+   x->tF[i]  = (F > 1.0) ? 1.0 : F;
+   x->tCR[i] = CR;
+}
+
+
+void de_adapt_success(de_ctx *x, int i, double trial_cost, double old_cost)
+/**C*F****************************************************************
+**                                                                  **
+** Called when the trial of member i is selected, before cost[i] is **
+** replaced: keeps its F and CR (jDE) or records them (SHADE).      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (x->cfg->adapt == DE_ADAPT_JDE)
+   {
+      x->mF[i]  = x->tF[i];
+      x->mCR[i] = x->tCR[i];
+   }
+   else if (x->cfg->adapt == DE_ADAPT_SHADE && trial_cost < old_cost &&
+            x->ns < x->cfg->NP)
+   {
+      x->sF[x->ns]  = x->tF[i];
+      x->sCR[x->ns] = x->tCR[i];
+      x->sW[x->ns]  = old_cost - trial_cost;
+      x->ns++;
+   }
+}
+
+
+void de_adapt_update(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** End of a generation: replaces the next SHADE memory entry by the **
+** weighted mean CR and weighted Lehmer mean F of the successes.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double w = 0, wf = 0, wff = 0, wcr = 0;
+   int k;
+
+   if (x->cfg->adapt != DE_ADAPT_SHADE || x->ns == 0) return;
+   for (k=0; k<x->ns; k++)
+   {
+      w   += x->sW[k];
+      wf  += x->sW[k]*x->sF[k];
+      wff += x->sW[k]*x->sF[k]*x->sF[k];
+      wcr += x->sW[k]*x->sCR[k];
+   }
+   if (w > 0 && wf > 0)
+   {
+      x->hF[x->hk]  = wff/wf;
+      x->hCR[x->hk] = wcr/w;
+      x->hk = (x->hk+1)%DE_ADAPT_H;
+   }
+   x->ns = 0;
+}
+
+
+void de_lpsr(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Linear population size reduction: removes the worst members      **
+** until NP matches the share of the budget used so far. The        **
+** budget is cfg->max_nfeval, or genmax*NP if that is not set.      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   double budget, f;
+   int n, i, w, last, k;
+
+   if (cfg->np_min == 0) return;
+   budget = (cfg->max_nfeval > 0) ? (double)cfg->max_nfeval :
+                                    (double)cfg->genmax*cfg->NP;
+   f = x->nfeval/budget;
+   if (f > 1.0) f = 1.0;
+   n = (int)floor(cfg->NP + (cfg->np_min - cfg->NP)*f + 0.5);
+   if (n < cfg->np_min) n = cfg->np_min;
+
+   while (x->NP > n)
+   {
+      w = 0;
+      for (i=1; i<x->NP; i++)
+      {
+         if (x->cost[i] > x->cost[w]) w = i;
+      }
+      last = x->NP - 1;         /* the last member takes its place */
+      k = x->slot[w];           /* by swapping rows, with its state */
+      x->slot[w]    = x->slot[last];
+      x->slot[last] = k;
+      x->cost[w] = x->cost[last];
+      if (cfg->adapt != DE_ADAPT_NONE)
+      {
+         x->mF[w]  = x->mF[last];
+         x->mCR[w] = x->mCR[last];
+      }
+      x->NP--;
+   }
+}
@@ -0,0 +1,171 @@
+# include "de.h"
+# include "deint.h"
+# include <pthread.h>
+
+/*------------------------Asynchronous steady-state DE------------------*/
+/*------Workers keep taking the next target member, build a trial from--*/
+/*------the current population, evaluate it and apply the selection as--*/
+/*------soon as the evaluation returns. There is no generation barrier,-*/
+/*------so a slow evaluation only holds up its own worker. Building and-*/
+/*------selection are done under one lock, and so are the lookups in----*/
+/*------the evaluation cache and its updates; only the objective runs---*/
+/*------unlocked. A "generation" is NP completed trials, cache hits-----*/
+/*------included. Results depend on the timing of the evaluations and---*/
+/*------are therefore not reproducible as in the synchronous mode.------*/
+
+typedef struct async_state
+{
+   de_ctx *x;
+   pthread_mutex_t lock;  /* protects population, costs, best   */
+   long  issued;          /* trials handed out so far           */
+   long  done;            /* trials evaluated and selected      */
+   long  budget;          /* genmax*NP trials                   */
+   int   next;            /* next target member to try          */
+   char  *busy;           /* busy[i]: a trial of i is in flight */
+} async_state;
+
+
+static void worker(void *arg, int w)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: one asynchronous worker, runs until the budget of     **
+** trials has been handed out, cut short by de_done() or *cfg->stop.**
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   async_state *a = (async_state *)arg;
+   de_ctx *x = a->x;
+   const de_config *cfg = x->cfg;
+   int    D  = cfg->D;
+   int    NP = cfg->NP;
+   int    i, hit;
+   long   k;
+   double trial_cost, t;
+   de_real *tmp;
+   de_rng rnd;
+   DE_PROF_T(pt);         /* ticks of the phases on this thread */
+
+   for (;;)
+   {
+      pthread_mutex_lock(&a->lock);
+      if (a->issued >= a->budget || (cfg->stop != NULL && *cfg->stop))
+      {
+         pthread_mutex_unlock(&a->lock);
+         break;
+      }
+      k = a->issued++;
+      do                         /* next member without a trial */
+      {
+         i = a->next;
+         a->next = (a->next+1)%NP;
+      }while(a->busy[i]);
+      a->busy[i] = 1;
+      if (cfg->rng == DE_RNG_RAN2)
+      {
+         de_build_trial(x,i,&x->rnd);
+      }
+      else
+      {
+         de_rng_init(&rnd,DE_RNG_XOSHIRO,cfg->seed,k+1);
+         de_build_trial(x,i,&rnd);
+      }
+      tmp = TRIAL(i);            /* the trial row is private to us */
+      hit = (x->cache != NULL && de_cache_find(x->cache,tmp,&trial_cost));
+      pthread_mutex_unlock(&a->lock);
+
+      DE_PROF_START(pt);
+      t = de_time();
+      if (!hit)                  /* else the cost is in trial_cost */
+      {
+         if (cfg->feasible != NULL && !cfg->feasible(D,WIDE(tmp),cfg->feasible_user))
+         {
+            trial_cost = NAN;       /* rejected, never selected    */
+         }
+         else if (cfg->batch != NULL) cfg->batch(D,1,WIDE(tmp),x->stride,&trial_cost,x->user);
+         else trial_cost = x->fn(D,WIDE(tmp),x->user);
+         de_busy(x,t);
+      }
+      DE_PROF_ADD(DE_PH_EVAL,pt);
+
+      pthread_mutex_lock(&a->lock);
+      DE_PROF_START(pt);
+      if (hit) x->nhit++;
+      else if (isnan(trial_cost)) x->nreject++;
+      else
+      {
+         x->nfeval++;
+         if (x->cache != NULL)
+         {
+            x->nmiss++;
+            de_cache_put(x->cache,tmp,trial_cost);
+         }
+      }
+      if (trial_cost <= x->cost[i])   /* improved objective function value ? */
+      {
+         if (cfg->adapt != DE_ADAPT_NONE) de_adapt_success(x,i,trial_cost,x->cost[i]);
+         x->cost[i] = trial_cost;
+         de_accept(x,i);            /* tmp is a member row from now */
+         if (trial_cost < x->cmin)    /* Was this a new minimum? */
+         {
+            x->cmin = trial_cost;
+            x->imin = i;
+            de_widen(D,x->best,tmp);
+            assignr(D,x->bestit,tmp); /* used by the next trials at once */
+         }
+      }
+      a->busy[i] = 0;
+      DE_PROF_ADD(DE_PH_SELECT,pt);
+      if (++a->done % NP == 0)
+      {
+         x->gen++;
+         de_adapt_update(x);
+         if (cfg->migrate != NULL && x->gen%cfg->migrate_every == 0)
+         {
+            de_migrate_step(x);
+         }
+         DE_PROF_ADD(DE_PH_OTHER,pt);
+         de_stats(x);
+         DE_PROF_ADD(DE_PH_STATS,pt);
+         de_report(x);
+         de_ckpt_save(x);
+         if (x->stop < 0 && de_done(x)) a->budget = a->issued; /* no more trials */
+         DE_PROF_ADD(DE_PH_OTHER,pt);
+         DE_PROF_GEN();
+      }
+      pthread_mutex_unlock(&a->lock);
+   }
+}
+
+
+int de_run_async(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Asynchronous steady-state iteration loop, used for DE_MODE_ASYNC **
+** in place of the synchronous one. At most NP workers are started, **
+** so that every worker always finds a target without a trial.      **
+** Returns DE_OK, or DE_ENOMEM.                                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   async_state a;
+   int nworker;
+
+   a.x      = x;
+   a.issued = (long)x->gen*x->cfg->NP;  /* > 0 after a resume */
+   a.done   = a.issued;
+   a.budget = (long)x->cfg->genmax*x->cfg->NP;
+   a.next   = 0;
+   a.busy   = (char *)calloc(x->cfg->NP,1);
+   if (a.busy == NULL) return DE_ENOMEM;
+   pthread_mutex_init(&a.lock,NULL);
+
+   if (de_done(x)) a.budget = a.issued;   /* stopped before the start */
+   nworker = de_pool_size(x->pool);
+   if (nworker > x->cfg->NP) nworker = x->cfg->NP;
+   de_pool_run(x->pool,nworker,worker,&a);
+
+   if (x->stop < 0 && !de_done(x)) x->stop = DE_STOP_USER;  /* left on *stop */
+   pthread_mutex_destroy(&a.lock);
+   free(a.busy);
+   return DE_OK;
+}
@@ -0,0 +1,291 @@
+# include "de.h"
+# include "deint.h"
+
+/*------------------------Quantization and evaluation cache-------------*/
+/*------cfg->quant gives every parameter a grid step; trials and the----*/
+/*------initial members are rounded to the nearest multiple of it, and--*/
+/*------with cfg->bound set kept within the bounds, before they are-----*/
+/*------evaluated. A step of 0 leaves the parameter continuous. On such-*/
+/*------grids many trials land on points that were evaluated before.---*/
+/*------With cfg->cache > 0 the cost of every evaluated trial is kept---*/
+/*------in a hash table keyed on its row, and a trial found there gets--*/
+/*------the stored cost instead of an evaluation; it is counted in------*/
+/*------x->nhit, not in nfeval. The table is bounded: CACHE_WAYS--------*/
+/*------entries per set, the oldest of a full set is replaced.---------*/
+/*                                                                      */
+/*------The table has no lock of its own. In the synchronous mode the---*/
+/*------threads only look up during the evaluation pass, and the-------*/
+/*------evaluated trials are entered afterwards in member order by------*/
+/*------de_cache_add(), so hits do not depend on the threads; the------*/
+/*------asynchronous loop looks up and enters under its lock.-----------*/
+/*                                                                      */
+/*------The whole table goes into the checkpoint, so a resumed run------*/
+/*------gets the same hits as an uninterrupted one.--------------------*/
+
+#define CACHE_WAYS  4     /* entries per set                    */
+
+struct de_cache
+{
+   int    D;
+   size_t mask;           /* sets - 1, sets are a power of 2    */
+   uint64_t *tag;         /* hash of every entry, 0 if empty    */
+   double *cost;          /* cost of every entry                */
+   de_real *key;          /* row of every entry, D each         */
+   unsigned char *next;   /* way of a set to replace next       */
+};
+
+
+void de_quantize(de_ctx *x, de_real *r, int lo, int len)
+/**C*F****************************************************************
+**                                                                  **
+** Rounds the parameters r[(lo+k)%D], k < len, to their grids. A    **
+** point rounded out of the bounds is moved one step back in if     **
+** cfg->bound is set. Adding 0.0 turns -0 into 0, so that equal     **
+** points have equal rows.                                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const double *q = x->cfg->quant;
+   int    D = x->cfg->D, k, j;
+   double v;
+
+   if (q == NULL) return;
+   for (k=0, j=lo; k<len; k++, j=(j+1 == D) ? 0 : j+1)
+   {
+      if (!(q[j] > 0)) continue;
+      v = q[j]*floor(r[j]/q[j] + 0.5) + 0.0;
+      if (x->cfg->bound != DE_BOUND_NONE)
+      {
+         if (v > x->hi[j]) v -= q[j];
+         if (v < x->lo[j]) v += q[j];
+      }
+      r[j] = (de_real)v;
+   }
+}
+
+
+static uint64_t hash_row(int D, const de_real *r)
+/**C*F****************************************************************
+**                                                                  **
+** 64 bit hash of the bits of row r, never 0.                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t h = 0x9e3779b97f4a7c15u ^ (uint64_t)D, w;
+   int j;
+
+   for (j=0; j<D; j++)
+   {
+      w = 0;
+      memcpy(&w,r+j,sizeof(de_real));
+      h = (h ^ w)*0xff51afd7ed558ccdu;
+      h ^= h >> 32;
+   }
+   h ^= h >> 29;               /* finish as splitmix64 */
+   h *= 0xc4ceb9fe1a85ec53u;
+   h ^= h >> 32;
+   return (h != 0) ? h : 1;
+}
+
+
+static size_t cache_sets(long n)
+/**C*F****************************************************************
+**                                                                  **
+** Sets of a cache of at least n entries, a power of 2.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t sets = 1;
+
+   while (sets*CACHE_WAYS < (size_t)n) sets *= 2;
+   return sets;
+}
+
+
+de_cache *de_cache_create(int D, long n)
+/**C*F****************************************************************
+**                                                                  **
+** Allocates an empty cache of at least n entries for rows of D     **
+** parameters. Returns NULL if that does not fit in memory.         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t sets = cache_sets(n), m;
+   de_cache *c;
+
+   m = sets*CACHE_WAYS;
+   if (m > ((size_t)-1)/4/(sizeof(uint64_t) + sizeof(double) + (size_t)D*sizeof(de_real)))
+   {
+      return NULL;
+   }
+   c = (de_cache *)calloc(1,sizeof(de_cache));
+   if (c == NULL) return NULL;
+   c->D    = D;
+   c->mask = sets - 1;
+   c->tag  = (uint64_t *)calloc(m,sizeof(uint64_t));
+   c->cost = (double *)malloc(m*sizeof(double));
+   c->key  = (de_real *)malloc(m*D*sizeof(de_real));
+   c->next = (unsigned char *)calloc(sets,1);
+   if (c->tag == NULL || c->cost == NULL || c->key == NULL || c->next == NULL)
+   {
+      de_cache_free(c);
+      return NULL;
+   }
+   return c;
+}
+
+
+int de_cache_find(const de_cache *c, const de_real *r, double *cost)
+/**C*F****************************************************************
+**                                                                  **
+** Looks row r up. Returns 1 and sets *cost if it is there, else 0. **
+** Only reads the table, so lookups may run concurrently as long as **
+** nothing is entered.                                              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t h = hash_row(c->D,r);
+   size_t   e = (h & c->mask)*CACHE_WAYS, k;
+
+   for (k=e; k<e+CACHE_WAYS; k++)
+   {
+      if (c->tag[k] == h && memcmp(c->key+k*c->D,r,c->D*sizeof(de_real)) == 0)
+      {
+         *cost = c->cost[k];
+         return 1;
+      }
+   }
+   return 0;
+}
+
+
+void de_cache_put(de_cache *c, const de_real *r, double cost)
+/**C*F****************************************************************
+**                                                                  **
+** Enters row r with its cost, into a free entry of its set or in   **
+** place of the oldest one. A row that is there already only gets   **
+** the new cost.                                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t h = hash_row(c->D,r);
+   size_t   s = h & c->mask, e = s*CACHE_WAYS, k;
+
+   for (k=e; k<e+CACHE_WAYS; k++)
+   {
+      if (c->tag[k] == 0) break;
+      if (c->tag[k] == h && memcmp(c->key+k*c->D,r,c->D*sizeof(de_real)) == 0) break;
+   }
+   if (k == e+CACHE_WAYS)       /* set full: replace the oldest */
+   {
+      k = e + c->next[s];
+      c->next[s] = (c->next[s]+1)%CACHE_WAYS;
+   }
+   c->tag[k]  = h;
+   c->cost[k] = cost;
+   memcpy(c->key+k*c->D,r,c->D*sizeof(de_real));
+}
+
+
+void de_cache_add(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Enters the trials evaluated in the last pass, marked by screen() **
+** in x->cmiss, in member order and counts them as misses. Trials   **
+** with cost NaN are not entered.                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i;
+   DE_PROF_T(pt);
+
+   if (x->cache == NULL) return;
+   for (i=0; i<x->NP; i++)
+   {
+      if (!x->cmiss[i]) continue;
+      x->nmiss++;
+      if (!isnan(x->tcost[i])) de_cache_put(x->cache,TRIAL(i),x->tcost[i]);
+   }
+   DE_PROF_ADD(DE_PH_EVAL,pt);
+}
+
+
+size_t de_cache_bytes(int D, long n)
+/**C*F****************************************************************
+**                                                                  **
+** Bytes that de_cache_save() stores for a cache of n entries, 0    **
+** for n <= 0: tag, cost and row (as doubles) of every entry and    **
+** the replacement way of every set.                                **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t sets = cache_sets(n);
+
+   if (n <= 0) return 0;
+   return sets*CACHE_WAYS*(sizeof(uint64_t) + (D+1)*sizeof(double)) + sets;
+}
+
+
+char *de_cache_save(const de_cache *c, char *p)
+/**C*F****************************************************************
+**                                                                  **
+** Stores the table at p for the checkpoint and returns its end.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t m = (c->mask+1)*CACHE_WAYS, k;
+   double v;
+
+   memcpy(p,c->tag,m*sizeof(uint64_t));
+   p += m*sizeof(uint64_t);
+   memcpy(p,c->cost,m*sizeof(double));
+   p += m*sizeof(double);
+   for (k=0; k<m*c->D; k++, p+=sizeof(double))
+   {
+      v = c->key[k];
+      memcpy(p,&v,sizeof(double));
+   }
+   memcpy(p,c->next,c->mask+1);
+   return p + c->mask+1;
+}
+
+
+const char *de_cache_load(de_cache *c, const char *p)
+/**C*F****************************************************************
+**                                                                  **
+** Restores the table stored by de_cache_save() at p and returns    **
+** its end.                                                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t m = (c->mask+1)*CACHE_WAYS, k;
+   double v;
+
+   memcpy(c->tag,p,m*sizeof(uint64_t));
+   p += m*sizeof(uint64_t);
+   memcpy(c->cost,p,m*sizeof(double));
+   p += m*sizeof(double);
+   for (k=0; k<m*c->D; k++, p+=sizeof(double))
+   {
+      memcpy(&v,p,sizeof(double));
+      c->key[k] = (de_real)v;
+   }
+   memcpy(c->next,p,c->mask+1);
+   return p + c->mask+1;
+}
+
+
+void de_cache_free(de_cache *c)
+/**C*F****************************************************************
+**                                                                  **
+** Frees the cache; c may be NULL.                                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (c == NULL) return;
+   free(c->tag);
+   free(c->cost);
+   free(c->key);
+   free(c->next);
+   free(c);
+}
@@ -0,0 +1,539 @@
+# include "de.h"
+# include "deint.h"
+# include <pthread.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+
+/*------------------------Checkpoint/restart----------------------------*/
+/*------Every cfg->checkpoint_every generations the full solver state---*/
+/*------(population, costs, best members, counters and the state of----*/
+/*------the random number generator) is copied into a snapshot buffer.--*/
+/*------A writer thread then stores it in <checkpoint>.tmp through a----*/
+/*------shared mapping and renames it to <checkpoint>, so the file is---*/
+/*------always either the old or the new complete snapshot. The--------*/
+/*------generation loop only pays for the copy; if the writer is still--*/
+/*------busy with the previous snapshot, the checkpoint is skipped.-----*/
+/*------The state at the end of the run is always saved.---------------*/
+/*                                                                      */
+/*------cfg->resume loads the snapshot instead of a random population;-*/
+/*------a synchronous run then continues bit for bit as if it had never-*/
+/*------been stopped.---------------------------------------------------*/
+/*                                                                      */
+/*------File layout, native byte order:---------------------------------*/
+/*------  ckpt_head, de_rng, pop[NP][D], cost[NP], best[D], bestit[D],--*/
+/*------  hF[H], hCR[H], mF[NP], mCR[NP] if cfg->adapt is set, and the--*/
+/*------  surrogate archive ax[acap][D], acost[acap] if cfg->surr_k is--*/
+/*------  set, and the evaluation cache if cfg->cache is set. All-------*/
+/*------  vectors are doubles, also with DE_FLOAT.----------------------*/
+/*------NP is cfg->NP; only the first np rows are in use after a--------*/
+/*------population size reduction.-------------------------------------*/
+
+#define CKPT_MAGIC   "DECKPT1"
+#define CKPT_VERSION 9
+
+typedef struct ckpt_head
+{
+   char   magic[8];
+   int    version;
+   int    rng_size;       /* sizeof(de_rng) of the writer       */
+   int    D, NP, strategy, rng, mode, seed;
+   int    adapt, np_min, bound;
+   int    surr_k, acap;   /* surrogate and its archive size     */
+   int    an, apos;       /* points in the archive, next slot   */
+   int    local, local_every, local_stall;
+   long   local_budget;
+   long   cache;          /* entries of the evaluation cache    */
+   uint64_t quant;        /* checksum of cfg->quant, 0 if none  */
+   double F, CR, surr_keep;
+   int    gen;
+   int    last_imp;       /* generation of the last improvement */
+   int    lpol;           /* generation of the last polishing   */
+   int    imin;
+   int    np;             /* current population size            */
+   int    hk;             /* next SHADE memory entry            */
+   long   nfeval;
+   long   nreject;
+   long   nscreen;
+   long   nlocal;
+   long   nhit, nmiss;    /* evaluation cache counters          */
+   double cmin, cmean, cvar;
+   double last_cmin;      /* cmin at last_imp                   */
+   size_t size;           /* bytes of the whole file            */
+   uint64_t sum;          /* checksum of everything after head  */
+} ckpt_head;
+
+struct de_ckpt
+{
+   pthread_t tid;
+   pthread_mutex_t lock;
+   pthread_cond_t  cond;
+   char  *buf;            /* snapshot handed to the writer      */
+   size_t size;
+   int    full;           /* buf holds a snapshot not yet saved */
+   int    stop;           /* writer shall exit                  */
+   int    failed;         /* a write went wrong                 */
+   int    saved;          /* generation of the last snapshot    */
+   char  *path, *tmp;
+};
+
+
+static char *put_row(char *p, const de_real *r, int D)
+/**C*F****************************************************************
+**                                                                  **
+** Stores population row r at p as D doubles, also with DE_FLOAT,   **
+** and returns the end of the stored row.                           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double v;
+   int j;
+
+   if (sizeof(de_real) == sizeof(double))
+   {
+      memcpy(p,r,D*sizeof(double));
+      return p + D*sizeof(double);
+   }
+   for (j=0; j<D; j++, p+=sizeof(double))
+   {
+      v = r[j];
+      memcpy(p,&v,sizeof(double));
+   }
+   return p;
+}
+
+
+static const char *get_row(const char *p, de_real *r, int D)
+/**C*F****************************************************************
+**                                                                  **
+** Restores population row r from the D doubles at p and returns    **
+** their end.                                                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double v;
+   int j;
+
+   if (sizeof(de_real) == sizeof(double))
+   {
+      memcpy(r,p,D*sizeof(double));
+      return p + D*sizeof(double);
+   }
+   for (j=0; j<D; j++, p+=sizeof(double))
+   {
+      memcpy(&v,p,sizeof(double));
+      r[j] = (de_real)v;
+   }
+   return p;
+}
+
+
+static size_t ckpt_size(const de_config *cfg)
+/**C*F****************************************************************
+**                                                                  **
+** Bytes of a snapshot for the problem size and settings of cfg.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t D = cfg->D, NP = cfg->NP;
+   size_t nad = (cfg->adapt != DE_ADAPT_NONE) ? NP : 0;
+   size_t na  = (cfg->surr_k == 0) ? 0 :
+                (cfg->surr_archive > 0) ? (size_t)cfg->surr_archive :
+                                          DE_SURR_ARCHIVE*NP;
+
+   return sizeof(ckpt_head) + sizeof(de_rng) +
+          (NP*D + NP + 2*D + 2*DE_ADAPT_H + 2*nad + na*(D+1))*sizeof(double) +
+          de_cache_bytes(cfg->D,cfg->cache);
+}
+
+
+static uint64_t ckpt_sum(const char *p, size_t n)
+/**C*F****************************************************************
+**                                                                  **
+** Checksum of n bytes: 64-bit words rotated and xor-ed, the tail   **
+** byte by byte. Catches torn and truncated files, not attacks.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t s = 0x6a09e667f3bcc909ULL, w;
+   size_t i;
+
+   for (i=0; i+8<=n; i+=8)
+   {
+      memcpy(&w,p+i,8);
+      s = ((s << 7) | (s >> 57)) ^ w;
+   }
+   for (; i<n; i++) s = ((s << 7) | (s >> 57)) ^ (unsigned char)p[i];
+   return s;
+}
+
+
+static uint64_t ckpt_quant(const de_config *cfg)
+/**C*F****************************************************************
+**                                                                  **
+** Checksum of the grid steps cfg->quant, 0 without them.           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (cfg->quant == NULL) return 0;
+   return ckpt_sum((const char *)cfg->quant,cfg->D*sizeof(double));
+}
+
+
+static int ckpt_write(de_ckpt *c)
+/**C*F****************************************************************
+**                                                                  **
+** Stores buf in c->tmp through a shared mapping, flushes it to     **
+** disk and renames it to c->path. Returns 0 on success.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   ckpt_head *h = (ckpt_head *)c->buf;
+   char *m;
+   int fd, ret = -1;
+
+   h->sum = ckpt_sum(c->buf+sizeof(ckpt_head),c->size-sizeof(ckpt_head));
+
+   fd = open(c->tmp,O_RDWR|O_CREAT|O_TRUNC,0644);
+   if (fd < 0) return -1;
+   if (ftruncate(fd,c->size) == 0)
+   {
+      m = (char *)mmap(NULL,c->size,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+      if (m != MAP_FAILED)
+      {
+         memcpy(m,c->buf,c->size);
+         if (msync(m,c->size,MS_SYNC) == 0) ret = 0;
+         munmap(m,c->size);
+      }
+   }
+   if (close(fd) != 0) ret = -1;
+   if (ret == 0 && rename(c->tmp,c->path) != 0) ret = -1;
+   return ret;
+}
+
+
+static void *ckpt_writer(void *arg)
+/**C*F****************************************************************
+**                                                                  **
+** Writer thread: saves every snapshot handed over by de_ckpt_save()**
+** until de_ckpt_close() asks it to stop.                           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ckpt *c = (de_ckpt *)arg;
+
+   pthread_mutex_lock(&c->lock);
+   for (;;)
+   {
+      while (!c->full && !c->stop) pthread_cond_wait(&c->cond,&c->lock);
+      if (!c->full) break;
+      pthread_mutex_unlock(&c->lock);
+      if (ckpt_write(c) != 0) c->failed = 1;
+      pthread_mutex_lock(&c->lock);
+      c->full = 0;
+      pthread_cond_broadcast(&c->cond);
+   }
+   pthread_mutex_unlock(&c->lock);
+   return NULL;
+}
+
+
+int de_ckpt_open(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Starts the writer thread if cfg->checkpoint is set. Returns      **
+** DE_OK or DE_ENOMEM.                                              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   de_ckpt *c;
+   size_t n;
+
+   x->ckpt = NULL;
+   if (cfg->checkpoint == NULL) return DE_OK;
+
+   n = strlen(cfg->checkpoint);
+   c = (de_ckpt *)calloc(1,sizeof(de_ckpt));
+   if (c == NULL) return DE_ENOMEM;
+   c->size = ckpt_size(cfg);
+   c->buf  = (char *)malloc(c->size);
+   c->path = (char *)malloc(n+1);
+   c->tmp  = (char *)malloc(n+5);
+   if (c->buf == NULL || c->path == NULL || c->tmp == NULL)
+   {
+      free(c->buf); free(c->path); free(c->tmp); free(c);
+      return DE_ENOMEM;
+   }
+   memcpy(c->path,cfg->checkpoint,n+1);
+   memcpy(c->tmp,cfg->checkpoint,n);
+   memcpy(c->tmp+n,".tmp",5);
+   pthread_mutex_init(&c->lock,NULL);
+   pthread_cond_init(&c->cond,NULL);
+   if (pthread_create(&c->tid,NULL,ckpt_writer,c) != 0)
+   {
+      pthread_mutex_destroy(&c->lock);
+      pthread_cond_destroy(&c->cond);
+      free(c->buf); free(c->path); free(c->tmp); free(c);
+      return DE_ENOMEM;
+   }
+   x->ckpt = c;
+   return DE_OK;
+}
+
+
+static void ckpt_copy(de_ctx *x, int wait)
+/**C*F****************************************************************
+**                                                                  **
+** Copies the state after generation x->gen into the snapshot       **
+** buffer and wakes the writer. If the writer is busy, waits for    **
+** it if wait is set and gives up otherwise.                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   de_ckpt *c = x->ckpt;
+   ckpt_head *h;
+   char  *p;
+   int   i, D = cfg->D, NP = cfg->NP;
+
+   pthread_mutex_lock(&c->lock);
+   while (c->full && wait) pthread_cond_wait(&c->cond,&c->lock);
+   if (c->full)
+   {
+      pthread_mutex_unlock(&c->lock);
+      return;
+   }
+   pthread_mutex_unlock(&c->lock);
+
+   h = (ckpt_head *)c->buf;     /* the writer is idle, buf is ours */
+   memset(h,0,sizeof(ckpt_head));
+   memcpy(h->magic,CKPT_MAGIC,8);
+   h->version  = CKPT_VERSION;
+   h->rng_size = sizeof(de_rng);
+   h->D        = D;
+   h->NP       = NP;
+   h->strategy = cfg->strategy;
+   h->rng      = cfg->rng;
+   h->mode     = cfg->mode;
+   h->seed     = cfg->seed;
+   h->adapt    = cfg->adapt;
+   h->np_min   = cfg->np_min;
+   h->bound    = cfg->bound;
+   h->surr_k   = cfg->surr_k;
+   h->surr_keep = cfg->surr_keep;
+   h->acap     = x->acap;
+   h->local    = cfg->local;
+   h->local_every = cfg->local_every;
+   h->local_stall = cfg->local_stall;
+   h->local_budget = cfg->local_budget;
+   h->cache    = cfg->cache;
+   h->quant    = ckpt_quant(cfg);
+   h->an       = x->an;
+   h->apos     = x->apos;
+   h->np       = x->NP;
+   h->hk       = x->hk;
+   h->F        = cfg->F;
+   h->CR       = cfg->CR;
+   h->gen      = x->gen;
+   h->last_imp = x->last_imp;
+   h->lpol     = x->lpol;
+   h->imin     = x->imin;
+   h->nfeval   = x->nfeval;
+   h->nreject  = x->nreject;
+   h->nscreen  = x->nscreen;
+   h->nlocal   = x->nlocal;
+   h->nhit     = x->nhit;
+   h->nmiss    = x->nmiss;
+   h->cmin     = x->cmin;
+   h->cmean    = x->cmean;
+   h->cvar     = x->cvar;
+   h->last_cmin = x->last_cmin;
+   h->size     = c->size;
+
+   p = c->buf + sizeof(ckpt_head);
+   memcpy(p,&x->rnd,sizeof(de_rng));
+   p += sizeof(de_rng);
+   for (i=0; i<NP; i++) p = put_row(p,MEM(i),D);
+   memcpy(p,x->cost,NP*sizeof(double));
+   p += NP*sizeof(double);
+   memcpy(p,x->best,D*sizeof(double));
+   p += D*sizeof(double);
+   p = put_row(p,x->bestit,D);
+   memcpy(p,x->hF,DE_ADAPT_H*sizeof(double));
+   p += DE_ADAPT_H*sizeof(double);
+   memcpy(p,x->hCR,DE_ADAPT_H*sizeof(double));
+   p += DE_ADAPT_H*sizeof(double);
+   if (cfg->adapt != DE_ADAPT_NONE)
+   {
+      memcpy(p,x->mF,NP*sizeof(double));
+      p += NP*sizeof(double);
+      memcpy(p,x->mCR,NP*sizeof(double));
+      p += NP*sizeof(double);
+   }
+   if (cfg->surr_k > 0)
+   {
+      memcpy(p,x->ax,(size_t)x->acap*(D+1)*sizeof(double));  /* ax, acost */
+      p += (size_t)x->acap*(D+1)*sizeof(double);
+   }
+   if (x->cache != NULL) de_cache_save(x->cache,p);
+
+   pthread_mutex_lock(&c->lock);
+   c->full = 1;
+   pthread_cond_broadcast(&c->cond);
+   pthread_mutex_unlock(&c->lock);
+   c->saved = x->gen;
+}
+
+
+void de_ckpt_save(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Takes a snapshot after every cfg->checkpoint_every generations,  **
+** unless the writer is still busy with the previous one.           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (x->ckpt != NULL && x->gen%x->cfg->checkpoint_every == 0) ckpt_copy(x,0);
+}
+
+
+int de_ckpt_close(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Saves the final state, if that has not been done, waits for the  **
+** writer and stops it. Returns DE_OK, or DE_EIO if any checkpoint  **
+** could not be written.                                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ckpt *c = x->ckpt;
+   int ret;
+
+   if (c == NULL) return DE_OK;
+   if (c->saved != x->gen) ckpt_copy(x,1);
+   pthread_mutex_lock(&c->lock);
+   c->stop = 1;
+   pthread_cond_broadcast(&c->cond);
+   pthread_mutex_unlock(&c->lock);
+   pthread_join(c->tid,NULL);
+
+   ret = c->failed ? DE_EIO : DE_OK;
+   pthread_mutex_destroy(&c->lock);
+   pthread_cond_destroy(&c->cond);
+   free(c->buf); free(c->path); free(c->tmp); free(c);
+   x->ckpt = NULL;
+   return ret;
+}
+
+
+int de_ckpt_load(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Maps the snapshot cfg->checkpoint and restores the solver state  **
+** from it. Returns DE_OK, DE_EIO if the file cannot be read or is  **
+** damaged, or DE_EINVAL if it was written for another problem.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   const ckpt_head *h;
+   const char *m, *p;
+   struct stat st;
+   size_t size = ckpt_size(cfg);
+   int   fd, i, ret = DE_OK;
+   int   D = cfg->D, NP = cfg->NP;
+
+   fd = open(cfg->checkpoint,O_RDONLY);
+   if (fd < 0) return DE_EIO;
+   if (fstat(fd,&st) != 0 || (size_t)st.st_size < sizeof(ckpt_head))
+   {
+      close(fd);
+      return DE_EIO;
+   }
+   m = (const char *)mmap(NULL,st.st_size,PROT_READ,MAP_SHARED,fd,0);
+   close(fd);
+   if (m == MAP_FAILED) return DE_EIO;
+   h = (const ckpt_head *)m;
+
+   if (memcmp(h->magic,CKPT_MAGIC,8) != 0 || h->version != CKPT_VERSION ||
+       h->rng_size != (int)sizeof(de_rng) || h->size != (size_t)st.st_size)
+   {
+      ret = DE_EIO;
+   }
+   else if (h->D != D || h->NP != NP || h->strategy != cfg->strategy ||
+            h->rng != cfg->rng || h->mode != cfg->mode ||
+            h->seed != cfg->seed || h->F != cfg->F || h->CR != cfg->CR ||
+            h->adapt != cfg->adapt || h->np_min != cfg->np_min ||
+            h->bound != cfg->bound || h->surr_k != cfg->surr_k ||
+            h->surr_keep != cfg->surr_keep || h->acap != x->acap ||
+            h->local != cfg->local || h->local_every != cfg->local_every ||
+            h->local_stall != cfg->local_stall ||
+            h->local_budget != cfg->local_budget ||
+            h->cache != cfg->cache || h->quant != ckpt_quant(cfg) ||
+            h->an < 0 || h->an > x->acap || h->apos < 0 ||
+            (h->apos > 0 && h->apos >= x->acap) ||
+            h->np < 1 || h->np > NP || h->size != size)
+   {
+      ret = DE_EINVAL;
+   }
+   else if (h->sum != ckpt_sum(m+sizeof(ckpt_head),size-sizeof(ckpt_head)))
+   {
+      ret = DE_EIO;
+   }
+   if (ret != DE_OK)
+   {
+      munmap((void *)m,st.st_size);
+      return ret;
+   }
+
+   x->gen    = h->gen;
+   x->last_imp  = h->last_imp;
+   x->last_cmin = h->last_cmin;
+   x->lpol      = h->lpol;
+   x->imin   = h->imin;
+   x->nfeval = h->nfeval;
+   x->nreject = h->nreject;
+   x->nscreen = h->nscreen;
+   x->nlocal  = h->nlocal;
+   x->nhit    = h->nhit;
+   x->nmiss   = h->nmiss;
+   x->an     = h->an;
+   x->apos   = h->apos;
+   x->cmin   = h->cmin;
+   x->cmean  = h->cmean;
+   x->cvar   = h->cvar;
+   x->NP     = h->np;
+   x->hk     = h->hk;
+
+   p = m + sizeof(ckpt_head);
+   memcpy(&x->rnd,p,sizeof(de_rng));
+   p += sizeof(de_rng);
+   for (i=0; i<NP; i++) p = get_row(p,MEM(i),D);
+   memcpy(x->cost,p,NP*sizeof(double));
+   p += NP*sizeof(double);
+   memcpy(x->best,p,D*sizeof(double));
+   p += D*sizeof(double);
+   p = get_row(p,x->bestit,D);
+   memcpy(x->hF,p,DE_ADAPT_H*sizeof(double));
+   p += DE_ADAPT_H*sizeof(double);
+   memcpy(x->hCR,p,DE_ADAPT_H*sizeof(double));
+   p += DE_ADAPT_H*sizeof(double);
+   if (cfg->adapt != DE_ADAPT_NONE)
+   {
+      memcpy(x->mF,p,NP*sizeof(double));
+      p += NP*sizeof(double);
+      memcpy(x->mCR,p,NP*sizeof(double));
+      p += NP*sizeof(double);
+   }
+   if (cfg->surr_k > 0)
+   {
+      memcpy(x->ax,p,(size_t)x->acap*(D+1)*sizeof(double));
+      p += (size_t)x->acap*(D+1)*sizeof(double);
+   }
+   if (x->cache != NULL) de_cache_load(x->cache,p);
+
+   munmap((void *)m,st.st_size);
+   return DE_OK;
+}
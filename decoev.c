@@ -0,0 +1,732 @@
+# include "de.h"
+# include <string.h>
+
+/*------------------------Cooperative coevolution-----------------------*/
+/*------The D parameters are split into subcomponents, and in every-----*/
+/*------cycle each subcomponent is solved by de_solve() for cc->gens----*/
+/*------generations as a problem of its own: its trials are completed---*/
+/*------from a shared context vector, the best point found so far, and--*/
+/*------evaluated in full. The populations of all subcomponents are----*/
+/*------the columns of one population of NP rows of D: a run starts----*/
+/*------from the columns of its parameters, evaluated against the-------*/
+/*------current context, and puts its last population back, so the-----*/
+/*------search goes on from cycle to cycle whatever the grouping. The---*/
+/*------context values of its parameters join a run after the first-----*/
+/*------generation through cfg.migrate, so it cannot end worse than the-*/
+/*------context. Its best point then replaces these parameters if it----*/
+/*------improved on the context.-----------------------------------------*/
+/*                                                                      */
+/*------The subcomponents are blocks of cc->size parameters, fixed or---*/
+/*------of a new random permutation every cycle (Yang et al. 2008), or--*/
+/*------found by differential grouping (Omidvar et al. 2014): i and j----*/
+/*------interact if changing x[j] changes the effect of a change of------*/
+/*------x[i] by more than cc->eps. That takes about D*D/2 evaluations---*/
+/*------for a separable problem, but they run on the pool. Interacting--*/
+/*------parameters stay in one subcomponent whatever its size; smaller--*/
+/*------groups and the separable parameters are packed into blocks of---*/
+/*------up to cc->size.--------------------------------------------------*/
+/*                                                                      */
+/*------One after another, every subcomponent sees the improvements of--*/
+/*------those before it and may use cfg->threads itself. In parallel,---*/
+/*------each is one run on one thread of a pool of cfg->threads against-*/
+/*------the context of the start of the cycle; the results are merged---*/
+/*------in order of their costs, each kept if the whole is better. Both-*/
+/*------do not depend on the number of threads.-------------------------*/
+
+char *de_group_name[] =   /* groupings of the parameters        */
+{
+         "fixed",
+         "random",
+         "diff"
+};
+
+typedef struct cc_ctx cc_ctx;
+
+typedef struct cc_job     /* one subcomponent run               */
+{
+   cc_ctx *c;
+   int    g;              /* its group                          */
+   double ccost;          /* cost of the context it starts from */
+   de_config cfg;
+   de_result res;
+   int    ret;            /* de_solve() return code             */
+} cc_job;
+
+typedef struct cc_rank    /* a result to merge                  */
+{
+   double cost;
+   int    g;
+} cc_rank;
+
+struct cc_ctx
+{
+   const de_coev_config *cc;
+   const de_config *cfg;
+   de_objective fn;       /* objective function                 */
+   void  *user;           /* passed through to fn               */
+   int    D;
+   de_pool *pool;         /* cfg->threads threads, or NULL      */
+   de_rng rnd;            /* groups, seeds and the first context */
+   double *ctx;           /* context vector                     */
+   double ccost;          /* its cost                           */
+   double *lo, *hi;       /* bounds of the parameters, D each   */
+   double *scratch;       /* D doubles per pool thread          */
+   int   *perm;           /* parameters in the order of groups  */
+   int   *start;          /* group g is perm[start[g]..start[g+1]-1] */
+   int    ng;             /* number of groups                   */
+   double *glo, *ghi;     /* bounds in the order of perm        */
+   double *gbest;         /* best subvectors, order of perm     */
+   double *pop;           /* population, NP rows of D           */
+   double *gpop;          /* its columns by group, NP rows each */
+   cc_job *job;           /* ng subcomponent runs               */
+   cc_rank *rank;         /* ng results to merge                */
+   int   *rem;            /* _DIFF: parameters not yet grouped  */
+   char  *mark;           /* _DIFF: rem[k] interacts with rem[0] */
+   double *fj;            /* _DIFF: f(lo) with x[j] at the middle */
+   double f0, fi;         /* _DIFF: f(lo) and with x[i] at hi   */
+   long   nfeval, nreject, nscreen, nlocal, nhit, nmiss;
+   double busy;           /* thread seconds of the subcomponents */
+   double cmean, cvar;    /* means over the last cycle's runs   */
+   double t0;             /* de_time() at the start             */
+   int    cycle;          /* cycles begun                       */
+   int    stop;           /* DE_STOP_* reason, or -1            */
+};
+
+
+static int over(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Checks the stop conditions of the whole run except the number of **
+** cycles, and sets c->stop to the reason if one is met.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = c->cfg;
+
+   if (cfg->stop != NULL && *cfg->stop)              c->stop = DE_STOP_USER;
+   else if (c->ccost <= cfg->vtr)                    c->stop = DE_STOP_VTR;
+   else if (cfg->max_nfeval > 0 && c->nfeval >= cfg->max_nfeval)
+                                                     c->stop = DE_STOP_NFEVAL;
+   else if (cfg->max_wall > 0 && de_time()-c->t0 >= cfg->max_wall)
+                                                     c->stop = DE_STOP_WALL;
+   return c->stop >= 0;
+}
+
+
+static void blocks(cc_ctx *c, int n)
+/**C*F****************************************************************
+**                                                                  **
+** Cuts perm[c->start[c->ng]..] into groups of cc->size parameters, **
+** the last one possibly smaller, n parameters in all.              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k = c->start[c->ng], end = k + n;
+
+   while (k < end)
+   {
+      k = (k + c->cc->size < end) ? k + c->cc->size : end;
+      c->start[++c->ng] = k;
+   }
+}
+
+
+static void order_bounds(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Puts the bounds into the order of perm.                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   for (k=0; k<c->D; k++)
+   {
+      c->glo[k] = c->lo[c->perm[k]];
+      c->ghi[k] = c->hi[c->perm[k]];
+   }
+}
+
+
+static void shuffle(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Draws a new random order of the parameters, Fisher-Yates.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k, r, t;
+
+   for (k=c->D-1; k>0; k--)
+   {
+      r = (int)(de_rng_uni(&c->rnd)*(k+1));
+      t = c->perm[k];
+      c->perm[k] = c->perm[r];
+      c->perm[r] = t;
+   }
+   order_bounds(c);
+}
+
+
+static double *scratch(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** D doubles of the calling pool thread.                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   return c->scratch + (size_t)de_pool_self(c->pool)*c->D;
+}
+
+
+static void dg_mid(void *arg, int j)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: fj[j] = f(lo with x[j] in the middle of its bounds).  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_ctx *c = (cc_ctx *)arg;
+   double *p = scratch(c);
+
+   memcpy(p,c->lo,c->D*sizeof(double));
+   p[j] = 0.5*(c->lo[j] + c->hi[j]);
+   c->fj[j] = c->fn(c->D,p,c->user);
+}
+
+
+static void dg_test(void *arg, int k)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: tests whether rem[k] interacts with i = rem[0], i.e.  **
+** whether moving x[i] from lo to hi changes f by another amount    **
+** once x[j] is in the middle.                                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_ctx *c = (cc_ctx *)arg;
+   double *p = scratch(c);
+   int i = c->rem[0], j = c->rem[k];
+
+   memcpy(p,c->lo,c->D*sizeof(double));
+   p[i] = c->hi[i];
+   p[j] = 0.5*(c->lo[j] + c->hi[j]);
+   c->mark[k] = (fabs((c->f0 - c->fi) - (c->fj[j] - c->fn(c->D,p,c->user)))
+                 > c->cc->eps);
+}
+
+
+static void group_diff(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Differential grouping: takes the first ungrouped parameter i and **
+** all that interact with it as one group, until none are left.     **
+** f(lo) with x[j] in the middle is the same for every i and is     **
+** evaluated once per j, so a pair costs one evaluation. Adjacent   **
+** groups are then packed together while they have at most cc->size **
+** parameters, so that a chain of pairs is not solved pair by pair. **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int D = c->D, nrem = D, nsep = 0, n, k, e;
+   int *sep = c->perm + D;   /* separable ones, collected from the end */
+
+   c->f0 = c->fn(D,c->lo,c->user);
+   de_pool_run(c->pool,D,dg_mid,c);
+   c->nfeval += 1 + D;
+   for (k=0; k<D; k++) c->rem[k] = k;
+
+   c->ng = 0;
+   c->start[0] = 0;
+   while (nrem > 0)
+   {
+      memcpy(scratch(c),c->lo,D*sizeof(double));
+      scratch(c)[c->rem[0]] = c->hi[c->rem[0]];
+      c->fi = c->fn(D,scratch(c),c->user);
+      c->mark[0] = 0;
+      de_pool_run(c->pool,nrem,dg_test,c);  /* k=0 is i itself */
+      c->nfeval += nrem;
+
+      n = 0;
+      for (k=1; k<nrem; k++) n += c->mark[k];
+      if (n == 0) *--sep = c->rem[0], nsep++;
+      else
+      {
+         k = c->start[c->ng];
+         c->perm[k++] = c->rem[0];
+         for (n=1; n<nrem; n++)
+         {
+            if (c->mark[n]) c->perm[k++] = c->rem[n];
+         }
+         c->start[++c->ng] = k;
+      }
+      for (n=0, k=1; k<nrem; k++)    /* the rest stays ungrouped */
+      {
+         if (!c->mark[k]) c->rem[n++] = c->rem[k];
+      }
+      nrem = n;
+   }
+   for (n=0, k=0; k<c->ng; k++)      /* pack small groups up to size */
+   {
+      e = c->start[k+1];             /* the old bound, read first */
+      if (n > 0 && e - c->start[n-1] <= c->cc->size) c->start[n] = e;
+      else c->start[++n] = e;
+   }
+   c->ng = n;
+   for (k=0; k<nsep/2; k++)          /* ascending, as they were found */
+   {
+      n = sep[k];
+      sep[k] = sep[nsep-1-k];
+      sep[nsep-1-k] = n;
+   }
+   blocks(c,nsep);                   /* sep[] is already in place */
+   order_bounds(c);
+}
+
+
+static double sub_eval(cc_job *j, double *f, const double *x)
+/**C*F****************************************************************
+**                                                                  **
+** Completes the parameters x of group j->g from the context in f   **
+** and evaluates f. f holds the context on entry.                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_ctx *c = j->c;
+   const int *idx = c->perm + c->start[j->g];
+   int k;
+
+   for (k=0; k<j->cfg.D; k++) f[idx[k]] = x[k];
+   return c->fn(c->D,f,c->user);
+}
+
+
+static void sub_batch(int D, int n, const double *X, size_t stride,
+                      double *costs, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** de_batch of a subcomponent run. Rows are completed in a copy of  **
+** the context: the D doubles of the pool thread if the run is on   **
+** one thread, else a buffer of this call.                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_job *j = (cc_job *)user;
+   cc_ctx *c = j->c;
+   double *f;
+   int r;
+
+   f = (j->cfg.threads == 1) ? scratch(c) :
+                               (double *)malloc(c->D*sizeof(double));
+   if (f == NULL)
+   {
+      for (r=0; r<n; r++) costs[r] = HUGE_VAL;
+      return;
+   }
+   memcpy(f,c->ctx,c->D*sizeof(double));
+   for (r=0; r<n; r++) costs[r] = sub_eval(j,f,X + (size_t)r*stride);
+   if (j->cfg.threads != 1) free(f);
+}
+
+
+static int sub_migrate(int gen, int D, const double *best, double cmin,
+                       double *in, double *in_cost, int max, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** de_migrate of a subcomponent run: after the first generation the **
+** context values of the group come in as one immigrant.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_job *j = (cc_job *)user;
+   cc_ctx *c = j->c;
+   const int *idx = c->perm + c->start[j->g];
+   int k;
+
+   if (gen != 1) return 0;
+   for (k=0; k<D; k++) in[k] = c->ctx[idx[k]];
+   *in_cost = j->ccost;
+   return 1;
+}
+
+
+static void setup_job(cc_ctx *c, int g, int threads)
+/**C*F****************************************************************
+**                                                                  **
+** Prepares the run of group g: cfg of the whole problem restricted **
+** to the group, cc->gens generations, a seed drawn from c->rnd and **
+** what is left of the evaluation and time budgets, split over the  **
+** groups when they run in parallel.                                **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = c->cfg;
+   cc_job *j = c->job + g;
+   int    s  = c->start[g];
+   long   nf = cfg->max_nfeval - c->nfeval;
+
+   if (c->cc->parallel) nf /= c->ng;
+   j->c     = c;
+   j->g     = g;
+   j->ccost = c->ccost;
+   j->cfg   = *cfg;
+   j->cfg.D       = c->start[g+1] - s;
+   j->cfg.lo      = c->glo + s;
+   j->cfg.hi      = c->ghi + s;
+   j->cfg.genmax  = c->cc->gens;
+   j->cfg.threads = threads;
+   j->cfg.seed    = 1 + (int)(de_rng_uni(&c->rnd)*2147483646.0);
+   j->cfg.batch   = sub_batch;
+   j->cfg.monitor = NULL;
+   j->cfg.migrate = sub_migrate;
+   j->cfg.migrate_user  = j;
+   j->cfg.migrate_every = 1;
+   j->cfg.nimm    = 1;
+   if (cfg->max_nfeval > 0) j->cfg.max_nfeval = (nf > 0) ? nf : 1;
+   if (cfg->max_wall > 0)
+   {
+      j->cfg.max_wall = cfg->max_wall - (de_time() - c->t0);
+      if (j->cfg.max_wall <= 0) j->cfg.max_wall = 1e-9;
+   }
+   j->cfg.init_pop  = c->gpop + (size_t)cfg->NP*s;
+   j->cfg.final_pop = c->gpop + (size_t)cfg->NP*s;
+   j->res.best = c->gbest + s;
+}
+
+
+static void run_job(void *arg, int g)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: solves group g as prepared by setup_job(), starting   **
+** from and returning to its columns of the population.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   cc_ctx *c = (cc_ctx *)arg;
+   cc_job *j = c->job + g;
+   const int *idx = c->perm + c->start[g];
+   double *q = c->gpop + (size_t)c->cfg->NP*c->start[g];
+   int n = j->cfg.D, i, k;
+
+   for (i=0; i<c->cfg->NP; i++)    /* the columns of the group */
+   {
+      for (k=0; k<n; k++) q[(size_t)i*n+k] = c->pop[(size_t)i*c->D+idx[k]];
+   }
+   j->ret = de_solve(&j->cfg,NULL,j,&j->res);
+   for (i=0; i<c->cfg->NP; i++)
+   {
+      for (k=0; k<n; k++) c->pop[(size_t)i*c->D+idx[k]] = q[(size_t)i*n+k];
+   }
+}
+
+
+static void count_job(cc_ctx *c, const cc_job *j)
+/**C*F****************************************************************
+**                                                                  **
+** Adds the counters of a finished subcomponent run to the totals.  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   c->nfeval  += j->res.nfeval;
+   c->nreject += j->res.nrejected;
+   c->nscreen += j->res.nscreened;
+   c->nlocal  += j->res.nlocal;
+   c->nhit    += j->res.nhit;
+   c->nmiss   += j->res.nmiss;
+   c->busy    += j->res.utilization*j->res.wall*j->cfg.threads;
+   c->cmean   += j->res.cmean;
+   c->cvar    += j->res.cvar;
+}
+
+
+static void apply(cc_ctx *c, int g)
+/**C*F****************************************************************
+**                                                                  **
+** Copies the best subvector of group g into the context.           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   for (k=c->start[g]; k<c->start[g+1]; k++) c->ctx[c->perm[k]] = c->gbest[k];
+}
+
+
+static int cmp_rank(const void *a, const void *b)
+{
+   const cc_rank *u = (const cc_rank *)a, *v = (const cc_rank *)b;
+   return (u->cost < v->cost) ? -1 : (u->cost > v->cost) ? 1 : u->g - v->g;
+}
+
+
+static void merge(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Merges the results of a parallel cycle, best first. The first    **
+** improvement is taken as it is; each further one is evaluated     **
+** together with those taken and undone unless the whole improves.  **
+** The old values are kept in the D doubles of the calling thread.  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double *old = scratch(c), f, c0 = c->ccost;
+   int n = 0, r, g, k;
+
+   for (g=0; g<c->ng; g++)
+   {
+      if (c->job[g].res.cmin < c0)
+      {
+         c->rank[n].cost = c->job[g].res.cmin;
+         c->rank[n++].g  = g;
+      }
+   }
+   qsort(c->rank,n,sizeof(cc_rank),cmp_rank);
+   for (r=0; r<n; r++)
+   {
+      g = c->rank[r].g;
+      for (k=c->start[g]; k<c->start[g+1]; k++) old[k] = c->ctx[c->perm[k]];
+      apply(c,g);
+      if (r == 0)
+      {
+         c->ccost = c->rank[0].cost;
+         continue;
+      }
+      f = c->fn(c->D,c->ctx,c->user);
+      c->nfeval++;
+      if (f < c->ccost) c->ccost = f;
+      else
+      {
+         for (k=c->start[g]; k<c->start[g+1]; k++) c->ctx[c->perm[k]] = old[k];
+      }
+   }
+}
+
+
+static int cycle(cc_ctx *c)
+/**C*F****************************************************************
+**                                                                  **
+** Runs every subcomponent once. Returns DE_OK or the error of a    **
+** failed de_solve().                                               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int g, n = 0;
+
+   c->cycle++;
+   c->cmean = c->cvar = 0;
+   if (c->cc->grouping == DE_GROUP_RANDOM) shuffle(c);
+   if (c->cc->parallel)
+   {
+      for (g=0; g<c->ng; g++) setup_job(c,g,1);
+      de_pool_run(c->pool,c->ng,run_job,c);
+      for (g=0; g<c->ng; g++)
+      {
+         if (c->job[g].ret != DE_OK) return c->job[g].ret;
+         count_job(c,c->job+g);
+      }
+      merge(c);
+      n = c->ng;
+   }
+   else
+   {
+      for (g=0; g<c->ng && !over(c); g++, n++)
+      {
+         setup_job(c,g,c->cfg->threads);
+         run_job(c,g);
+         if (c->job[g].ret != DE_OK) return c->job[g].ret;
+         count_job(c,c->job+g);
+         if (c->job[g].res.cmin < c->ccost)
+         {
+            apply(c,g);
+            c->ccost = c->job[g].res.cmin;
+         }
+      }
+   }
+   if (n > 0)
+   {
+      c->cmean /= n;
+      c->cvar  /= n;
+   }
+   return DE_OK;
+}
+
+
+static int run(cc_ctx *c, de_result *res)
+/**C*F****************************************************************
+**                                                                  **
+** Draws the context and the population, forms the groups and runs  **
+** the cycles until a stop condition is met, then fills res.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = c->cfg;
+   de_progress p;
+   int D = c->D, NP = cfg->NP, i, k, ret;
+
+/*-----Context vector and population, random within the bounds--------*/
+
+   de_rng_init(&c->rnd,DE_RNG_XOSHIRO,cfg->seed,0xc0e);
+   for (k=0; k<D; k++)
+   {
+      c->lo[k]  = (cfg->lo != NULL) ? cfg->lo[k] : cfg->inibound_l;
+      c->hi[k]  = (cfg->hi != NULL) ? cfg->hi[k] : cfg->inibound_h;
+      c->ctx[k] = c->lo[k] + de_rng_uni(&c->rnd)*(c->hi[k] - c->lo[k]);
+   }
+   for (i=0; i<NP; i++)
+   {
+      for (k=0; k<D; k++)
+      {
+         c->pop[(size_t)i*D+k] = c->lo[k] + de_rng_uni(&c->rnd)*(c->hi[k] - c->lo[k]);
+      }
+   }
+   c->ccost  = c->fn(D,c->ctx,c->user);
+   c->nfeval = 1;
+
+/*-----Groups-----------------------------------------------------------*/
+
+   if (c->cc->grouping == DE_GROUP_DIFF) group_diff(c);
+   else
+   {
+      for (k=0; k<D; k++) c->perm[k] = k;
+      c->start[0] = 0;
+      blocks(c,D);
+      order_bounds(c);
+   }
+
+/*-----Cycles-----------------------------------------------------------*/
+
+   while (!over(c) && c->cycle < c->cc->cycles)
+   {
+      if ((ret = cycle(c)) != DE_OK) return ret;
+      if (cfg->monitor == NULL) continue;
+      p.gen    = c->cycle;
+      p.nfeval = c->nfeval;
+      p.D      = D;
+      p.NP     = cfg->NP;
+      p.cmin   = c->ccost;
+      p.cmean  = c->cmean;
+      p.cvar   = c->cvar;
+      p.best   = c->ctx;
+      cfg->monitor(&p,cfg->monitor_user);
+   }
+   if (c->stop < 0) c->stop = DE_STOP_GENMAX;
+
+   res->cmin   = c->ccost;
+   res->gen    = c->cycle;
+   res->nfeval = c->nfeval;
+   res->cmean  = c->cmean;
+   res->cvar   = c->cvar;
+   res->stop   = c->stop;
+   res->nrejected = c->nreject;
+   res->nscreened = c->nscreen;
+   res->nlocal = c->nlocal;
+   res->nhit   = c->nhit;
+   res->nmiss  = c->nmiss;
+   res->wall   = de_time() - c->t0;
+   res->evals_per_sec = (res->wall > 0) ? c->nfeval/res->wall : 0;
+   res->utilization   = (res->wall > 0) ?
+                        c->busy/(res->wall*de_pool_size(c->pool)) : 0;
+#ifdef DE_PROFILE
+   memset(&res->prof,0,sizeof(res->prof));
+#endif
+   if (res->best != NULL) memcpy(res->best,c->ctx,D*sizeof(double));
+   return DE_OK;
+}
+
+
+int de_coev(const de_coev_config *cc, const de_config *cfg,
+            de_objective fn, void *user, de_result *res)
+/**C*F****************************************************************
+**                                                                  **
+** SRC-FUNCTION   :de_coev()                                        **
+** LONG_NAME      :cooperative coevolution driver                   **
+**                                                                  **
+** DESCRIPTION    :minimizes fn() over cfg->D parameters by solving **
+**                 subcomponents of them in turn, cc->cycles times, **
+**                 see above. Every subcomponent run uses cfg with  **
+**                 D, the bounds, genmax and seed replaced; the     **
+**                 objective is always fn on the whole vector.      **
+**                 vtr, max_nfeval, max_wall and stop apply to the  **
+**                 whole run, stall and cvar_min to every sub-      **
+**                 component run. cfg->monitor is called after      **
+**                 every cycle with gen the cycle and cmean, cvar   **
+**                 the means over its runs.                         **
+**                                                                  **
+** PARAMETERS     :cc              grouping, cycles and generations **
+**                 cfg             solver configuration             **
+**                 fn, user        objective function and its data  **
+**                 res             receives the final results; gen  **
+**                                 is the number of cycles          **
+**                                                                  **
+** PRECONDITIONS  :res->best is NULL or points to D doubles. cfg    **
+**                 has no batch, delta, feasible, migrate, quant,   **
+**                 checkpoint or trace.                             **
+**                                                                  **
+** POSTCONDITIONS :returns DE_OK and fills res, or an error code.   **
+**                 max_nfeval may be exceeded by the initial        **
+**                 populations of the runs of the last cycle.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char msg[128];
+   cc_ctx c;
+   int D = cfg->D, nthr, ret = DE_ENOMEM;
+
+   if (de_check(cfg,msg,sizeof(msg)) != DE_OK || fn == NULL) return DE_EINVAL;
+   if (cfg->batch != NULL || cfg->delta != NULL || cfg->feasible != NULL ||
+       cfg->migrate != NULL || cfg->quant != NULL || cfg->checkpoint != NULL ||
+       cfg->trace != NULL)
+   {
+      return DE_EINVAL;
+   }
+   if (cc->grouping < DE_GROUP_FIXED || cc->grouping > DE_GROUP_DIFF ||
+       cc->size <= 0 || cc->cycles <= 0 || cc->gens <= 0 || cc->eps < 0)
+   {
+      return DE_EINVAL;
+   }
+
+   memset(&c,0,sizeof(c));
+   c.cc   = cc;
+   c.cfg  = cfg;
+   c.fn   = fn;
+   c.user = user;
+   c.D    = D;
+   c.stop = -1;
+   c.t0   = de_time();
+   if (cfg->threads > 1 && (c.pool = de_pool_create(cfg->threads)) == NULL)
+   {
+      return DE_ENOMEM;
+   }
+   nthr = de_pool_size(c.pool);
+
+   c.ctx  = (double *)malloc((size_t)(7 + nthr)*D*sizeof(double));
+   c.perm = (int *)malloc((3*(size_t)D + 1)*sizeof(int));
+   c.job  = (cc_job *)malloc(D*sizeof(cc_job));
+   c.rank = (cc_rank *)malloc(D*sizeof(cc_rank));
+   c.mark = (char *)malloc(D);
+   c.pop  = (double *)malloc(2*(size_t)cfg->NP*D*sizeof(double));
+   if (c.ctx != NULL && c.perm != NULL && c.job != NULL && c.rank != NULL &&
+       c.mark != NULL && c.pop != NULL)
+   {
+      c.gpop    = c.pop + (size_t)cfg->NP*D;
+      c.lo      = c.ctx + D;       /* ctx,lo,hi,glo,ghi,gbest,fj,scratch */
+      c.hi      = c.lo  + D;
+      c.glo     = c.hi  + D;
+      c.ghi     = c.glo + D;
+      c.gbest   = c.ghi + D;
+      c.fj      = c.gbest + D;
+      c.scratch = c.fj  + D;
+      c.start   = c.perm + D;      /* perm,start,rem */
+      c.rem     = c.start + D + 1;
+      ret = run(&c,res);
+   }
+
+   free(c.ctx);
+   free(c.perm);
+   free(c.job);
+   free(c.rank);
+   free(c.mark);
+   free(c.pop);
+   de_pool_free(c.pool);
+   return ret;
+}
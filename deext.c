@@ -0,0 +1,453 @@
+# include "de.h"
+# include <pthread.h>
+# include <poll.h>
+# include <errno.h>
+# include <fcntl.h>
+# include <signal.h>
+# include <unistd.h>
+# include <sys/socket.h>
+# include <sys/wait.h>
+
+/*------------------------External evaluator pool-----------------------*/
+/*------N long-lived worker processes, each started once with "sh -c----*/
+/*------cmd" and connected through a Unix socket pair on its stdin and--*/
+/*------stdout. de_ext_batch(), a de_batch, splits the rows it gets over-*/
+/*------the idle workers and streams them out as one frame per worker;--*/
+/*------all frames are written and read side by side with poll(). A-----*/
+/*------worker that crashes or misses the timeout is killed, started----*/
+/*------again and given its frame once more, up to retries times; after-*/
+/*------that its rows cost HUGE_VAL. Several threads may call------------*/
+/*------de_ext_batch() at once, each gets its own workers.--------------*/
+/*                                                                      */
+/*------Protocol, native byte order (tools/worker.c is the reference):--*/
+/*------  start:    solver sends de_ext_hello {magic, D},---------------*/
+/*------            worker answers with the 8 bytes of magic------------*/
+/*------  frame:    solver sends uint32 n and n rows of D doubles,------*/
+/*------            worker answers with n doubles, the costs------------*/
+/*------  end:      solver closes the socket, worker exits on EOF-------*/
+
+typedef struct ext_worker
+{
+   pid_t  pid;            /* 0 if not running                   */
+   int    fd;             /* our end of the socket pair, or -1  */
+   int    busy;           /* taken by a de_ext_batch() call     */
+   char  *buf;            /* request frame                      */
+   size_t cap;            /* bytes allocated for buf            */
+   size_t olen, opos;     /* bytes of the frame, bytes sent     */
+   size_t ipos;           /* bytes of the answer received       */
+   double *costs;         /* receives the answer                */
+   int    n;              /* rows in the frame                  */
+   int    tries;          /* failed attempts at this frame      */
+   double deadline;       /* de_time() by which it must be done */
+} ext_worker;
+
+struct de_ext
+{
+   char  *cmd;            /* command that starts a worker       */
+   int    N, D;
+   double timeout;        /* seconds per frame, 0 for none      */
+   int    retries;        /* new attempts after a failure       */
+   ext_worker *w;
+   pthread_mutex_t lock;  /* protects busy and the counters     */
+   pthread_cond_t  idle;  /* a worker became idle               */
+   long   restarts, timeouts, failed;
+};
+
+
+static int ext_wait(int fd, short ev, double deadline)
+/**C*F****************************************************************
+**                                                                  **
+** Waits until fd is ready for ev or the deadline (0: none) has     **
+** passed. Returns 1 if ready, 0 on timeout.                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   struct pollfd p;
+   int ms;
+
+   p.fd     = fd;
+   p.events = ev;
+   do
+   {
+      ms = (deadline > 0) ? (int)(1000*(deadline - de_time())) + 1 : -1;
+      if (deadline > 0 && ms <= 0) return 0;
+   }while(poll(&p,1,ms) < 0 && errno == EINTR);
+   return p.revents != 0;
+}
+
+
+static void ext_kill(ext_worker *w)
+/**C*F****************************************************************
+**                                                                  **
+** Stops worker w and whatever it started at once, and reaps it.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (w->fd >= 0) close(w->fd);
+   if (w->pid > 0)
+   {
+      kill(-w->pid,SIGKILL);              /* its process group */
+      waitpid(w->pid,NULL,0);
+   }
+   w->fd  = -1;
+   w->pid = 0;
+}
+
+
+static int ext_spawn(de_ext *e, ext_worker *w)
+/**C*F****************************************************************
+**                                                                  **
+** Starts a worker process and does the handshake. Returns 0, or -1 **
+** if the worker could not be started or did not answer in time.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ext_hello h;
+   char   ans[8];
+   size_t got = 0;
+   double deadline = (e->timeout > 0) ? de_time() + e->timeout : 0;
+   int    sv[2];
+   ssize_t r;
+
+   if (socketpair(AF_UNIX,SOCK_STREAM|SOCK_CLOEXEC,0,sv) != 0) return -1;
+   w->pid = fork();
+   if (w->pid < 0)
+   {
+      close(sv[0]);
+      close(sv[1]);
+      w->pid = 0;
+      return -1;
+   }
+   if (w->pid == 0)       /* worker: socket on stdin and stdout */
+   {
+      setpgid(0,0);       /* Ctrl-C stops the solver, not the workers */
+      dup2(sv[1],0);
+      dup2(sv[1],1);
+      execl("/bin/sh","sh","-c",e->cmd,(char *)NULL);
+      _exit(127);
+   }
+   setpgid(w->pid,w->pid);                  /* either side may run first */
+   close(sv[1]);
+   w->fd = sv[0];
+
+   memset(&h,0,sizeof(h));
+   memcpy(h.magic,DE_EXT_MAGIC,8);
+   h.D = e->D;
+   if (send(w->fd,&h,sizeof(h),MSG_NOSIGNAL) != (ssize_t)sizeof(h))
+   {
+      ext_kill(w);
+      return -1;
+   }
+   while (got < sizeof(ans))
+   {
+      if (!ext_wait(w->fd,POLLIN,deadline) ||
+          (r = recv(w->fd,ans+got,sizeof(ans)-got,0)) <= 0)
+      {
+         ext_kill(w);
+         return -1;
+      }
+      got += r;
+   }
+   if (memcmp(ans,DE_EXT_MAGIC,8) != 0)
+   {
+      ext_kill(w);
+      return -1;
+   }
+   fcntl(w->fd,F_SETFL,fcntl(w->fd,F_GETFL) | O_NONBLOCK);
+   return 0;
+}
+
+
+de_ext *de_ext_create(const char *cmd, int N, int D, double timeout,
+                      int retries)
+/**C*F****************************************************************
+**                                                                  **
+** Starts N workers running cmd for vectors of D parameters. A      **
+** frame must be answered within timeout seconds (0: no limit); a   **
+** failed frame is tried retries more times. Returns NULL if out of **
+** memory or a worker does not start.                               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ext *e;
+   int k;
+
+   if (N <= 0 || D <= 0 || timeout < 0 || retries < 0) return NULL;
+   e = (de_ext *)calloc(1,sizeof(de_ext));
+   if (e == NULL) return NULL;
+   e->cmd     = strdup(cmd);
+   e->w       = (ext_worker *)calloc(N,sizeof(ext_worker));
+   e->N       = N;
+   e->D       = D;
+   e->timeout = timeout;
+   e->retries = retries;
+   if (e->cmd == NULL || e->w == NULL)
+   {
+      free(e->cmd);
+      free(e->w);
+      free(e);
+      return NULL;
+   }
+   pthread_mutex_init(&e->lock,NULL);
+   pthread_cond_init(&e->idle,NULL);
+   for (k=0; k<N; k++) e->w[k].fd = -1;
+   for (k=0; k<N; k++)
+   {
+      if (ext_spawn(e,&e->w[k]) != 0)
+      {
+         de_ext_free(e);
+         return NULL;
+      }
+   }
+   return e;
+}
+
+
+static void ext_frame(de_ext *e, ext_worker *w, int n, const double *X,
+                      size_t stride, double *costs)
+/**C*F****************************************************************
+**                                                                  **
+** Packs n rows of X into the request frame of w. Returns with      **
+** w->n = 0 if there is no memory for the frame.                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t len = sizeof(uint32_t) + (size_t)n*e->D*sizeof(double);
+   uint32_t un = (uint32_t)n;
+   char  *p;
+   int    i;
+
+   w->n = 0;
+   if (len > w->cap)
+   {
+      p = (char *)realloc(w->buf,len);
+      if (p == NULL) return;
+      w->buf = p;
+      w->cap = len;
+   }
+   memcpy(w->buf,&un,sizeof(un));
+   for (i=0, p=w->buf+sizeof(un); i<n; i++, p+=e->D*sizeof(double))
+   {
+      memcpy(p,X+(size_t)i*stride,e->D*sizeof(double));
+   }
+   w->n     = n;
+   w->costs = costs;
+   w->olen  = len;
+   w->tries = 0;
+}
+
+
+static void ext_arm(de_ext *e, ext_worker *w)
+/**C*F****************************************************************
+**                                                                  **
+** (Re)starts sending the frame of w with a fresh deadline.         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   w->opos     = 0;
+   w->ipos     = 0;
+   w->deadline = (e->timeout > 0) ? de_time() + e->timeout : 0;
+}
+
+
+static void ext_fail(de_ext *e, ext_worker *w, int timeout)
+/**C*F****************************************************************
+**                                                                  **
+** Worker w crashed or timed out: replaces it by a new process and  **
+** sends the frame again, or gives up on the frame after retries    **
+** attempts and sets its costs to HUGE_VAL.                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i, ok;
+
+   ext_kill(w);
+   ok = (ext_spawn(e,w) == 0);
+   pthread_mutex_lock(&e->lock);
+   if (timeout) e->timeouts++;
+   if (ok) e->restarts++;
+   if (!ok || ++w->tries > e->retries) e->failed += w->n;
+   pthread_mutex_unlock(&e->lock);
+
+   if (ok && w->tries <= e->retries)
+   {
+      ext_arm(e,w);
+      return;
+   }
+   for (i=0; i<w->n; i++) w->costs[i] = HUGE_VAL;
+   w->n = 0;              /* done with this frame               */
+}
+
+
+static int ext_step(de_ext *e, ext_worker *w, short revents)
+/**C*F****************************************************************
+**                                                                  **
+** Sends or receives what the socket of w is ready for. Returns 0,  **
+** or -1 if the worker went away.                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t  want = (size_t)w->n*sizeof(double);
+   ssize_t r;
+
+   if (w->opos < w->olen)
+   {
+      if (!(revents & POLLOUT)) return (revents & (POLLERR|POLLHUP)) ? -1 : 0;
+      r = send(w->fd,w->buf+w->opos,w->olen-w->opos,MSG_NOSIGNAL);
+      if (r < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+      w->opos += r;
+      return 0;
+   }
+   if (!(revents & (POLLIN|POLLERR|POLLHUP))) return 0;
+   r = recv(w->fd,(char *)w->costs+w->ipos,want-w->ipos,0);
+   if (r == 0) return -1;
+   if (r < 0) return (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+   w->ipos += r;
+   if (w->ipos == want) w->n = 0;     /* frame answered            */
+   return 0;
+}
+
+
+void de_ext_batch(int D, int n, const double *X, size_t stride,
+                  double *costs, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** de_batch of the pool, user is the de_ext: takes the idle workers **
+** (waiting for one if there is none), gives each a contiguous part **
+** of the n rows and collects the costs.                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ext *e = (de_ext *)user;
+   ext_worker **mine;
+   struct pollfd *pfd;
+   double now, next;
+   int    m, k, lo, hi, active, ms, i;
+
+   if (n <= 0) return;
+   mine = (ext_worker **)malloc(e->N*(sizeof(ext_worker *)+sizeof(struct pollfd)));
+   if (mine == NULL)
+   {
+      for (i=0; i<n; i++) costs[i] = HUGE_VAL;
+      return;
+   }
+   pfd = (struct pollfd *)(mine + e->N);
+
+   pthread_mutex_lock(&e->lock);
+   for (;;)
+   {
+      for (m=0, k=0; k<e->N && m<n; k++)
+      {
+         if (!e->w[k].busy) mine[m++] = &e->w[k];
+      }
+      if (m > 0) break;
+      pthread_cond_wait(&e->idle,&e->lock);
+   }
+   for (k=0; k<m; k++) mine[k]->busy = 1;
+   pthread_mutex_unlock(&e->lock);
+
+   for (k=0; k<m; k++)
+   {
+      lo = (int)((long)k*n/m);
+      hi = (int)((long)(k+1)*n/m);
+      ext_frame(e,mine[k],hi-lo,X+(size_t)lo*stride,stride,costs+lo);
+      if (mine[k]->n == 0)
+      {
+         for (i=lo; i<hi; i++) costs[i] = HUGE_VAL;
+         continue;
+      }
+      if (mine[k]->fd < 0) ext_fail(e,mine[k],0);  /* restart failed before */
+      else ext_arm(e,mine[k]);
+   }
+
+   for (;;)
+   {
+      active = 0;
+      next   = 0;
+      for (k=0; k<m; k++)
+      {
+         if (mine[k]->n == 0) continue;
+         pfd[active].fd      = mine[k]->fd;
+         pfd[active].events  = (mine[k]->opos < mine[k]->olen) ? POLLOUT : POLLIN;
+         pfd[active].revents = 0;
+         if (mine[k]->deadline > 0 && (next == 0 || mine[k]->deadline < next))
+         {
+            next = mine[k]->deadline;
+         }
+         active++;
+      }
+      if (active == 0) break;
+      ms = -1;               /* until the nearest deadline        */
+      if (next > 0 && (ms = (int)(1000*(next - de_time())) + 1) < 0) ms = 0;
+      if (poll(pfd,active,ms) < 0 && errno != EINTR) break;
+
+      now = de_time();
+      for (i=0, k=0; k<m; k++)
+      {
+         if (mine[k]->n == 0) continue;
+         if (ext_step(e,mine[k],pfd[i++].revents) != 0) ext_fail(e,mine[k],0);
+         else if (mine[k]->n > 0 && mine[k]->deadline > 0 && now > mine[k]->deadline)
+         {
+            ext_fail(e,mine[k],1);
+         }
+      }
+   }
+
+   pthread_mutex_lock(&e->lock);
+   for (k=0; k<m; k++) mine[k]->busy = 0;
+   pthread_cond_broadcast(&e->idle);
+   pthread_mutex_unlock(&e->lock);
+   free(mine);
+}
+
+
+void de_ext_counts(de_ext *e, long *restarts, long *timeouts, long *failed)
+/**C*F****************************************************************
+**                                                                  **
+** Workers restarted, frames timed out and rows given up so far.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   pthread_mutex_lock(&e->lock);
+   *restarts = e->restarts;
+   *timeouts = e->timeouts;
+   *failed   = e->failed;
+   pthread_mutex_unlock(&e->lock);
+}
+
+
+void de_ext_free(de_ext *e)
+/**C*F****************************************************************
+**                                                                  **
+** Closes the sockets, so that the workers exit, and reaps them;    **
+** a worker still running after a second is killed.                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   ext_worker *w;
+   int k, t;
+
+   if (e == NULL) return;
+   for (k=0; k<e->N; k++)
+   {
+      w = &e->w[k];
+      if (w->fd >= 0) close(w->fd);
+      w->fd = -1;
+   }
+   for (k=0; k<e->N; k++)
+   {
+      w = &e->w[k];
+      for (t=0; w->pid > 0 && t<100; t++)
+      {
+         if (waitpid(w->pid,NULL,WNOHANG) == w->pid) w->pid = 0;
+         else usleep(10000);
+      }
+      ext_kill(w);
+      free(w->buf);
+   }
+   pthread_mutex_destroy(&e->lock);
+   pthread_cond_destroy(&e->idle);
+   free(e->w);
+   free(e->cmd);
+   free(e);
+}
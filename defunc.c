@@ -0,0 +1,285 @@
+# include "de.h"
+
+/*------------------------Test function suite---------------------------*/
+/*------Standard benchmark problems, all with minimum 0, for measuring--*/
+/*------engine throughput and convergence without linking a problem of--*/
+/*------one's own. de_funcs[] lists them with their usual search range--*/
+/*------and the location of the optimum in every coordinate.-----------*/
+/*                                                                      */
+/*------de_problem_create() adds a shift and, if asked, a rotation:----*/
+/*------f(M(x-o) + opt), with o drawn in the inner 80% of the range and-*/
+/*------M a random orthogonal matrix, so that the optimum is at o and---*/
+/*------the problem is no longer separable. Both come from the seed.----*/
+
+struct de_problem
+{
+   const de_func *f;
+   int    D;
+   double *o;             /* shift, D doubles                   */
+   double *M;             /* rotation, D*D row-major, or NULL   */
+};
+
+#define ZSTACK 256        /* larger D use a heap buffer for z   */
+
+
+static double f_sphere(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Sphere, the function of dj9.c: sum of x[j]^2.                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j];
+   return s;
+}
+
+
+static double f_rosenbrock(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Rosenbrock's valley, minimum at x[j] = 1.                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0, a, b;
+   int j;
+
+   for (j=0; j<D-1; j++)
+   {
+      a  = x[j+1] - x[j]*x[j];
+      b  = 1.0 - x[j];
+      s += 100.0*a*a + b*b;
+   }
+   return s;
+}
+
+
+static double f_rastrigin(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Rastrigin's function, about 10^D local minima.                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 10.0*D;
+   int j;
+
+   for (j=0; j<D; j++) s += x[j]*x[j] - 10.0*cos(2.0*M_PI*x[j]);
+   return s;
+}
+
+
+static double f_ackley(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Ackley's function, a nearly flat outer region around a deep hole.**
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s1 = 0, s2 = 0;
+   int j;
+
+   for (j=0; j<D; j++)
+   {
+      s1 += x[j]*x[j];
+      s2 += cos(2.0*M_PI*x[j]);
+   }
+   return 20.0 + M_E - 20.0*exp(-0.2*sqrt(s1/D)) - exp(s2/D);
+}
+
+
+static double f_griewank(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Griewank's function.                                             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0, p = 1;
+   int j;
+
+   for (j=0; j<D; j++)
+   {
+      s += x[j]*x[j];
+      p *= cos(x[j]/sqrt(j+1.0));
+   }
+   return 1.0 + s/4000.0 - p;
+}
+
+
+static double f_schwefel(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** Schwefel's function 2.26, minimum near x[j] = 420.9687, far from **
+** the second best minima. Outside [-500,500] the function is       **
+** folded back and penalized as in CEC 2014, so that it stays       **
+** bounded below.                                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0, z, m;
+   int j;
+
+   for (j=0; j<D; j++)
+   {
+      z = x[j];
+      if (z > 500.0)
+      {
+         m  = 500.0 - fmod(z,500.0);
+         s += m*sin(sqrt(fabs(m))) - (z-500.0)*(z-500.0)/(10000.0*D);
+      }
+      else if (z < -500.0)
+      {
+         m  = fmod(-z,500.0) - 500.0;
+         s += m*sin(sqrt(fabs(m))) - (z+500.0)*(z+500.0)/(10000.0*D);
+      }
+      else s += z*sin(sqrt(fabs(z)));
+   }
+   return 418.9828872724339*D - s;
+}
+
+
+de_func de_funcs[] =      /* built-in test functions            */
+{
+   {"sphere",     f_sphere,     -5.12,   5.12,   0.0},
+   {"rosenbrock", f_rosenbrock, -2.048,  2.048,  1.0},
+   {"rastrigin",  f_rastrigin,  -5.12,   5.12,   0.0},
+   {"ackley",     f_ackley,     -32.768, 32.768, 0.0},
+   {"griewank",   f_griewank,   -600.0,  600.0,  0.0},
+   {"schwefel",   f_schwefel,   -500.0,  500.0,  420.9687462275036},
+   {NULL,         NULL,          0.0,    0.0,    0.0}
+};
+
+
+const de_func *de_func_find(const char *name)
+/**C*F****************************************************************
+**                                                                  **
+** Returns the entry of de_funcs[] called name, or NULL.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   for (k=0; de_funcs[k].name != NULL; k++)
+   {
+      if (strcmp(de_funcs[k].name,name) == 0) return &de_funcs[k];
+   }
+   return NULL;
+}
+
+
+de_problem *de_problem_create(const de_func *f, int D, int rotate, long seed)
+/**C*F****************************************************************
+**                                                                  **
+** Makes the shifted, and if rotate is set also rotated, variant of **
+** f in D dimensions. The rotation is the Gram-Schmidt orthonormal- **
+** ization of a matrix of normal numbers. Returns NULL if out of    **
+** memory.                                                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_problem *p;
+   de_rng rnd;
+   double *a, *b, s, u1, u2;
+   int i, j, k;
+
+   p = (de_problem *)calloc(1,sizeof(de_problem));
+   if (p == NULL) return NULL;
+   p->f = f;
+   p->D = D;
+   p->o = (double *)malloc(D*sizeof(double));
+   if (p->o == NULL)
+   {
+      free(p);
+      return NULL;
+   }
+   de_rng_init(&rnd,DE_RNG_XOSHIRO,seed,0x5eed);
+   for (j=0; j<D; j++)
+   {
+      p->o[j] = 0.1*(9*f->lo + f->hi) + 0.8*(f->hi - f->lo)*de_rng_uni(&rnd);
+   }
+   if (!rotate) return p;
+
+   p->M = (double *)malloc((size_t)D*D*sizeof(double));
+   if (p->M == NULL)
+   {
+      de_problem_free(p);
+      return NULL;
+   }
+   for (i=0; i<D; i++)
+   {
+      a = p->M + (size_t)i*D;
+      do
+      {
+         for (j=0; j<D; j++)       /* Box-Muller normal numbers */
+         {
+            u1 = 1.0 - de_rng_uni(&rnd);
+            u2 = de_rng_uni(&rnd);
+            a[j] = sqrt(-2.0*log(u1))*cos(2.0*M_PI*u2);
+         }
+         for (k=0; k<i; k++)       /* remove the earlier rows   */
+         {
+            b = p->M + (size_t)k*D;
+            for (s=0, j=0; j<D; j++) s += a[j]*b[j];
+            for (j=0; j<D; j++) a[j] -= s*b[j];
+         }
+         for (s=0, j=0; j<D; j++) s += a[j]*a[j];
+      }while(s < 1e-12);
+      s = 1.0/sqrt(s);
+      for (j=0; j<D; j++) a[j] *= s;
+   }
+   return p;
+}
+
+
+double de_problem_eval(int D, const double x[], void *user)
+/**C*F****************************************************************
+**                                                                  **
+** de_objective of a de_problem, passed as user. Thread-safe.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_problem *p = (const de_problem *)user;
+   double zs[ZSTACK], *z = zs, *y, s, r;
+   int i, j;
+
+   if (D > ZSTACK/2)
+   {
+      z = (double *)malloc(2*D*sizeof(double));
+      if (z == NULL) return HUGE_VAL;
+   }
+   if (p->M == NULL)
+   {
+      for (j=0; j<D; j++) z[j] = x[j] - p->o[j] + p->f->opt;
+   }
+   else
+   {
+      y = z + D;
+      for (j=0; j<D; j++) y[j] = x[j] - p->o[j];
+      for (i=0; i<D; i++)
+      {
+         for (s=0, j=0; j<D; j++) s += p->M[(size_t)i*D+j]*y[j];
+         z[i] = s + p->f->opt;
+      }
+   }
+   r = p->f->fn(D,z,NULL);
+   if (z != zs) free(z);
+   return r;
+}
+
+
+void de_problem_free(de_problem *p)
+/**C*F****************************************************************
+**                                                                  **
+** Releases a problem made by de_problem_create().                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (p == NULL) return;
+   free(p->o);
+   free(p->M);
+   free(p);
+}
@@ -0,0 +1,207 @@
+#ifndef DEINT_H
+#define DEINT_H
+
+/*------------------------Solver context--------------------------------*/
+/*------All state of one optimization run lives here, so that several--*/
+/*------runs can proceed concurrently on different threads. Internal---*/
+/*------to the de*.c files; users of the library only need de.h.------*/
+/*                                                                      */
+/*------The population lives in 2*cfg->NP rows of pop. slot[i] is the--*/
+/*------row of member i, tslot[i] a free row that receives its trial.--*/
+/*------Selection of a trial swaps the two indexes, so no member is----*/
+/*------ever copied. Trials only read rows in slot[], never written----*/
+/*------before selection, so generation G+1 is made from G alone.------*/
+
+typedef struct de_ckpt de_ckpt;
+typedef struct de_tracer de_tracer;
+typedef struct de_cache de_cache;
+
+typedef struct de_ctx
+{
+   const de_config *cfg;
+   de_objective fn;       /* objective function                 */
+   void  *user;           /* passed through to fn               */
+   de_rng rnd;            /* main random number stream          */
+   int   gen;             /* generation counter                 */
+   long  nfeval;          /* number of function evaluations     */
+   long  nreject;         /* trials rejected by cfg->feasible   */
+   size_t stride;         /* de_reals per population row        */
+   void  *arena;          /* single allocation holding the rest */
+   de_real *pop;          /* 2*cfg->NP rows of stride           */
+   int   *slot, *tslot;   /* rows of the members and the trials */
+   double *best;          /* best member ever                   */
+   de_real *bestit;       /* best member of the last generation */
+   double *wide;          /* DE_FLOAT: trials as doubles for the */
+   size_t wstride;        /* objective, wrows rows of wstride   */
+   int   wrows;           /* doubles for every thread           */
+   double *cost;          /* obj. funct. values                 */
+   double *tcost;         /* obj. funct. values of the trials   */
+   double *imm, *icost;   /* immigrants, cfg->nimm rows of D    */
+   int   NP;              /* current population size, <= cfg->NP */
+   double *mF, *mCR;      /* control variables of the members   */
+   double *tF, *tCR;      /* control variables of the trials    */
+   double *hF, *hCR;      /* SHADE memory, DE_ADAPT_H entries   */
+   int   hk;              /* next memory entry to replace       */
+   double *sF, *sCR, *sW; /* successful F, CR and their weights */
+   int   ns;              /* number of successes this generation */
+   double cmin;           /* best-so-far cost                   */
+   int   imin;            /* index to member with lowest energy */
+   double cmean;          /* mean cost                          */
+   double cvar;           /* cost variance                      */
+   de_pool *pool;         /* threads evaluating the trials      */
+   de_kernel kernel;      /* mutation/crossover of the strategy */
+   int   nchunk;          /* chunks handed to cfg->batch        */
+   double t0;             /* de_time() at the start of the run  */
+   long  busy_ns;         /* time spent inside the objective    */
+   de_ckpt *ckpt;         /* checkpoint writer, or NULL         */
+   de_tracer *trace;      /* trace writer, or NULL              */
+   int   stop;            /* DE_STOP_* reason, or -1 while running */
+   int   last_imp;        /* generation of the last improvement */
+   double last_cmin;      /* cmin at that generation            */
+   double *st;            /* states for cfg->delta, by row      */
+   int   full;            /* initial population: no parent      */
+                          /* states, no feasibility test        */
+   double *lo, *hi;       /* bounds of the parameters, D each   */
+   int   *tlo, *tlen;     /* changed parameters of the trials   */
+   double *ax, *acost;    /* surrogate archive, acap points     */
+   int   acap, an, apos;  /* size, points held, next to replace */
+   double *rs;            /* 1/(hi-lo), scales of the distances */
+   double *ts;            /* the trials scaled by rs, NP*D      */
+   double *pm, *ps;       /* predicted margins, a sorted copy   */
+   char  *skip;           /* trials held back by the surrogate  */
+   long  nscreen;         /* trials held back so far            */
+   double *lw;            /* workspace of the local search      */
+   int   lpol;            /* generation of the last polishing   */
+   long  nlocal;          /* evaluations spent polishing        */
+   de_cache *cache;       /* evaluation cache, or NULL          */
+   char  *cmiss;          /* trials looked up and not found     */
+   long  nhit, nmiss;     /* trials found in the cache or not   */
+#ifdef DE_PROFILE
+   de_profile prof;       /* phase totals of this run           */
+   uint64_t plast[DE_PH_N];  /* totals at the start of the generation */
+   uint64_t pgen, pt0;    /* ticks at its start and the run's   */
+   double pw0;            /* de_time() at the start             */
+   uint64_t hwlast[DE_HW_N]; /* counters at the last phase boundary   */
+   int   pfd[DE_HW_N];    /* perf_event group, or -1            */
+#endif
+} de_ctx;
+
+#define ROW(p,i)  ((p) + (size_t)(i)*x->stride)           /* row i of p           */
+#define MEM(i)    ROW(x->pop,x->slot[i])                    /* member i             */
+#define TRIAL(i)  ROW(x->pop,x->tslot[i])                   /* trial of member i    */
+#define SROW(k)   (x->st + (size_t)(k)*x->cfg->delta_state) /* state of row k       */
+
+/*------The objective is always passed doubles. With DE_FLOAT, WIDE-----*/
+/*------converts population row r into the first row of x->wide that----*/
+/*------belongs to the calling thread and returns that; otherwise WIDE--*/
+/*------is r itself.----------------------------------------------------*/
+
+#ifdef DE_FLOAT
+#define WIDE(r)   de_wide(x,r)
+#else
+#define WIDE(r)   (r)
+#endif
+
+/*------Phase profiling, see deprof.c. Without DE_PROFILE the macros----*/
+/*------expand to nothing, so the hot paths are left as they are.--------*/
+/*------DE_PROF_T declares and starts a tick count, DE_PROF_START--------*/
+/*------restarts it, DE_PROF_ADD adds the ticks since then to a phase----*/
+/*------and restarts it; safe on any thread. DE_PROF_HW adds the---------*/
+/*------hardware counters of the calling thread since its last call to--*/
+/*------a phase, DE_PROF_GEN closes a generation.------------------------*/
+
+#ifdef DE_PROFILE
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+#define de_tick()          ((uint64_t)__rdtsc())
+#else
+uint64_t de_tick(void);
+#endif
+#define DE_PROF_T(t)       uint64_t t = de_tick()
+#define DE_PROF_START(t)   (t = de_tick())
+#define DE_PROF_ADD(ph,t)  (t = de_prof_add(x,ph,t))
+#define DE_PROF_HW(ph)     de_prof_hw(x,ph)
+#define DE_PROF_GEN()      de_prof_gen(x)
+#else
+#define DE_PROF_T(t)
+#define DE_PROF_START(t)
+#define DE_PROF_ADD(ph,t)
+#define DE_PROF_HW(ph)
+#define DE_PROF_GEN()
+#endif
+
+/*------desolve.c-----------------------------------------------------------*/
+
+void  assignd(int D, double a[], const double b[]);
+void  assignr(int D, de_real a[], const de_real b[]);
+void  de_widen(int D, double a[], const de_real b[]);
+void  de_narrow(int D, de_real a[], const double b[]);
+double *de_wide(de_ctx *x, const de_real *r);
+void  de_busy(de_ctx *x, double t);
+void  de_build_trial(de_ctx *x, int i, de_rng *rnd);
+void  de_accept(de_ctx *x, int i);
+void  de_stats(de_ctx *x);
+void  de_report(de_ctx *x);
+void  de_migrate_step(de_ctx *x);
+int   de_done(de_ctx *x);
+void  de_delta_full(de_ctx *x, int i);
+
+/*------deadapt.c-----------------------------------------------------------*/
+
+void  de_adapt_init(de_ctx *x);
+void  de_adapt_sample(de_ctx *x, int i, de_rng *rnd);
+void  de_adapt_success(de_ctx *x, int i, double trial_cost, double old_cost);
+void  de_adapt_update(de_ctx *x);
+void  de_lpsr(de_ctx *x);
+
+/*------desurr.c------------------------------------------------------------*/
+
+void  de_surr_init(de_ctx *x);
+void  de_surr_add(de_ctx *x);
+void  de_surr_screen(de_ctx *x);
+
+/*------delocal.c-----------------------------------------------------------*/
+
+size_t de_local_size(const de_config *cfg);
+void  de_local_step(de_ctx *x);
+
+/*------decache.c-----------------------------------------------------------*/
+
+void  de_quantize(de_ctx *x, de_real *r, int lo, int len);
+de_cache *de_cache_create(int D, long n);
+int   de_cache_find(const de_cache *c, const de_real *r, double *cost);
+void  de_cache_put(de_cache *c, const de_real *r, double cost);
+void  de_cache_add(de_ctx *x);
+size_t de_cache_bytes(int D, long n);
+char  *de_cache_save(const de_cache *c, char *p);
+const char *de_cache_load(de_cache *c, const char *p);
+void  de_cache_free(de_cache *c);
+
+/*------deprof.c------------------------------------------------------------*/
+
+#ifdef DE_PROFILE
+uint64_t de_prof_add(de_ctx *x, int ph, uint64_t t);
+void  de_prof_hw(de_ctx *x, int ph);
+void  de_prof_gen(de_ctx *x);
+void  de_prof_start(de_ctx *x);
+void  de_prof_stop(de_ctx *x, de_profile *p);
+#endif
+
+/*------deasync.c-----------------------------------------------------------*/
+
+int   de_run_async(de_ctx *x);
+
+/*------deckpt.c------------------------------------------------------------*/
+
+int   de_ckpt_open(de_ctx *x);
+void  de_ckpt_save(de_ctx *x);
+int   de_ckpt_close(de_ctx *x);
+int   de_ckpt_load(de_ctx *x);
+
+/*------detrace.c-----------------------------------------------------------*/
+
+int   de_trace_open(de_ctx *x);
+void  de_trace_step(de_ctx *x);
+int   de_trace_close(de_ctx *x);
+
+#endif
@@ -0,0 +1,381 @@
+# include "de.h"
+# include <pthread.h>
+# include <sys/mman.h>
+# include <sys/wait.h>
+# include <unistd.h>
+
+/*------------------------Island model----------------------------------*/
+/*------K islands run de_solve() side by side, each with its own-------*/
+/*------de_config, as processes (fork) or threads. Every "every"-------*/
+/*------generations an island publishes its best member into its outbox-*/
+/*------and takes the newest best of its neighbours as immigrants.------*/
+/*------The outboxes are ring buffers in one shared memory mapping;-----*/
+/*------each slot is guarded by a sequence number (seqlock), so neither-*/
+/*------writers nor readers ever wait and no MPI is needed.-------------*/
+/*                                                                      */
+/*------Layout of the mapping, all parts DE_ALIGN aligned:--------------*/
+/*------  K outboxes:  head counter, then slots rings of                 */
+/*------               {seq, cost, x[D]}                                */
+/*------  K results:   isl_out followed by best[D]                     */
+
+typedef struct isl_out
+{
+   int    status;         /* 1 when the island finished         */
+   int    gen;
+   int    stop;           /* DE_STOP_* reason                   */
+   long   nfeval;
+   long   nrejected;
+   long   nscreened;
+   long   nlocal;
+   long   nhit, nmiss;
+   double cmin, cmean, cvar, wall;
+} isl_out;
+
+typedef struct isl_shm
+{
+   char  *base;           /* the shared mapping                 */
+   size_t len;
+   int    K, D, slots;
+   size_t box_len;        /* bytes per outbox                   */
+   size_t slot_len;       /* bytes per slot                     */
+   size_t out_len;        /* bytes per result                   */
+} isl_shm;
+
+typedef struct isl_ctx    /* private to one island              */
+{
+   isl_shm *shm;
+   const de_island_config *ic;
+   int    k;              /* number of this island              */
+   long  *last;           /* newest message read, per source    */
+   de_rng rnd;            /* for DE_TOPO_RANDOM                 */
+} isl_ctx;
+
+typedef struct isl_job    /* arguments of run_island()          */
+{
+   isl_shm *shm;
+   const de_island_config *ic;
+   const de_config *cfg;
+   de_objective fn;
+   void  *user;
+   int    k;
+} isl_job;
+
+
+char *de_topo_name[] =    /* migration topologies               */
+{
+         "ring",
+         "random",
+         "full"
+};
+
+char *de_exec_name[] =    /* how islands are run                */
+{
+         "process",
+         "thread"
+};
+
+#define ALIGNUP(n) (((n) + DE_ALIGN-1)/DE_ALIGN*DE_ALIGN)
+
+#define HEAD(s,k)   ((long *)((s)->base + (size_t)(k)*(s)->box_len))
+#define SLOT(s,k,n) ((s)->base + (size_t)(k)*(s)->box_len + DE_ALIGN + \
+                     (size_t)((n)%(s)->slots)*(s)->slot_len)
+#define SEQ(p)      ((long *)(p))
+#define SCOST(p)    ((double *)((p) + sizeof(long)))
+#define SX(p)       ((double *)((p) + sizeof(long) + sizeof(double)))
+#define OUT(s,k)    ((isl_out *)((s)->base + (size_t)(s)->K*(s)->box_len + \
+                     (size_t)(k)*(s)->out_len))
+#define OBEST(s,k)  ((double *)((char *)OUT(s,k) + ALIGNUP(sizeof(isl_out))))
+
+
+static void publish(isl_shm *s, int k, const double *best, double cmin)
+/**C*F****************************************************************
+**                                                                  **
+** Writes best into the next slot of outbox k. The sequence number  **
+** is odd while the slot is written and 2n+2 for message n after.   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   long n = __atomic_load_n(HEAD(s,k),__ATOMIC_RELAXED);
+   char *p = SLOT(s,k,n);
+
+   __atomic_store_n(SEQ(p),2*n+1,__ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   *SCOST(p) = cmin;
+   memcpy(SX(p),best,s->D*sizeof(double));
+   __atomic_store_n(SEQ(p),2*n+2,__ATOMIC_RELEASE);
+   __atomic_store_n(HEAD(s,k),n+1,__ATOMIC_RELEASE);
+}
+
+
+static int fetch(isl_ctx *c, int src, double *x, double *cost)
+/**C*F****************************************************************
+**                                                                  **
+** Copies the newest message of outbox src into x and *cost, if it  **
+** has not been read before. Returns 1 on success, 0 if there is    **
+** nothing new or the slot was overwritten while being read.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   isl_shm *s = c->shm;
+   long h, n, q1, q2;
+   char *p;
+
+   h = __atomic_load_n(HEAD(s,src),__ATOMIC_ACQUIRE);
+   n = h - 1;
+   if (n <= c->last[src]) return 0;
+   p  = SLOT(s,src,n);
+   q1 = __atomic_load_n(SEQ(p),__ATOMIC_ACQUIRE);
+   if (q1 != 2*n+2) return 0;
+   *cost = *SCOST(p);
+   memcpy(x,SX(p),s->D*sizeof(double));
+   __atomic_thread_fence(__ATOMIC_ACQUIRE);
+   q2 = __atomic_load_n(SEQ(p),__ATOMIC_RELAXED);
+   if (q1 != q2) return 0;
+   c->last[src] = n;
+   return 1;
+}
+
+
+static int migrate(int gen, int D, const double *best, double cmin,
+                   double *in, double *in_cost, int max, void *user)
+/**C*F****************************************************************
+**                                                                  **
+** de_migrate hook of an island: publishes best and fetches the     **
+** newest best of the neighbours given by the topology.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   isl_ctx *c = (isl_ctx *)user;
+   int K = c->shm->K, k = c->k;
+   int n = 0, src;
+
+   publish(c->shm,k,best,cmin);
+   if (K < 2) return 0;
+
+   if (c->ic->topology == DE_TOPO_RING)
+   {
+      n += fetch(c,(k+K-1)%K,in,in_cost);
+   }
+   else if (c->ic->topology == DE_TOPO_RANDOM)
+   {
+      src = (k + 1 + (int)(de_rng_uni(&c->rnd)*(K-1)))%K;
+      n += fetch(c,src,in,in_cost);
+   }
+   else
+   {
+      for (src=0; src<K && n<max; src++)
+      {
+         if (src != k) n += fetch(c,src,in+(size_t)n*D,in_cost+n);
+      }
+   }
+   return n;
+}
+
+
+static void *run_island(void *arg)
+/**C*F****************************************************************
+**                                                                  **
+** Runs island job->k to the end and stores its result in the       **
+** shared mapping.                                                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   isl_job *j = (isl_job *)arg;
+   isl_shm *s = j->shm;
+   isl_ctx c;
+   isl_out *o = OUT(s,j->k);
+   de_config cfg;
+   de_result res;
+   int src;
+
+   c.shm  = s;
+   c.ic   = j->ic;
+   c.k    = j->k;
+   c.last = (long *)malloc(s->K*sizeof(long));
+   if (c.last == NULL) return NULL;
+   for (src=0; src<s->K; src++) c.last[src] = -1;
+   de_rng_init(&c.rnd,DE_RNG_XOSHIRO,j->cfg->seed,0x15ad+j->k);
+
+   cfg = *j->cfg;
+   cfg.migrate       = migrate;
+   cfg.migrate_user  = &c;
+   cfg.migrate_every = j->ic->every;
+   cfg.nimm          = (j->ic->topology == DE_TOPO_FULL && s->K > 1) ? s->K-1 : 1;
+   res.best          = OBEST(s,j->k);
+
+   if (de_solve(&cfg,j->fn,j->user,&res) == DE_OK)
+   {
+      o->gen    = res.gen;
+      o->stop   = res.stop;
+      o->nfeval = res.nfeval;
+      o->nrejected = res.nrejected;
+      o->nscreened = res.nscreened;
+      o->nlocal = res.nlocal;
+      o->nhit   = res.nhit;
+      o->nmiss  = res.nmiss;
+      o->cmin   = res.cmin;
+      o->cmean  = res.cmean;
+      o->cvar   = res.cvar;
+      o->wall   = res.wall;
+      __atomic_store_n(&o->status,1,__ATOMIC_RELEASE);
+   }
+   free(c.last);
+   return NULL;
+}
+
+
+int de_islands(const de_island_config *ic, const de_config cfg[],
+               de_objective fn, void *user, de_result res[], de_result *total)
+/**C*F****************************************************************
+**                                                                  **
+** SRC-FUNCTION   :de_islands()                                     **
+** LONG_NAME      :island model driver                              **
+**                                                                  **
+** DESCRIPTION    :runs ic->K islands, island k with cfg[k], and    **
+**                 migrates best members every ic->every genera-    **
+**                 tions along ic->topology. All cfg[k] must have   **
+**                 the same D.                                      **
+**                                                                  **
+** PARAMETERS     :ic              island settings                  **
+**                 cfg             K solver configurations          **
+**                 fn, user        objective function and its data  **
+**                 res             K per-island results             **
+**                 total           best of all islands, NFEs summed **
+**                                                                  **
+** POSTCONDITIONS :returns DE_OK, DE_EINVAL, DE_ENOMEM, or DE_EFAIL **
+**                 if an island did not finish.                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char msg[128];
+   isl_shm s;
+   isl_job *job;
+   pthread_t *tid;
+   pid_t *pid;
+   isl_out *o;
+   double t0;
+   int k, b, ret = DE_OK;
+
+   if (ic->K <= 0 || ic->every <= 0 || ic->slots <= 0) return DE_EINVAL;
+   if (ic->topology < DE_TOPO_RING || ic->topology > DE_TOPO_FULL) return DE_EINVAL;
+   for (k=0; k<ic->K; k++)
+   {
+      if (de_check(&cfg[k],msg,sizeof(msg)) != DE_OK) return DE_EINVAL;
+      if (cfg[k].D != cfg[0].D) return DE_EINVAL;
+   }
+
+/*-----Shared mapping, inherited by the island processes-------------*/
+
+   s.K        = ic->K;
+   s.D        = cfg[0].D;
+   s.slots    = ic->slots;
+   s.slot_len = ALIGNUP(sizeof(long) + sizeof(double) + s.D*sizeof(double));
+   s.box_len  = DE_ALIGN + (size_t)s.slots*s.slot_len;
+   s.out_len  = ALIGNUP(sizeof(isl_out)) + ALIGNUP(s.D*sizeof(double));
+   s.len      = (size_t)s.K*(s.box_len + s.out_len);
+   s.base     = (char *)mmap(NULL,s.len,PROT_READ|PROT_WRITE,
+                             MAP_SHARED|MAP_ANONYMOUS,-1,0);
+   if (s.base == MAP_FAILED) return DE_ENOMEM;
+
+   job = (isl_job *)calloc(ic->K,sizeof(isl_job));
+   tid = (pthread_t *)calloc(ic->K,sizeof(pthread_t));
+   pid = (pid_t *)calloc(ic->K,sizeof(pid_t));
+   if (job == NULL || tid == NULL || pid == NULL)
+   {
+      free(job); free(tid); free(pid);
+      munmap(s.base,s.len);
+      return DE_ENOMEM;
+   }
+
+/*-----Start the islands and wait for them-----------------------------*/
+
+   t0 = de_time();
+   for (k=0; k<ic->K; k++)
+   {
+      job[k].shm  = &s;
+      job[k].ic   = ic;
+      job[k].cfg  = &cfg[k];
+      job[k].fn   = fn;
+      job[k].user = user;
+      job[k].k    = k;
+      if (ic->exec == DE_ISLAND_THREAD)
+      {
+         if (pthread_create(&tid[k],NULL,run_island,&job[k]) != 0) pid[k] = -1;
+      }
+      else
+      {
+         fflush(NULL);         /* do not duplicate buffered output */
+         pid[k] = fork();
+         if (pid[k] == 0)
+         {
+            run_island(&job[k]);
+            _exit(0);
+         }
+      }
+   }
+   for (k=0; k<ic->K; k++)
+   {
+      if (pid[k] < 0) continue;
+      if (ic->exec == DE_ISLAND_THREAD) pthread_join(tid[k],NULL);
+      else waitpid(pid[k],NULL,0);
+   }
+
+/*-----Collect per-island and aggregate results-----------------------*/
+
+   b = -1;
+   total->nfeval = 0;
+   total->nrejected = 0;
+   total->nscreened = 0;
+   total->nlocal = 0;
+   total->nhit   = 0;
+   total->nmiss  = 0;
+   total->gen    = 0;
+   for (k=0; k<ic->K; k++)
+   {
+      o = OUT(&s,k);
+      if (__atomic_load_n(&o->status,__ATOMIC_ACQUIRE) != 1)
+      {
+         ret = DE_EFAIL;
+         continue;
+      }
+      res[k].cmin   = o->cmin;
+      res[k].gen    = o->gen;
+      res[k].stop   = o->stop;
+      res[k].nfeval = o->nfeval;
+      res[k].nrejected = o->nrejected;
+      res[k].nscreened = o->nscreened;
+      res[k].nlocal = o->nlocal;
+      res[k].nhit   = o->nhit;
+      res[k].nmiss  = o->nmiss;
+      res[k].cmean  = o->cmean;
+      res[k].cvar   = o->cvar;
+      res[k].wall   = o->wall;
+      res[k].evals_per_sec = (o->wall > 0) ? o->nfeval/o->wall : 0;
+      res[k].utilization   = 0;
+      if (res[k].best != NULL) memcpy(res[k].best,OBEST(&s,k),s.D*sizeof(double));
+      total->nfeval += o->nfeval;
+      total->nrejected += o->nrejected;
+      total->nscreened += o->nscreened;
+      total->nlocal += o->nlocal;
+      total->nhit   += o->nhit;
+      total->nmiss  += o->nmiss;
+      if (o->gen > total->gen) total->gen = o->gen;
+      if (b < 0 || o->cmin < OUT(&s,b)->cmin) b = k;
+   }
+   total->wall = de_time() - t0;
+   total->evals_per_sec = (total->wall > 0) ? total->nfeval/total->wall : 0;
+   total->utilization   = 0;
+   if (b >= 0)
+   {
+      total->cmin  = OUT(&s,b)->cmin;
+      total->cmean = OUT(&s,b)->cmean;
+      total->cvar  = OUT(&s,b)->cvar;
+      total->stop  = OUT(&s,b)->stop;
+      if (total->best != NULL) memcpy(total->best,OBEST(&s,b),s.D*sizeof(double));
+   }
+   else ret = DE_EFAIL;
+
+   free(job); free(tid); free(pid);
+   munmap(s.base,s.len);
+   return ret;
+}
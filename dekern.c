@@ -0,0 +1,145 @@
+# include "de.h"
+
+/*------------------------Mutation/crossover kernels--------------------*/
+/*------Every DE/x/y/z strategy is its own function, generated from-----*/
+/*------the mutation formula by the macros below and picked once per----*/
+/*------run from de_kernels[]. The random numbers are drawn in the------*/
+/*------same order as in the original loops, so results are unchanged.--*/
+/*                                                                      */
+/*------Exponential crossover changes L consecutive parameters starting-*/
+/*------at n, wrapping around at D: at most two contiguous spans.-------*/
+/*------Binomial crossover blends mutant and target over the whole row--*/
+/*------with a mask from a block of uniforms; the loops carry no--------*/
+/*------dependencies, so the compiler vectorizes them.------------------*/
+
+#define KB  256           /* uniforms drawn per block for bin   */
+
+
+/*=======Choice of strategy===============================================================*/
+/*=======We have tried to come up with a sensible naming-convention: DE/x/y/z=============*/
+/*=======DE :  stands for Differential Evolution==========================================*/
+/*=======x  :  a string which denotes the vector to be perturbed==========================*/
+/*=======y  :  number of difference vectors taken for perturbation of x===================*/
+/*=======z  :  crossover method (exp = exponential, bin = binomial)=======================*/
+/*                                                                                        */
+/*=======There are some simple rules which are worth following:===========================*/
+/*=======1)  F is usually between 0.5 and 1 (in rare cases > 1)===========================*/
+/*=======2)  CR is between 0 and 1 with 0., 0.3, 0.7 and 1. being worth to be tried first=*/
+/*=======3)  To start off NP = 10*D is a reasonable choice. Increase NP if misconvergence=*/
+/*           happens.                                                                     */
+/*=======4)  If you increase NP, F usually has to be decreased============================*/
+/*=======5)  When the DE/best... schemes fail DE/rand... usually works and vice versa=====*/
+
+/*-------DE/best/1: our oldest strategy but still not bad. However, we have found--------*/
+/*-------several optimization problems where misconvergence occurs.----------------------*/
+#define MUT_BEST1(j)   (bestit[j] + F*(p2[j]-p3[j]))
+/*-------DE/rand/1: one of my favourite strategies. It works especially well when the----*/
+/*-------"bestit[]"-schemes experience misconvergence. Try e.g. F=0.7 and CR=0.5---------*/
+/*-------as a first guess.---------------------------------------------------------------*/
+#define MUT_RAND1(j)   (p1[j] + F*(p2[j]-p3[j]))
+/*-------DE/rand-to-best/1 seems to be one of the best strategies. Try F=0.85 and CR=1.--*/
+/*-------If you get misconvergence try to increase NP. If this doesn't help you----------*/
+/*-------should play around with all three control variables.----------------------------*/
+#define MUT_RTB1(j)    (old[j] + F*(bestit[j] - old[j]) + F*(p1[j]-p2[j]))
+/*-------DE/best/2 is another powerful strategy worth trying-----------------------------*/
+#define MUT_BEST2(j)   (bestit[j] + (p1[j]+p2[j]-p3[j]-p4[j])*F)
+/*-------DE/rand/2 seems to be a robust optimizer for many functions---------------------*/
+#define MUT_RAND2(j)   (p5[j] + (p1[j]+p2[j]-p3[j]-p4[j])*F)
+
+
+#define KERNEL_VARS                                                   \
+   int    D  = t->D;                                                  \
+   de_real F = (de_real)t->F;  /* arithmetic in the row precision */  \
+   double CR = t->CR;                                                 \
+   const de_real *restrict old    = t->old;                           \
+   const de_real *restrict bestit = t->bestit;                        \
+   const de_real *restrict p1 = t->p1, *restrict p2 = t->p2;          \
+   const de_real *restrict p3 = t->p3, *restrict p4 = t->p4;          \
+   const de_real *restrict p5 = t->p5;                                \
+   de_real *restrict tmp = t->tmp;                                    \
+   (void)CR; (void)old; (void)bestit;                                 \
+   (void)p1; (void)p2; (void)p3; (void)p4; (void)p5
+
+/*-------Exponential crossover: draw the start n and the length L first,------------------*/
+/*-------then copy the target outside [n,n+L) and the mutant inside.-----------------------*/
+#define DEFINE_EXP(name, MUT)                                         \
+static void name(de_trial *t, de_rng *rnd)                            \
+{                                                                     \
+   KERNEL_VARS;                                                       \
+   int n, L, e, j;                                                    \
+                                                                      \
+   n = (int)(de_rng_uni(rnd)*D);                                      \
+   L = 0;                                                             \
+   do                                                                 \
+   {                                                                  \
+      L++;                                                            \
+   }while((de_rng_uni(rnd) < CR) && (L < D));                         \
+   e = n + L;                                                         \
+   if (e <= D)                /* one span [n,e)          */           \
+   {                                                                  \
+      memcpy(tmp,old,n*sizeof(de_real));                              \
+      for (j=n; j<e; j++) tmp[j] = MUT(j);                            \
+      memcpy(tmp+e,old+e,(D-e)*sizeof(de_real));                      \
+   }                                                                  \
+   else                       /* spans [n,D) and [0,e-D) */           \
+   {                                                                  \
+      e -= D;                                                         \
+      for (j=0; j<e; j++) tmp[j] = MUT(j);                            \
+      memcpy(tmp+e,old+e,(n-e)*sizeof(de_real));                      \
+      for (j=n; j<D; j++) tmp[j] = MUT(j);                            \
+   }                                                                  \
+   t->lo  = n;                                                        \
+   t->len = L;                                                        \
+}
+
+/*-------Binomial crossover: the k-th uniform decides parameter (n+k)%D.------------------*/
+/*-------Parameter (n+D-1)%D is always changed (change at least one parameter).-----------*/
+#define DEFINE_BIN(name, MUT)                                         \
+static void name(de_trial *t, de_rng *rnd)                            \
+{                                                                     \
+   KERNEL_VARS;                                                       \
+   double u[KB];                                                      \
+   int n, k0, b, j0, m, j;                                            \
+                                                                      \
+   n = (int)(de_rng_uni(rnd)*D);                                      \
+   for (k0=0; k0<D; k0+=KB)                                           \
+   {                                                                  \
+      b = (D-k0 < KB) ? D-k0 : KB;                                    \
+      de_rng_fill(rnd,u,b);                                           \
+      j0 = n + k0;                                                    \
+      if (j0 >= D) j0 -= D;                                           \
+      m = (D-j0 < b) ? D-j0 : b;                                      \
+      for (j=0; j<m; j++)                                             \
+         tmp[j0+j] = (u[j] < CR) ? MUT(j0+j) : old[j0+j];             \
+      for (j=0; j<b-m; j++)                                           \
+         tmp[j] = (u[m+j] < CR) ? MUT(j) : old[j];                    \
+   }                                                                  \
+   j = (n == 0) ? D-1 : n-1;                                          \
+   tmp[j] = MUT(j);                                                   \
+   t->lo  = 0;                                                        \
+   t->len = D;                                                        \
+}
+
+/*=======EXPONENTIAL CROSSOVER============================================================*/
+
+DEFINE_EXP(best1exp, MUT_BEST1)     /* 1: DE/best/1/exp, DE0 (not in our paper)  */
+DEFINE_EXP(rand1exp, MUT_RAND1)     /* 2: DE/rand/1/exp, DE1 in the techreport   */
+DEFINE_EXP(rtb1exp,  MUT_RTB1)      /* 3: DE/rand-to-best/1/exp, similiar to DE2 */
+DEFINE_EXP(best2exp, MUT_BEST2)     /* 4: DE/best/2/exp                          */
+DEFINE_EXP(rand2exp, MUT_RAND2)     /* 5: DE/rand/2/exp                          */
+
+/*=======Essentially same strategies but BINOMIAL CROSSOVER===============================*/
+
+DEFINE_BIN(best1bin, MUT_BEST1)     /* 6: DE/best/1/bin                          */
+DEFINE_BIN(rand1bin, MUT_RAND1)     /* 7: DE/rand/1/bin                          */
+DEFINE_BIN(rtb1bin,  MUT_RTB1)      /* 8: DE/rand-to-best/1/bin                  */
+DEFINE_BIN(best2bin, MUT_BEST2)     /* 9: DE/best/2/bin                          */
+DEFINE_BIN(rand2bin, MUT_RAND2)     /* 10: DE/rand/2/bin                         */
+
+
+de_kernel de_kernels[] =  /* indexed by strategy, 0 acts as 10  */
+{
+         rand2bin,
+         best1exp, rand1exp, rtb1exp, best2exp, rand2exp,
+         best1bin, rand1bin, rtb1bin, best2bin, rand2bin
+};
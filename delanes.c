@@ -0,0 +1,701 @@
+# include "de.h"
+
+/*------------------------Lane-batched runs-----------------------------*/
+/*------de_lanes() solves many small independent problems at once. The--*/
+/*------runs are taken DE_LANES at a time into a group, and a group------*/
+/*------keeps all of them in one structure of arrays: parameter j of-----*/
+/*------member i of run r is X[(i*D + j)*DE_LANES + r], coordinate-------*/
+/*------major with the runs in the lanes. Drawing, mutation, crossover,--*/
+/*------boundary handling, selection and the cost statistics then go-----*/
+/*------over the lanes in the innermost loops, which the compiler turns--*/
+/*------into vector instructions, and the loop overhead is paid once per-*/
+/*------group instead of once per run. Only the objective is called per--*/
+/*------run, on the row gathered into doubles.---------------------------*/
+/*                                                                      */
+/*------Every run draws from its own xoshiro256+ lane, seeded from its---*/
+/*------cfg->seed, and draws the same number of uniforms per trial------*/
+/*------whatever it finds: the members by sampling without replacement,-*/
+/*------the length of an exponential crossover by inverting its---------*/
+/*------geometric distribution. So a run ends with the same result in---*/
+/*------any group, at any position and on any number of threads, though-*/
+/*------not with the one of de_solve(), which draws differently. A run---*/
+/*------that has stopped keeps its lane but is no longer evaluated or----*/
+/*------selected; the group ends with its last run, so runs of similar---*/
+/*------length are best batched together.-------------------------------*/
+
+#define W  DE_LANES
+
+typedef struct lane_grp
+{
+   const de_config *c[W]; /* configuration of every lane        */
+   de_objective fn;
+   void  *user[W];        /* passed through to fn, per lane     */
+   int    n;              /* runs in the group, the lanes after */
+                          /* them only fill the vectors         */
+   int    D, NP;
+   int    m;              /* members drawn per trial            */
+   int    bound;          /* DE_BOUND_* of the group            */
+   void  *arena;          /* single allocation holding the rest */
+   de_real *X, *T;        /* members and trials, NP*D*W         */
+   de_real *B;            /* best member of every run, D*W      */
+   de_real *lo, *hi;      /* bounds, D*W                        */
+   de_real *mk;           /* crossover mask of a trial, 0 or 1, */
+                          /* D*W                                */
+   double *cost, *tcost;  /* costs of members and trials, NP*W  */
+   double *x;             /* row handed to the objective, D     */
+   uint64_t s[4][W];      /* xoshiro256+ state, word-major      */
+   de_real F[W];          /* weight factor of every run         */
+   double CR[W];          /* crossing over factor of every run  */
+   const de_real *p[5][W]; /* members r1..r5 of the trial, per lane */
+   double cmin[W], cmean[W], cvar[W];
+   double last_cmin[W];   /* cmin at the last improvement       */
+   long   nfe[W];         /* function evaluations of every run  */
+   int    gen[W], last_imp[W];
+   int    stop[W];        /* DE_STOP_* reason, or -1            */
+   int    run[W];         /* 1 while the run is going on        */
+   double t0, busy;       /* start, time inside the objective   */
+} lane_grp;
+
+typedef void (*lane_kernel)(int D, const de_real *O, const de_real *B,
+                            const de_real *const *p, const de_real *F,
+                            const de_real *mk, de_real *T);
+
+typedef struct lane_job   /* arguments of lane_task()           */
+{
+   int    R;
+   const de_config *cfg;
+   de_objective fn;
+   void  *const *user;
+   de_result *res;
+   int   *ret;            /* return code of every group         */
+} lane_job;
+
+
+/*-------The mutation formulas of dekern.c, for lane r of parameter j: q is----------------*/
+/*-------the index of (j,r) in a D*W block, jw = j*W the offset in a member.-------------*/
+#define LMUT_BEST1  (B[q] + F[r]*(p2[r][jw]-p3[r][jw]))
+#define LMUT_RAND1  (p1[r][jw] + F[r]*(p2[r][jw]-p3[r][jw]))
+#define LMUT_RTB1   (O[q] + F[r]*(B[q] - O[q]) + F[r]*(p1[r][jw]-p2[r][jw]))
+#define LMUT_BEST2  (B[q] + (p1[r][jw]+p2[r][jw]-p3[r][jw]-p4[r][jw])*F[r])
+#define LMUT_RAND2  (p5[r][jw] + (p1[r][jw]+p2[r][jw]-p3[r][jw]-p4[r][jw])*F[r])
+
+/*-------Writes trial T as mutant where the mask is 1 and member O where it is 0. The----*/
+/*-------blend is arithmetic, exact for finite rows, and all pointers are restrict------*/
+/*-------parameters: gcc -O2 vectorizes neither ?: nor loops it has to check for-------*/
+/*-------aliasing. p holds the members r1..r5 of every lane, W per member.--------------*/
+#define DEFINE_LANE(name, MUT)                                        \
+static void name(int D, const de_real *restrict O,                    \
+                 const de_real *restrict B, const de_real *const *p,  \
+                 const de_real *restrict F, const de_real *restrict mk,\
+                 de_real *restrict T)                                 \
+{                                                                     \
+   const de_real *const *p1 = p,     *const *p2 = p + W;              \
+   const de_real *const *p3 = p+2*W, *const *p4 = p + 3*W;            \
+   const de_real *const *p5 = p+4*W;                                  \
+   int    j, r;                                                       \
+   size_t jw, q;                                                      \
+   de_real v;                                                         \
+   (void)O; (void)B;                                                  \
+   (void)p1; (void)p2; (void)p3; (void)p4; (void)p5;                  \
+                                                                      \
+   for (j=0; j<D; j++)                                                \
+   {                                                                  \
+      jw = (size_t)j*W;                                               \
+      for (r=0; r<W; r++)                                             \
+      {                                                               \
+         q    = jw + r;                                               \
+         v    = (de_real)(MUT);                                       \
+         T[q] = mk[q]*v + (1 - mk[q])*O[q];                           \
+      }                                                               \
+   }                                                                  \
+}
+
+DEFINE_LANE(lane_best1, LMUT_BEST1)
+DEFINE_LANE(lane_rand1, LMUT_RAND1)
+DEFINE_LANE(lane_rtb1,  LMUT_RTB1)
+DEFINE_LANE(lane_best2, LMUT_BEST2)
+DEFINE_LANE(lane_rand2, LMUT_RAND2)
+
+static lane_kernel lane_kernels[] =  /* indexed by strategy, 0 acts as 10 */
+{
+         lane_rand2,
+         lane_best1, lane_rand1, lane_rtb1, lane_best2, lane_rand2,
+         lane_best1, lane_rand1, lane_rtb1, lane_best2, lane_rand2
+};
+
+static int lane_draws[] = /* members r1..rm a strategy reads    */
+{
+         5,
+         3, 3, 2, 4, 5,
+         3, 3, 2, 4, 5
+};
+
+
+static void lane_step(lane_grp *g, double u[W])
+/**C*F****************************************************************
+**                                                                  **
+** Advances the xoshiro256+ lane of every run by one step and puts  **
+** a uniform in [0,1) per lane into u; the top 52 bits become the   **
+** mantissa of a number in [1,2), so no integer conversion is       **
+** needed and the loop vectorizes.                                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t *s0 = g->s[0], *s1 = g->s[1], *s2 = g->s[2], *s3 = g->s[3];
+   union { uint64_t i; double d; } b[W];
+   uint64_t t;
+   int r;
+
+   for (r=0; r<W; r++)
+   {
+      b[r].i = ((s0[r] + s3[r]) >> 12) | 0x3ff0000000000000ULL;
+      t      = s1[r] << 17;
+      s2[r] ^= s0[r];
+      s3[r] ^= s1[r];
+      s1[r] ^= s2[r];
+      s0[r] ^= s3[r];
+      s2[r] ^= t;
+      s3[r]  = (s3[r] << 45) | (s3[r] >> 19);
+   }
+   for (r=0; r<W; r++)
+   {
+      u[r] = b[r].d - 1.0;
+   }
+}
+
+
+static void lane_draw(lane_grp *g, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Draws for trial i in every lane: the members r1..rm, distinct    **
+** and different from i, and the crossover mask. Always takes m+2   **
+** steps for exponential and m+1+D for binomial crossover.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = g->D, NP = g->NP, m = g->m;
+   double v[W];
+   int    ex[6][W];           /* i and the members so far, sorted */
+   int    a[W], n[W], L[W];
+   int    r, k, e, t, j;
+   size_t jw;
+
+   for (r=0; r<W; r++) ex[0][r] = i;
+   for (k=0; k<m; k++)         /* the a-th of the NP-1-k left      */
+   {
+      lane_step(g,v);
+      for (r=0; r<W; r++) a[r] = (int)(v[r]*(NP-1-k));
+      for (e=0; e<=k; e++)
+      {
+         for (r=0; r<W; r++) a[r] += (a[r] >= ex[e][r]);
+      }
+      for (r=0; r<W; r++) g->p[k][r] = g->X + (size_t)a[r]*D*W + r;
+      for (e=0; e<=k; e++)     /* insert a, keeping ex sorted      */
+      {
+         for (r=0; r<W; r++)
+         {
+            t        = ex[e][r];
+            ex[e][r] = (t < a[r]) ? t : a[r];
+            a[r]     = (t < a[r]) ? a[r] : t;
+         }
+      }
+      for (r=0; r<W; r++) ex[k+1][r] = a[r];
+   }
+
+   lane_step(g,v);
+   for (r=0; r<W; r++) n[r] = (int)(v[r]*D);
+   if (g->c[0]->strategy >= 1 && g->c[0]->strategy <= 5)
+   {
+      lane_step(g,v);          /* L from P(L >= k) = CR^(k-1)      */
+      for (r=0; r<W; r++)
+      {
+         if (g->CR[r] >= 1)     L[r] = D;
+         else if (g->CR[r] <= 0) L[r] = 1;
+         else L[r] = 1 + (int)fmin(floor(log(1.0 - v[r])/log(g->CR[r])),D-1);
+      }
+      for (j=0; j<D; j++)      /* parameters n..n+L-1 mod D        */
+      {
+         jw = (size_t)j*W;
+         for (r=0; r<W; r++)
+         {
+            g->mk[jw+r] = (de_real)(((j >= n[r]) & (j < n[r]+L[r])) |
+                                    (j < n[r]+L[r]-D));
+         }
+      }
+   }
+   else
+   {
+      for (r=0; r<W; r++) n[r] = (n[r] == 0) ? D-1 : n[r]-1;
+      for (j=0; j<D; j++)      /* parameter n-1 mod D always       */
+      {
+         jw = (size_t)j*W;
+         lane_step(g,v);
+         for (r=0; r<W; r++)
+         {
+            g->mk[jw+r] = (de_real)((v[r] < g->CR[r]) | (j == n[r]));
+         }
+      }
+   }
+}
+
+
+static void lane_bound(lane_grp *g, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Brings trial i of every lane back into the bounds, by clamping   **
+** or reflecting. Parameters taken from the member are within them  **
+** already and stay as they are.                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t  k, N = (size_t)g->D*W;
+   de_real *restrict T = g->T + (size_t)i*N;
+   const de_real *restrict lo = g->lo, *restrict hi = g->hi;
+   de_real v;
+
+   if (g->bound == DE_BOUND_REFLECT)
+   {
+      for (k=0; k<N; k++)
+      {
+         v    = T[k];
+         v    = (v < lo[k]) ? 2*lo[k] - v : (v > hi[k]) ? 2*hi[k] - v : v;
+         T[k] = v;
+      }
+   }
+   for (k=0; k<N; k++)        /* clamp whatever is left */
+   {
+      v    = T[k];
+      T[k] = (v < lo[k]) ? lo[k] : (v > hi[k]) ? hi[k] : v;
+   }
+}
+
+
+static void lane_eval(lane_grp *g, const de_real *P, double *cost)
+/**C*F****************************************************************
+**                                                                  **
+** Evaluates the NP rows of block P for every run that is going on, **
+** into cost[i*W + r].                                              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = g->D, i, j, r;
+   double t = de_time();
+
+   for (i=0; i<g->NP; i++)
+   {
+      for (r=0; r<g->n; r++)
+      {
+         if (!g->run[r]) continue;
+         for (j=0; j<D; j++) g->x[j] = P[((size_t)i*D + j)*W + r];
+         cost[(size_t)i*W + r] = g->fn(D,g->x,g->user[r]);
+         g->nfe[r]++;
+      }
+   }
+   g->busy += de_time() - t;
+}
+
+
+static void lane_take(int D, de_real *restrict O, de_real *restrict B,
+                      const de_real *restrict T, const de_real *restrict acc,
+                      const de_real *restrict nb)
+/**C*F****************************************************************
+**                                                                  **
+** Copies trial T into member O in the lanes where acc is 1 and     **
+** into the best members B where nb is 1, blended like the kernels. **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    j, r;
+   size_t jw, q;
+
+   for (j=0; j<D; j++)
+   {
+      jw = (size_t)j*W;
+      for (r=0; r<W; r++)
+      {
+         q    = jw + r;
+         O[q] = acc[r]*T[q] + (1 - acc[r])*O[q];
+         B[q] = nb[r]*T[q]  + (1 - nb[r])*B[q];
+      }
+   }
+}
+
+
+static void lane_select(lane_grp *g)
+/**C*F****************************************************************
+**                                                                  **
+** Selection in member order for every lane at once: a trial at     **
+** least as good replaces its member, a new minimum the best.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = g->D, i, r;
+   de_real acc[W], nb[W];       /* 1 where the trial is taken */
+   double *C, *TC;
+   int    any;
+
+   for (i=0; i<g->NP; i++)
+   {
+      C  = g->cost  + (size_t)i*W;
+      TC = g->tcost + (size_t)i*W;
+      any = 0;
+      for (r=0; r<W; r++)
+      {
+         acc[r] = g->run[r] && TC[r] <= C[r];
+         nb[r]  = acc[r] && TC[r] < g->cmin[r];
+         C[r]   = acc[r] ? TC[r] : C[r];
+         g->cmin[r] = nb[r] ? TC[r] : g->cmin[r];
+         any   |= (acc[r] != 0);
+      }
+      if (any) lane_take(D,g->X + (size_t)i*D*W,g->B,g->T + (size_t)i*D*W,acc,nb);
+   }
+}
+
+
+static void lane_stats(lane_grp *g)
+/**C*F****************************************************************
+**                                                                  **
+** Mean and variance of the member costs, for every lane.           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    NP = g->NP, i, r;
+   double d;
+
+   for (r=0; r<W; r++) g->cmean[r] = g->cvar[r] = 0.;
+   for (i=0; i<NP; i++)
+   {
+      for (r=0; r<W; r++) g->cmean[r] += g->cost[(size_t)i*W + r];
+   }
+   for (r=0; r<W; r++) g->cmean[r] /= NP;
+   for (i=0; i<NP; i++)
+   {
+      for (r=0; r<W; r++)
+      {
+         d = g->cost[(size_t)i*W + r] - g->cmean[r];
+         g->cvar[r] += d*d;
+      }
+   }
+   for (r=0; r<W; r++) g->cvar[r] /= (NP-1);
+}
+
+
+static int lane_done(lane_grp *g, int r)
+/**C*F****************************************************************
+**                                                                  **
+** The stop conditions of de_done() for run r. Returns nonzero and  **
+** sets g->stop[r] if the run is to end.                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = g->c[r];
+
+   if (g->cmin[r] < g->last_cmin[r])
+   {
+      g->last_cmin[r] = g->cmin[r];
+      g->last_imp[r]  = g->gen[r];
+   }
+   if (cfg->stop != NULL && *cfg->stop)                  g->stop[r] = DE_STOP_USER;
+   else if (g->cmin[r] <= cfg->vtr)                      g->stop[r] = DE_STOP_VTR;
+   else if (cfg->max_nfeval > 0 && g->nfe[r] >= cfg->max_nfeval)
+                                                         g->stop[r] = DE_STOP_NFEVAL;
+   else if (cfg->max_wall > 0 && de_time()-g->t0 >= cfg->max_wall)
+                                                         g->stop[r] = DE_STOP_WALL;
+   else if (cfg->cvar_min > 0 && g->cvar[r] < cfg->cvar_min)
+                                                         g->stop[r] = DE_STOP_CVAR;
+   else if (cfg->stall > 0 && g->gen[r]-g->last_imp[r] >= cfg->stall)
+                                                         g->stop[r] = DE_STOP_STALL;
+   else if (g->gen[r] >= cfg->genmax)                    g->stop[r] = DE_STOP_GENMAX;
+   return g->stop[r] >= 0;
+}
+
+
+static int lane_alloc(lane_grp *g)
+/**C*F****************************************************************
+**                                                                  **
+** Carves the group's arrays out of one DE_ALIGN aligned block.     **
+** Returns DE_OK or DE_ENOMEM.                                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t N = (size_t)g->D*W, P = (size_t)g->NP*N;
+   size_t nr = (2*P + 4*N)*sizeof(de_real);
+   size_t nd = (2*(size_t)g->NP*W + g->D)*sizeof(double);
+   char  *a;
+
+   if ((size_t)g->NP > ((size_t)-1)/8/sizeof(double)/N) return DE_ENOMEM;
+   nr = (nr + DE_ALIGN-1)/DE_ALIGN*DE_ALIGN;
+   nd = (nd + DE_ALIGN-1)/DE_ALIGN*DE_ALIGN;
+   if (posix_memalign((void **)&a,DE_ALIGN,nr + nd) != 0) return DE_ENOMEM;
+   g->arena = a;
+   g->X     = (de_real *)a;       /* X,T,B,lo,hi,mk */
+   g->T     = g->X + P;
+   g->B     = g->T + P;
+   g->lo    = g->B + N;
+   g->hi    = g->lo + N;
+   g->mk    = g->hi + N;
+   g->cost  = (double *)(a + nr); /* cost,tcost,x */
+   g->tcost = g->cost + (size_t)g->NP*W;
+   g->x     = g->tcost + (size_t)g->NP*W;
+   return DE_OK;
+}
+
+
+static void lane_init(lane_grp *g)
+/**C*F****************************************************************
+**                                                                  **
+** Seeds the lanes, spreads the initial members within the bounds,  **
+** evaluates them and finds the best member of every run.           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg;
+   int    D = g->D, NP = g->NP, i, j, r, w;
+   double u[W], l, h;
+   size_t q;
+   de_rng seed;
+
+   for (r=0; r<W; r++)
+   {
+      cfg = g->c[r];
+      de_rng_init(&seed,DE_RNG_XOSHIRO,cfg->seed,0);
+      for (w=0; w<4; w++) g->s[w][r] = seed.s[w][0];
+      g->F[r]  = (de_real)cfg->F;
+      g->CR[r] = cfg->CR;
+      for (j=0; j<D; j++)
+      {
+         g->lo[(size_t)j*W + r] = (de_real)((cfg->lo != NULL) ? cfg->lo[j] : cfg->inibound_l);
+         g->hi[(size_t)j*W + r] = (de_real)((cfg->hi != NULL) ? cfg->hi[j] : cfg->inibound_h);
+      }
+      g->nfe[r]  = 0;
+      g->gen[r]  = 0;
+      g->stop[r] = -1;
+      g->run[r]  = (r < g->n);
+   }
+   for (i=0; i<NP; i++)
+   {
+      for (j=0; j<D; j++)
+      {
+         lane_step(g,u);
+         for (r=0; r<W; r++)
+         {
+            cfg = g->c[r];
+            l = (cfg->lo != NULL) ? cfg->lo[j] : cfg->inibound_l;
+            h = (cfg->hi != NULL) ? cfg->hi[j] : cfg->inibound_h;
+            g->X[((size_t)i*D + j)*W + r] = (de_real)(l + u[r]*(h - l));
+         }
+      }
+   }
+   memset(g->cost,0,(size_t)NP*W*sizeof(double));
+   lane_eval(g,g->X,g->cost);
+   for (r=0; r<W; r++)
+   {
+      w = 0;
+      for (i=1; i<NP; i++)
+      {
+         if (g->cost[(size_t)i*W + r] < g->cost[(size_t)w*W + r]) w = i;
+      }
+      g->cmin[r] = g->cost[(size_t)w*W + r];
+      for (j=0; j<D; j++)
+      {
+         q = (size_t)j*W + r;
+         g->B[q] = g->X[(size_t)w*D*W + q];
+      }
+      g->last_cmin[r] = g->cmin[r];
+      g->last_imp[r]  = 0;
+   }
+   memcpy(g->tcost,g->cost,(size_t)NP*W*sizeof(double));
+   lane_stats(g);
+}
+
+
+static void lane_task(void *arg, int k)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: solves group k, runs k*W.. of the job, and writes     **
+** their results.                                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   lane_job *job = (lane_job *)arg;
+   lane_grp g;
+   lane_kernel kernel;
+   de_result *res;
+   double  *best, wall;
+   int     i, j, r, b = k*W, alive;
+
+   memset(&g,0,sizeof(g));
+   g.n  = (job->R - b < W) ? job->R - b : W;
+   g.fn = job->fn;
+   for (r=0; r<W; r++)         /* empty lanes copy the first run */
+   {
+      g.c[r]    = &job->cfg[b + ((r < g.n) ? r : 0)];
+      g.user[r] = (job->user != NULL && r < g.n) ? job->user[b+r] : NULL;
+   }
+   g.D     = g.c[0]->D;
+   g.NP    = g.c[0]->NP;
+   g.m     = lane_draws[g.c[0]->strategy];
+   g.bound = g.c[0]->bound;
+   kernel  = lane_kernels[g.c[0]->strategy];
+   if ((job->ret[k] = lane_alloc(&g)) != DE_OK) return;
+   g.t0 = de_time();
+
+   lane_init(&g);
+
+/*=======A generation of the group: the runs that are still going on====*/
+/*=======count it, the trials of all lanes are built and the ones of the*/
+/*=======running lanes evaluated and selected, as in run_sync().========*/
+
+   for (;;)
+   {
+      alive = 0;
+      for (r=0; r<g.n; r++)
+      {
+         if (g.run[r] && lane_done(&g,r)) g.run[r] = 0;
+         alive += g.run[r];
+      }
+      if (alive == 0) break;
+      for (r=0; r<g.n; r++) g.gen[r] += g.run[r];
+
+      for (i=0; i<g.NP; i++)
+      {
+         lane_draw(&g,i);
+         kernel(g.D,g.X + (size_t)i*g.D*W,g.B,&g.p[0][0],g.F,g.mk,
+                g.T + (size_t)i*g.D*W);
+         if (g.bound != DE_BOUND_NONE) lane_bound(&g,i);
+      }
+      lane_eval(&g,g.T,g.tcost);
+      lane_select(&g);
+      lane_stats(&g);
+   }
+
+   wall = de_time() - g.t0;
+   for (r=0; r<g.n; r++)
+   {
+      res  = &job->res[b+r];
+      best = res->best;
+      memset(res,0,sizeof(*res));
+      res->best   = best;
+      res->cmin   = g.cmin[r];
+      res->gen    = g.gen[r];
+      res->nfeval = g.nfe[r];
+      res->cmean  = g.cmean[r];
+      res->cvar   = g.cvar[r];
+      res->stop   = g.stop[r];
+      res->wall   = wall;
+      res->evals_per_sec = (wall > 0) ? g.nfe[r]/wall : 0;
+      res->utilization   = (wall > 0) ? g.busy/wall : 0;
+      for (j=0; best != NULL && j<g.D; j++) best[j] = g.B[(size_t)j*W + r];
+   }
+   free(g.arena);
+}
+
+
+static int lane_check(const de_config *cfg, const de_config *c0)
+/**C*F****************************************************************
+**                                                                  **
+** Accepts cfg for de_lanes() if de_check() does, it agrees with    **
+** the first run c0 on what a group shares, and it asks for nothing **
+** the lanes do not support.                                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char msg[128];
+
+   if (de_check(cfg,msg,sizeof(msg)) != DE_OK) return DE_EINVAL;
+   if (cfg->D != c0->D || cfg->NP != c0->NP || cfg->strategy != c0->strategy ||
+       cfg->bound != c0->bound)
+   {
+      return DE_EINVAL;
+   }
+   if (cfg->NP <= lane_draws[cfg->strategy] || cfg->rng != DE_RNG_XOSHIRO ||
+       cfg->mode != DE_MODE_SYNC || cfg->bound == DE_BOUND_BOUNCE ||
+       cfg->bound == DE_BOUND_REINIT)
+   {
+      return DE_EINVAL;
+   }
+   if (cfg->batch != NULL || cfg->monitor != NULL || cfg->migrate != NULL ||
+       cfg->checkpoint != NULL || cfg->trace != NULL || cfg->delta != NULL ||
+       cfg->feasible != NULL || cfg->init_pop != NULL || cfg->final_pop != NULL ||
+       cfg->quant != NULL)
+   {
+      return DE_EINVAL;
+   }
+   if (cfg->adapt != DE_ADAPT_NONE || cfg->np_min != 0 || cfg->surr_k != 0 ||
+       cfg->local != DE_LOCAL_NONE || cfg->cache != 0)
+   {
+      return DE_EINVAL;
+   }
+   return DE_OK;
+}
+
+
+int de_lanes(int R, const de_config cfg[], de_objective fn, void *const user[],
+             de_result res[])
+/**C*F****************************************************************
+**                                                                  **
+** SRC-FUNCTION   :de_lanes()                                       **
+** LONG_NAME      :lane-batched runs                                **
+**                                                                  **
+** DESCRIPTION    :solves R independent problems, run r with cfg[r] **
+**                 and fn(D,x,user[r]), DE_LANES runs per group as  **
+**                 described at the top of delanes.c. The groups    **
+**                 are solved side by side on cfg[0].threads        **
+**                 threads; fn must then be thread-safe. Each run   **
+**                 stops on its own conditions and gets its own     **
+**                 result; wall and utilization are those of its    **
+**                 group. Results do not depend on R, the order of  **
+**                 the runs or threads.                             **
+**                                                                  **
+** PARAMETERS     :R               number of runs                   **
+**                 cfg             R solver configurations          **
+**                 fn              objective function               **
+**                 user            R pointers passed to fn, or NULL **
+**                 res             R results                        **
+**                                                                  **
+** PRECONDITIONS  :all cfg[r] have the same D, NP, strategy and     **
+**                 bound, bound none, clamp or reflect, rng         **
+**                 DE_RNG_XOSHIRO, NP larger than the members the   **
+**                 strategy draws, sync mode and none of batch,     **
+**                 monitor, migrate, checkpoint, trace, delta,      **
+**                 feasible, init_pop, final_pop, quant, adapt,     **
+**                 np_min, surr_k, local or cache. res[r].best is   **
+**                 NULL or points to D doubles.                     **
+**                                                                  **
+** POSTCONDITIONS :returns DE_OK and fills res, DE_EINVAL or        **
+**                 DE_ENOMEM.                                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   lane_job job;
+   de_pool *pool = NULL;
+   int    k, ng, ret = DE_OK;
+
+   if (R <= 0 || fn == NULL) return DE_EINVAL;
+   for (k=0; k<R; k++)
+   {
+      if (lane_check(&cfg[k],&cfg[0]) != DE_OK) return DE_EINVAL;
+   }
+   ng = (R + W-1)/W;
+   job.R    = R;
+   job.cfg  = cfg;
+   job.fn   = fn;
+   job.user = user;
+   job.res  = res;
+   job.ret  = (int *)calloc(ng,sizeof(int));
+   if (job.ret == NULL) return DE_ENOMEM;
+   if (cfg[0].threads > 1 && ng > 1 &&
+       (pool = de_pool_create((cfg[0].threads < ng) ? cfg[0].threads : ng)) == NULL)
+   {
+      free(job.ret);
+      return DE_ENOMEM;
+   }
+   de_pool_run(pool,ng,lane_task,&job);
+   for (k=0; k<ng; k++)
+   {
+      if (job.ret[k] != DE_OK) ret = job.ret[k];
+   }
+   de_pool_free(pool);
+   free(job.ret);
+   return ret;
+}
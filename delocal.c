@@ -0,0 +1,605 @@
+# include "de.h"
+# include "deint.h"
+# include <float.h>
+
+/*------------------------Local search polishing------------------------*/
+/*------With cfg->local set, every cfg->local_every generations, and----*/
+/*------after cfg->local_stall generations without improvement, the----*/
+/*------best member is polished by a derivative-free local search of at-*/
+/*------most cfg->local_budget evaluations: Nelder-Mead, a coordinate---*/
+/*------pattern search or L-BFGS on forward-difference gradients. Its---*/
+/*------steps start from the spread of the population in every---------*/
+/*------parameter. With cfg->bound set the points are clamped into the--*/
+/*------bounds; cfg->feasible is asked about each and rejected ones get-*/
+/*------cost HUGE_VAL. Points are evaluated in blocks on the threads of-*/
+/*------the run, so the search is as deterministic as the generations.-*/
+/*------If the result beats the best member, it replaces that member.---*/
+/*------Its evaluations count in nfeval and x->nlocal. Synchronous mode-*/
+/*------only: the population must stand still while it runs.-----------*/
+/*                                                                      */
+/*------Workspace x->lw, de_local_size() doubles: the delta states of---*/
+/*------the threads, the scales and the point being polished, then the--*/
+/*------rows of the method.---------------------------------------------*/
+
+#define LOCAL_ROWS  64    /* points evaluated at once           */
+#define LOCAL_M     5     /* pairs kept by L-BFGS               */
+#define LOCAL_ARMIJO 1e-4 /* sufficient decrease of L-BFGS      */
+
+char *de_local_name[] =   /* local searches, DE_LOCAL_*         */
+{
+         "none",
+         "nm",
+         "pattern",
+         "lbfgs"
+};
+
+typedef struct local_job  /* points handed to the threads       */
+{
+   de_ctx *x;
+   const double *P;       /* n rows of D                        */
+   double *c;             /* receives their costs               */
+   int    n, nchunk;
+   long   nrej;           /* rows cfg->feasible rejected        */
+} local_job;
+
+
+size_t de_local_size(const de_config *cfg)
+/**C*F****************************************************************
+**                                                                  **
+** Doubles of workspace the local search of cfg needs.              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t D = (size_t)cfg->D, n;
+
+   switch (cfg->local)
+   {
+      case DE_LOCAL_NONE:    return 0;
+      case DE_LOCAL_NM:      n = (D+1)*(D+1) + 4*D;
+                             break;
+      case DE_LOCAL_PATTERN: n = LOCAL_ROWS*(D+1) + 3*D;
+                             break;
+      default:               n = 2*LOCAL_M*(D+1) + 4*D + LOCAL_ROWS*(D+1);
+                             break;
+   }
+   if (cfg->delta != NULL) n += (size_t)cfg->threads*cfg->delta_state;
+   return n + 2*D;
+}
+
+
+static void local_task(void *arg, int k)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: evaluates chunk k of the rows of the job. Rows that   **
+** cfg->feasible rejects split the chunk into runs for cfg->batch,  **
+** as in evaluate_chunk(). A cost of NaN becomes HUGE_VAL, so that  **
+** the comparisons of the searches stay meaningful.                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   local_job *b = (local_job *)arg;
+   de_ctx *x = b->x;
+   const de_config *cfg = x->cfg;
+   int    D = cfg->D, i, r;
+   int    lo = (int)((long)k*b->n/b->nchunk), hi = (int)((long)(k+1)*b->n/b->nchunk);
+   double *st = x->lw + (size_t)de_pool_self(x->pool)*cfg->delta_state;
+   double t = de_time();
+
+   for (i=lo; i<hi; i++)
+   {
+      b->c[i] = (cfg->feasible == NULL ||
+                 cfg->feasible(D,b->P+(size_t)i*D,cfg->feasible_user)) ? 0 : HUGE_VAL;
+   }
+   for (i=lo; i<hi; i=r)
+   {
+      for (r=i; r<hi && b->c[r] == 0; r++)
+      {
+         if (cfg->batch != NULL) continue;
+         b->c[r] = (cfg->delta != NULL) ? cfg->delta(D,b->P+(size_t)r*D,0,D,NULL,st,x->user)
+                                        : x->fn(D,b->P+(size_t)r*D,x->user);
+      }
+      if (r > i && cfg->batch != NULL) cfg->batch(D,r-i,b->P+(size_t)i*D,D,b->c+i,x->user);
+      if (r == i)
+      {
+         __atomic_fetch_add(&b->nrej,1,__ATOMIC_RELAXED);
+         r++;
+      }
+   }
+   for (i=lo; i<hi; i++)
+   {
+      if (isnan(b->c[i])) b->c[i] = HUGE_VAL;
+   }
+   de_busy(x,t);
+}
+
+
+static long local_eval(de_ctx *x, int n, const double *P, double *c)
+/**C*F****************************************************************
+**                                                                  **
+** Evaluates the n rows of D doubles P into c, one chunk per        **
+** thread, counts them and returns n.                               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   local_job b;
+
+   b.x      = x;
+   b.P      = P;
+   b.c      = c;
+   b.n      = n;
+   b.nrej   = 0;
+   b.nchunk = de_pool_size(x->pool);
+   if (b.nchunk > n) b.nchunk = n;
+   de_pool_run(x->pool,b.nchunk,local_task,&b);
+   x->nfeval  += n - b.nrej;
+   x->nlocal  += n - b.nrej;
+   x->nreject += b.nrej;
+   return n;
+}
+
+
+static void clamp(de_ctx *x, double *p)
+/**C*F****************************************************************
+**                                                                  **
+** Clamps p into the bounds if cfg->bound is set.                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j;
+
+   if (x->cfg->bound == DE_BOUND_NONE) return;
+   for (j=0; j<x->cfg->D; j++)
+   {
+      p[j] = (p[j] < x->lo[j]) ? x->lo[j] : (p[j] > x->hi[j]) ? x->hi[j] : p[j];
+   }
+}
+
+
+static void simplex_sum(int D, const double *S, double *sum)
+/**C*F****************************************************************
+**                                                                  **
+** Sums the D+1 rows of the simplex S into sum.                     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i, j;
+
+   for (j=0; j<D; j++) sum[j] = 0;
+   for (i=0; i<=D; i++)
+   {
+      for (j=0; j<D; j++) sum[j] += S[(size_t)i*D+j];
+   }
+}
+
+
+static double nelder_mead(de_ctx *x, const double *sc, double *p, double fp,
+                          long budget)
+/**C*F****************************************************************
+**                                                                  **
+** Nelder-Mead with the usual coefficients 1, 2, 1/2, 1/2, started  **
+** from p and steps sc along the axes. The sum of the vertexes is   **
+** kept up to date, so that a step costs O(D) besides evaluations;  **
+** the first simplex and shrinks are evaluated as one block. Ends   **
+** when the costs of the simplex agree to rounding or the budget is **
+** spent; needs a budget > D. Leaves the best vertex in p and       **
+** returns its cost.                                                **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = x->cfg->D, i, j, h, s, l, nrep = 0;
+   double *S   = p + D;                   /* D+1 vertexes          */
+   double *fs  = S + (size_t)(D+1)*D;     /* their costs           */
+   double *sum = fs + D+1, *c = sum + D, *xr = c + D, *xe = xr + D;
+   double *r, fr, fe, v;
+   long   used;
+
+   if (budget <= D) return fp;
+   assignd(D,S,p);
+   fs[0] = fp;
+   for (i=1; i<=D; i++)
+   {
+      r = S + (size_t)i*D;
+      assignd(D,r,p);
+      r[i-1] = p[i-1] + sc[i-1];
+      clamp(x,r);
+      if (r[i-1] == p[i-1]) r[i-1] = p[i-1] - sc[i-1];
+      clamp(x,r);
+   }
+   used = local_eval(x,D,S+D,fs+1);
+   simplex_sum(D,S,sum);
+
+   while (used < budget)
+   {
+      l = h = 0;
+      for (i=1; i<=D; i++)
+      {
+         if (fs[i] < fs[l]) l = i;
+         if (fs[i] > fs[h]) h = i;
+      }
+      s = (h == 0) ? 1 : 0;
+      for (i=0; i<=D; i++)
+      {
+         if (i != h && fs[i] > fs[s]) s = i;
+      }
+      if (fs[h] - fs[l] <= 4*DBL_EPSILON*fabs(fs[l])) break;
+
+      r = S + (size_t)h*D;
+      for (j=0; j<D; j++)     /* centroid of the others, reflection */
+      {
+         c[j]  = (sum[j] - r[j])/D;
+         xr[j] = 2*c[j] - r[j];
+      }
+      clamp(x,xr);
+      used += local_eval(x,1,xr,&fr);
+      fe = HUGE_VAL;
+      if (fr < fs[l])         /* try to expand                       */
+      {
+         for (j=0; j<D; j++) xe[j] = c[j] + 2*(xr[j] - c[j]);
+         clamp(x,xe);
+         if (used < budget) used += local_eval(x,1,xe,&fe);
+         if (!(fe < fr))
+         {
+            assignd(D,xe,xr);
+            fe = fr;
+         }
+      }
+      else if (fr < fs[s])    /* take the reflection                 */
+      {
+         assignd(D,xe,xr);
+         fe = fr;
+      }
+      else if (used < budget) /* contract outside or inside          */
+      {
+         for (j=0; j<D; j++) xe[j] = c[j] + 0.5*(((fr < fs[h]) ? xr[j] : r[j]) - c[j]);
+         clamp(x,xe);
+         used += local_eval(x,1,xe,&fe);
+         if (!(fe < ((fr < fs[h]) ? fr : fs[h]))) fe = HUGE_VAL;
+         if (fe == HUGE_VAL)  /* shrink towards the best vertex      */
+         {
+            if (used + D > budget) break;
+            for (j=0; j<D && l != 0; j++)
+            {
+               v = S[j];
+               S[j] = S[(size_t)l*D+j];
+               S[(size_t)l*D+j] = v;
+            }
+            v = fs[0];
+            fs[0] = fs[l];
+            fs[l] = v;
+            for (i=1; i<=D; i++)
+            {
+               for (j=0; j<D; j++) S[(size_t)i*D+j] = S[j] + 0.5*(S[(size_t)i*D+j] - S[j]);
+            }
+            used += local_eval(x,D,S+D,fs+1);
+            simplex_sum(D,S,sum);
+            continue;
+         }
+      }
+      if (fe == HUGE_VAL) break;
+      for (j=0; j<D; j++)     /* the new point replaces the worst    */
+      {
+         sum[j] += xe[j] - r[j];
+         r[j] = xe[j];
+      }
+      fs[h] = fe;
+      if (++nrep > D)         /* against drift of the sum            */
+      {
+         simplex_sum(D,S,sum);
+         nrep = 0;
+      }
+   }
+
+   l = 0;
+   for (i=1; i<=D; i++)
+   {
+      if (fs[i] < fs[l]) l = i;
+   }
+   assignd(D,p,S+(size_t)l*D);
+   return fs[l];
+}
+
+
+static double pattern(de_ctx *x, const double *sc, double *p, double fp,
+                      long budget)
+/**C*F****************************************************************
+**                                                                  **
+** Coordinate pattern search: polls p +- step[j] along every axis,  **
+** LOCAL_ROWS points at a time, and keeps the best improving move   **
+** of every parameter. All of them together give one more point;    **
+** p moves there if that beats the best single move, otherwise to   **
+** the latter. The steps of the parameters without improvement are  **
+** halved. Ends when no step changes p any more or the budget is    **
+** spent. Returns the cost of p.                                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = x->cfg->D, n, k, q, j, b, moved;
+   int    dir[LOCAL_ROWS];
+   double *step = p + D, *xn = step + D, *cj = xn + D;
+   double *R = cj + D, *rc = R + (size_t)LOCAL_ROWS*D, *r, fn;
+   long   used = 0;
+
+   assignd(D,step,sc);
+   while (used < budget)
+   {
+      assignd(D,xn,p);
+      for (j=0; j<D; j++) cj[j] = fp;
+      for (q=0; q<2*D && used < budget; )
+      {
+         for (n=0; q<2*D && n < LOCAL_ROWS && n < budget-used; q++)
+         {
+            j = q/2;
+            r = R + (size_t)n*D;
+            assignd(D,r,p);
+            r[j] = (q & 1) ? p[j] - step[j] : p[j] + step[j];
+            clamp(x,r);
+            if (r[j] == p[j]) continue;
+            dir[n++] = q;
+         }
+         if (n > 0) used += local_eval(x,n,R,rc);
+         for (k=0; k<n; k++)    /* best move of every parameter      */
+         {
+            j = dir[k]/2;
+            if (rc[k] < cj[j])
+            {
+               cj[j] = rc[k];
+               xn[j] = R[(size_t)k*D+j];
+            }
+         }
+      }
+
+      for (b=-1, moved=0, j=0; j<D; j++)
+      {
+         if (cj[j] < fp)
+         {
+            moved++;
+            if (b < 0 || cj[j] < cj[b]) b = j;
+         }
+         else step[j] *= 0.5;
+      }
+      if (moved > 1 && used < budget)   /* all moves at once    */
+      {
+         used += local_eval(x,1,xn,&fn);
+         if (fn < cj[b])
+         {
+            assignd(D,p,xn);
+            fp = fn;
+            continue;
+         }
+      }
+      if (moved > 0)
+      {
+         p[b] = xn[b];
+         fp   = cj[b];
+         continue;
+      }
+      for (k=j=0; j<D; j++)
+      {
+         if (p[j] + step[j] != p[j] || p[j] - step[j] != p[j]) k = 1;
+      }
+      if (k == 0) break;
+   }
+   return fp;
+}
+
+
+static long gradient(de_ctx *x, const double *p, double fp, double *g,
+                     double *R, double *rc)
+/**C*F****************************************************************
+**                                                                  **
+** Forward-difference gradient of the cost at p, which is fp, into  **
+** g; in blocks of LOCAL_ROWS points in R. Near the upper bound the **
+** difference is taken backwards. Parameters whose cost is not      **
+** finite get 0. Returns the D evaluations used.                    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = x->cfg->D, n, k, j0;
+   double h[LOCAL_ROWS], *r;
+   long   used = 0;
+
+   for (j0=0; j0<D; j0+=n)
+   {
+      n = (D-j0 < LOCAL_ROWS) ? D-j0 : LOCAL_ROWS;
+      for (k=0; k<n; k++)
+      {
+         r = R + (size_t)k*D;
+         assignd(D,r,p);
+         h[k] = sqrt(DBL_EPSILON)*((fabs(p[j0+k]) > 1) ? fabs(p[j0+k]) : 1);
+         if (x->cfg->bound != DE_BOUND_NONE && p[j0+k] + h[k] > x->hi[j0+k]) h[k] = -h[k];
+         r[j0+k] = p[j0+k] + h[k];
+         h[k]    = r[j0+k] - p[j0+k];    /* the step actually taken */
+      }
+      used += local_eval(x,n,R,rc);
+      for (k=0; k<n; k++)
+      {
+         g[j0+k] = (isfinite(rc[k]) && isfinite(fp)) ? (rc[k] - fp)/h[k] : 0;
+      }
+   }
+   return used;
+}
+
+
+static double dot(int D, const double *a, const double *b)
+/**C*F****************************************************************
+**                                                                  **
+** Scalar product of a and b.                                       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double s = 0;
+   int j;
+
+   for (j=0; j<D; j++) s += a[j]*b[j];
+   return s;
+}
+
+
+static double lbfgs(de_ctx *x, const double *sc, double *p, double fp,
+                    long budget)
+/**C*F****************************************************************
+**                                                                  **
+** L-BFGS with the last LOCAL_M pairs and a backtracking line       **
+** search for sufficient decrease, on gradients from gradient().    **
+** The first step has the length of the scales. The memory is       **
+** dropped when its direction goes uphill or its line search fails. **
+** Ends when no step decreases the cost any more or the next        **
+** gradient does not fit into the budget. Returns the cost of p.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = x->cfg->D, m = 0, km = 0, i, k, j, ok;
+   double *S = p + D, *Y = S + (size_t)LOCAL_M*D, *rho = Y + (size_t)LOCAL_M*D;
+   double *al = rho + LOCAL_M, *g = al + LOCAL_M, *gn = g + D, *d = gn + D;
+   double *xn = d + D, *R = xn + D, *rc = R + (size_t)LOCAL_ROWS*D, *tmp;
+   double gd, t, fn, sy, b;
+   long   used;
+
+   if (budget <= D) return fp;
+   used = gradient(x,p,fp,g,R,rc);
+   while (used < budget)
+   {
+      assignd(D,d,g);           /* two-loop recursion, newest first */
+      for (k=0; k<m; k++)
+      {
+         i = (km - 1 - k + LOCAL_M)%LOCAL_M;
+         al[i] = rho[i]*dot(D,S+(size_t)i*D,d);
+         for (j=0; j<D; j++) d[j] -= al[i]*Y[(size_t)i*D+j];
+      }
+      if (m > 0)
+      {
+         i = (km - 1 + LOCAL_M)%LOCAL_M;
+         t = 1/(rho[i]*dot(D,Y+(size_t)i*D,Y+(size_t)i*D));
+      }
+      else
+      {
+         t = sqrt(dot(D,d,d));
+         t = (t > 0) ? sqrt(dot(D,sc,sc))/t : 0;
+      }
+      for (j=0; j<D; j++) d[j] *= t;
+      for (k=m-1; k>=0; k--)
+      {
+         i = (km - 1 - k + LOCAL_M)%LOCAL_M;
+         b = rho[i]*dot(D,Y+(size_t)i*D,d);
+         for (j=0; j<D; j++) d[j] += (al[i] - b)*S[(size_t)i*D+j];
+      }
+      for (j=0; j<D; j++) d[j] = -d[j];
+      gd = dot(D,g,d);
+      if (!(gd < 0))
+      {
+         if (m == 0) break;
+         m = 0;
+         continue;
+      }
+
+      for (ok=0, t=1; !ok && used < budget; t*=0.5)
+      {
+         for (j=0; j<D; j++) xn[j] = p[j] + t*d[j];
+         clamp(x,xn);
+         for (k=j=0; j<D; j++)
+         {
+            if (xn[j] != p[j]) k = 1;
+         }
+         if (k == 0) break;    /* the step vanished                */
+         used += local_eval(x,1,xn,&fn);
+         ok = (fn <= fp + LOCAL_ARMIJO*t*gd && fn < fp);
+      }
+      if (!ok)
+      {
+         if (m == 0) break;
+         m = 0;
+         continue;
+      }
+      if (used + D > budget)
+      {
+         assignd(D,p,xn);
+         fp = fn;
+         break;
+      }
+      used += gradient(x,xn,fn,gn,R,rc);
+      for (j=0; j<D; j++)       /* s = xn - p, y = gn - g          */
+      {
+         S[(size_t)km*D+j] = xn[j] - p[j];
+         Y[(size_t)km*D+j] = gn[j] - g[j];
+      }
+      sy = dot(D,S+(size_t)km*D,Y+(size_t)km*D);
+      if (sy > 0)               /* keeps the update positive definite */
+      {
+         rho[km] = 1/sy;
+         km = (km+1)%LOCAL_M;
+         if (m < LOCAL_M) m++;
+      }
+      assignd(D,p,xn);
+      fp  = fn;
+      tmp = g;
+      g   = gn;
+      gn  = tmp;
+   }
+   return fp;
+}
+
+
+void de_local_step(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Polishes best[] after a generation if it is due, and lets the    **
+** result replace the best member if it is better. The budget is    **
+** cut to what is left of cfg->max_nfeval.                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   int    D = cfg->D, NP = x->NP, i, j, b;
+   int    last = (x->last_imp > x->lpol) ? x->last_imp : x->lpol;
+   long   budget;
+   double *sc, *p, fp, m, v;
+
+   if (cfg->local == DE_LOCAL_NONE) return;
+   if (!((cfg->local_every > 0 && x->gen%cfg->local_every == 0) ||
+         (cfg->local_stall > 0 && x->gen - last >= cfg->local_stall))) return;
+   x->lpol = x->gen;
+   budget  = (cfg->local_budget > 0) ? cfg->local_budget : DE_LOCAL_BUDGET*(D+1L);
+   if (cfg->max_nfeval > 0 && cfg->max_nfeval - x->nfeval < budget)
+   {
+      budget = cfg->max_nfeval - x->nfeval;
+   }
+   if (budget <= 0) return;
+
+   sc = x->lw + ((cfg->delta != NULL) ? (size_t)cfg->threads*cfg->delta_state : 0);
+   p  = sc + D;
+   for (j=0; j<D; j++)       /* spread of the population          */
+   {
+      m = v = 0;
+      for (i=0; i<NP; i++) m += MEM(i)[j];
+      m /= NP;
+      for (i=0; i<NP; i++) v += (MEM(i)[j] - m)*(MEM(i)[j] - m);
+      sc[j] = sqrt(v/NP);
+      if (!(sc[j] > 0)) sc[j] = 1e-3*(x->hi[j] - x->lo[j]);
+      if (!(sc[j] > 0)) sc[j] = 1e-3*((fabs(x->best[j]) > 1) ? fabs(x->best[j]) : 1);
+   }
+   assignd(D,p,x->best);
+   clamp(x,p);
+
+   switch (cfg->local)
+   {
+      case DE_LOCAL_NM:      fp = nelder_mead(x,sc,p,x->cmin,budget);
+                             break;
+      case DE_LOCAL_PATTERN: fp = pattern(x,sc,p,x->cmin,budget);
+                             break;
+      default:               fp = lbfgs(x,sc,p,x->cmin,budget);
+                             break;
+   }
+   if (!(fp < x->cmin)) return;
+
+   for (b=0, i=1; i<NP; i++)   /* the best member gives way        */
+   {
+      if (x->cost[i] < x->cost[b]) b = i;
+   }
+   de_narrow(D,MEM(b),p);
+   x->cost[b] = fp;
+   if (cfg->delta != NULL) de_delta_full(x,b);
+   x->cmin = fp;
+   x->imin = b;
+   de_widen(D,x->best,MEM(b));
+   assignr(D,x->bestit,MEM(b));
+}
@@ -0,0 +1,283 @@
+# include "de.h"
+# include "deint.h"
+
+/*------------------------Phase profiling-------------------------------*/
+/*------Compiled with -DDE_PROFILE, the solver counts the ticks spent---*/
+/*------in each phase of a generation, DE_PH_SAMPLE..DE_PH_OTHER, with--*/
+/*------the time stamp counter (CLOCK_MONOTONIC ns where there is none),*/
+/*------summed over the threads that do the work, and the wall ticks----*/
+/*------of every generation. Per phase a histogram of the ticks of one--*/
+/*------generation, in powers of two, shows whether the time is spread-*/
+/*------evenly or goes to a few slow generations. On Linux the cycles,--*/
+/*------instructions and cache misses of the calling thread are read----*/
+/*------from perf_event at the boundaries of the passes of a synchronous*/
+/*------generation; sampling and mutation are one pass there. The------*/
+/*------initial population is not included. Without DE_PROFILE this----*/
+/*------file is empty and the macros in deint.h expand to nothing.------*/
+
+#ifdef DE_PROFILE
+
+# include <string.h>
+# include <time.h>
+# include <unistd.h>
+#ifdef __linux__
+# include <linux/perf_event.h>
+# include <sys/ioctl.h>
+# include <sys/syscall.h>
+#endif
+
+char *de_phase_name[] =   /* phases, DE_PH_*                    */
+{
+         "sample",
+         "mutate",
+         "eval",
+         "select",
+         "stats",
+         "other",
+         "generation"
+};
+
+static char *hw_name[] =  /* hardware counters                  */
+{
+         "cycles",
+         "instructions",
+         "cache-misses"
+};
+
+
+#if !defined(__x86_64__) && !defined(__i386__)
+uint64_t de_tick(void)
+/**C*F****************************************************************
+**                                                                  **
+** Nanoseconds on a monotonic clock, where there is no time stamp   **
+** counter to read.                                                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+   return (uint64_t)ts.tv_sec*1000000000u + ts.tv_nsec;
+}
+#endif
+
+
+uint64_t de_prof_add(de_ctx *x, int ph, uint64_t t)
+/**C*F****************************************************************
+**                                                                  **
+** Adds the ticks since t to phase ph and returns the current tick. **
+** May be called from several threads at once.                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t now = de_tick();
+
+   __atomic_fetch_add(&x->prof.tick[ph],now-t,__ATOMIC_RELAXED);
+   return now;
+}
+
+
+static int hw_read(de_ctx *x, uint64_t v[DE_HW_N])
+/**C*F****************************************************************
+**                                                                  **
+** Reads the hardware counters of the group into v. Returns 0, or   **
+** -1 if there are none.                                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t g[1+DE_HW_N];   /* number of counters, then the values */
+
+   if (x->pfd[0] < 0 || read(x->pfd[0],g,sizeof(g)) != (ssize_t)sizeof(g)) return -1;
+   memcpy(v,g+1,sizeof(g)-sizeof(g[0]));
+   return 0;
+}
+
+
+void de_prof_hw(de_ctx *x, int ph)
+/**C*F****************************************************************
+**                                                                  **
+** Adds the hardware counts of the calling thread since the last    **
+** call to phase ph.                                                **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t v[DE_HW_N];
+   int k;
+
+   if (hw_read(x,v) != 0) return;
+   for (k=0; k<DE_HW_N; k++)
+   {
+      x->prof.hwc[ph][k] += v[k] - x->hwlast[k];
+      x->hwlast[k] = v[k];
+   }
+}
+
+
+void de_prof_gen(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Ends a generation: adds its wall ticks to DE_PH_GEN and enters   **
+** the ticks of every phase during it into the histograms.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t now = de_tick(), d;
+   int ph, b;
+
+   x->prof.tick[DE_PH_GEN] += now - x->pgen;
+   x->pgen = now;
+   for (ph=0; ph<DE_PH_N; ph++)
+   {
+      d = x->prof.tick[ph] - x->plast[ph];
+      x->plast[ph] = x->prof.tick[ph];
+      b = (d > 0) ? 63 - __builtin_clzll(d) : 0;
+      x->prof.hist[ph][b]++;
+   }
+}
+
+
+static void hw_open(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Opens the hardware counters of the calling thread as one group,  **
+** user space only. Leaves pfd[0] at -1 if the kernel, the machine  **
+** or perf_event_paranoid does not allow it.                        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+#ifdef __linux__
+   static const uint64_t event[DE_HW_N] =
+   {
+      PERF_COUNT_HW_CPU_CYCLES,
+      PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES
+   };
+   struct perf_event_attr a;
+   int k;
+
+   for (k=0; k<DE_HW_N; k++)
+   {
+      memset(&a,0,sizeof(a));
+      a.size           = sizeof(a);
+      a.type           = PERF_TYPE_HARDWARE;
+      a.config         = event[k];
+      a.disabled       = (k == 0);   /* the group starts with its leader */
+      a.exclude_kernel = 1;
+      a.exclude_hv     = 1;
+      a.read_format    = PERF_FORMAT_GROUP;
+      x->pfd[k] = (int)syscall(SYS_perf_event_open,&a,0,-1,
+                               (k == 0) ? -1 : x->pfd[0],0);
+      if (x->pfd[k] < 0)
+      {
+         while (k-- > 0)
+         {
+            close(x->pfd[k]);
+            x->pfd[k] = -1;
+         }
+         return;
+      }
+   }
+   ioctl(x->pfd[0],PERF_EVENT_IOC_ENABLE,PERF_IOC_FLAG_GROUP);
+#endif
+}
+
+
+void de_prof_start(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Starts profiling the iteration loop of x from zero. Hardware     **
+** counters are only read in the synchronous mode.                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   memset(&x->prof,0,sizeof(x->prof));
+   memset(x->plast,0,sizeof(x->plast));
+   for (k=0; k<DE_HW_N; k++) x->pfd[k] = -1;
+   if (x->cfg->mode == DE_MODE_SYNC) hw_open(x);  /* passes of a generation */
+   x->prof.hw = (hw_read(x,x->hwlast) == 0);
+   x->pw0  = de_time();
+   x->pt0  = de_tick();
+   x->pgen = x->pt0;
+}
+
+
+void de_prof_stop(de_ctx *x, de_profile *p)
+/**C*F****************************************************************
+**                                                                  **
+** Ends profiling, measures the ticks per second over the run and   **
+** copies the totals to p.                                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double w = de_time() - x->pw0;
+   int k;
+
+   x->prof.hz = (w > 0) ? (de_tick() - x->pt0)/w : 0;
+   for (k=0; k<DE_HW_N; k++)
+   {
+      if (x->pfd[k] >= 0) close(x->pfd[k]);
+   }
+   *p = x->prof;
+}
+
+
+void de_profile_print(FILE *fp, const de_profile *p)
+/**C*F****************************************************************
+**                                                                  **
+** Writes the totals per phase, their share of the wall ticks of    **
+** all generations and the ticks per generation, the hardware       **
+** counters if there were any, and the histograms.                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double all = (double)p->tick[DE_PH_GEN];
+   long   ngen = 0;
+   int    ph, k, b;
+
+   for (b=0; b<DE_HIST; b++) ngen += p->hist[DE_PH_GEN][b];
+   if (ngen == 0) return;
+   fprintf(fp,"\n Profile: %ld generations, %.4g Mticks/s, ticks summed over threads\n",
+           ngen,1e-6*p->hz);
+   fprintf(fp," %-11s %12s %7s %12s\n","phase","Mticks","share","ticks/gen");
+   for (ph=0; ph<DE_PH_N; ph++)
+   {
+      fprintf(fp," %-11s %12.4f %6.1f%% %12.0f\n",de_phase_name[ph],
+              1e-6*p->tick[ph],(all > 0) ? 100.0*p->tick[ph]/all : 0.0,
+              (double)p->tick[ph]/ngen);
+   }
+
+   if (p->hw)
+   {
+      fprintf(fp,"\n Counters of the calling thread (sample: with mutate)\n");
+      fprintf(fp," %-11s","phase");
+      for (k=0; k<DE_HW_N; k++) fprintf(fp," %14s",hw_name[k]);
+      fprintf(fp," %6s\n","IPC");
+      for (ph=DE_PH_MUTATE; ph<DE_PH_GEN; ph++)
+      {
+         fprintf(fp," %-11s",de_phase_name[ph]);
+         for (k=0; k<DE_HW_N; k++) fprintf(fp," %14.0f",(double)p->hwc[ph][k]);
+         fprintf(fp," %6.2f\n",(p->hwc[ph][0] > 0) ?
+                 (double)p->hwc[ph][1]/p->hwc[ph][0] : 0.0);
+      }
+   }
+   else fprintf(fp,"\n Counters: perf_event not available\n");
+
+   fprintf(fp,"\n Generations by ticks per generation, 2^b:count\n");
+   for (ph=0; ph<DE_PH_N; ph++)
+   {
+      if (p->tick[ph] == 0) continue;
+      fprintf(fp," %-11s",de_phase_name[ph]);
+      for (b=0; b<DE_HIST; b++)
+      {
+         if (p->hist[ph][b] > 0) fprintf(fp," 2^%d:%ld",b,p->hist[ph][b]);
+      }
+      fprintf(fp,"\n");
+   }
+}
+
+#else
+
+typedef int de_prof_unused;   /* ISO C wants something to compile */
+
+#endif
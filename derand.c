@@ -0,0 +1,226 @@
+# include "de.h"
+
+/*------------------------Random number layer---------------------------*/
+/*------Two generators are available behind de_rng:-------------------*/
+/*------DE_RNG_RAN2     the original rnd_uni(), kept to reproduce old---*/
+/*------                runs bit for bit; one sequential stream.--------*/
+/*------DE_RNG_XOSHIRO  xoshiro256+ run in DE_RNG_LANES interleaved----*/
+/*------                lanes, so that bulk generation vectorizes.------*/
+/*------                Every (seed,stream) pair gives an independent---*/
+/*------                generator, which lets threads and members draw--*/
+/*------                from their own streams.-------------------------*/
+
+
+char *de_rng_name[] =     /* generator names                    */
+{
+         "ran2",
+         "xoshiro"
+};
+
+
+void rnd_init(rnd_state *s, long seed)
+/**C*F****************************************************************
+**                                                                  **
+** Prepares the state of rnd_uni() for a new sequence started from  **
+** seed, exactly as the former static initializers of rnd_uni() did.**
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   s->idum  = -seed;
+   s->idum2 = 123456789;
+   s->iy    = 0;
+}
+
+
+double rnd_uni(rnd_state *s)
+/**C*F****************************************************************
+**                                                                  **
+** SRC-FUNCTION   :rnd_uni()                                        **
+** LONG_NAME      :random_uniform                                   **
+** AUTHOR         :(see below)                                      **
+**                                                                  **
+** DESCRIPTION    :rnd_uni() generates an equally distributed ran-  **
+**                 dom number in the interval [0,1]. For further    **
+**                 reference see Press, W.H. et alii, Numerical     **
+**                 Recipes in C, Cambridge University Press, 1992.  **
+**                                                                  **
+** FUNCTIONS      :none                                             **
+**                                                                  **
+** GLOBALS        :none                                             **
+**                                                                  **
+** PARAMETERS     :*s       generator state, see rnd_init()         **
+**                                                                  **
+** PRECONDITIONS  :s->idum must be negative on the first call.      **
+**                                                                  **
+** POSTCONDITIONS :*s will be changed                               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+  long j;
+  long k;
+  long *idum = &s->idum;
+  double temp;
+
+  if (*idum <= 0)
+  {
+    if (-(*idum) < 1) *idum=1;
+    else *idum = -(*idum);
+    s->idum2=(*idum);
+    for (j=NTAB+7;j>=0;j--)
+    {
+      k=(*idum)/IQ1;
+      *idum=IA1*(*idum-k*IQ1)-k*IR1;
+      if (*idum < 0) *idum += IM1;
+      if (j < NTAB) s->iv[j] = *idum;
+    }
+    s->iy=s->iv[0];
+  }
+  k=(*idum)/IQ1;
+  *idum=IA1*(*idum-k*IQ1)-k*IR1;
+  if (*idum < 0) *idum += IM1;
+  k=s->idum2/IQ2;
+  s->idum2=IA2*(s->idum2-k*IQ2)-k*IR2;
+  if (s->idum2 < 0) s->idum2 += IM2;
+  j=s->iy/NDIV;
+  s->iy=s->iv[j]-s->idum2;
+  s->iv[j] = *idum;
+  if (s->iy < 1) s->iy += IMM1;
+  if ((temp=AM*s->iy) > RNMX) return RNMX;
+  else return temp;
+
+}/*------End of rnd_uni()--------------------------*/
+
+
+static uint64_t splitmix64(uint64_t *x)
+/**C*F****************************************************************
+**                                                                  **
+** SplitMix64 (Steele, Lea, Flood 2014), used to expand a seed into **
+** the state of the xoshiro lanes.                                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   return z ^ (z >> 31);
+}
+
+
+static void xoshiro_step(de_rng *r, uint64_t out[DE_RNG_LANES])
+/**C*F****************************************************************
+**                                                                  **
+** Advances all lanes of xoshiro256+ (Blackman, Vigna 2018) by one  **
+** step. The lane loop has no dependencies and vectorizes.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t *s0 = r->s[0], *s1 = r->s[1], *s2 = r->s[2], *s3 = r->s[3];
+   uint64_t t;
+   int k;
+
+   for (k=0; k<DE_RNG_LANES; k++)
+   {
+      out[k] = s0[k] + s3[k];
+      t      = s1[k] << 17;
+      s2[k] ^= s0[k];
+      s3[k] ^= s1[k];
+      s1[k] ^= s2[k];
+      s0[k] ^= s3[k];
+      s2[k] ^= t;
+      s3[k]  = (s3[k] << 45) | (s3[k] >> 19);
+   }
+}
+
+
+void de_rng_init(de_rng *r, int kind, long seed, long stream)
+/**C*F****************************************************************
+**                                                                  **
+** Starts generator r of the given kind. For DE_RNG_XOSHIRO each    **
+** stream number gives an independent sequence for the same seed;   **
+** DE_RNG_RAN2 has a single stream and ignores it.                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t x;
+   int w, k;
+
+   r->kind = kind;
+   r->pos  = DE_RNG_BUF;
+   if (kind == DE_RNG_RAN2)
+   {
+      rnd_init(&r->ran2,seed);
+      return;
+   }
+   x = (uint64_t)seed * 0xd1342543de82ef95ULL + (uint64_t)stream;
+   x = splitmix64(&x) ^ (uint64_t)stream * 0x9e3779b97f4a7c15ULL;
+   for (w=0; w<4; w++)
+   {
+      for (k=0; k<DE_RNG_LANES; k++)
+      {
+         r->s[w][k] = splitmix64(&x);
+      }
+   }
+}
+
+
+static void xoshiro_fill(de_rng *r, double u[], int n)
+/**C*F****************************************************************
+**                                                                  **
+** Writes n uniforms in [0,1) to u, DE_RNG_LANES per step; n must   **
+** be a multiple of DE_RNG_LANES.                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   uint64_t out[DE_RNG_LANES];
+   int i, k;
+
+   for (i=0; i<n; i+=DE_RNG_LANES)
+   {
+      xoshiro_step(r,out);
+      for (k=0; k<DE_RNG_LANES; k++)
+      {
+         u[i+k] = (double)(out[k] >> 11) * 0x1.0p-53;
+      }
+   }
+}
+
+
+double de_rng_uni(de_rng *r)
+/**C*F****************************************************************
+**                                                                  **
+** Returns one uniform number in [0,1). xoshiro numbers are made    **
+** in blocks of DE_RNG_BUF and handed out from the buffer.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (r->kind == DE_RNG_RAN2) return rnd_uni(&r->ran2);
+   if (r->pos == DE_RNG_BUF)
+   {
+      xoshiro_fill(r,r->buf,DE_RNG_BUF);
+      r->pos = 0;
+   }
+   return r->buf[r->pos++];
+}
+
+
+void de_rng_fill(de_rng *r, double u[], int n)
+/**C*F****************************************************************
+**                                                                  **
+** Bulk version of de_rng_uni(): writes the next n numbers of the   **
+** stream to u. The sequence is the same as from n single calls.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i = 0, m;
+
+   if (r->kind == DE_RNG_RAN2)
+   {
+      for (i=0; i<n; i++) u[i] = rnd_uni(&r->ran2);
+      return;
+   }
+   while (i < n && r->pos < DE_RNG_BUF) u[i++] = r->buf[r->pos++];
+   m = (n - i) - (n - i)%DE_RNG_LANES;    /* whole steps go straight to u */
+   xoshiro_fill(r,u+i,m);
+   i += m;
+   while (i < n) u[i++] = de_rng_uni(r);
+}
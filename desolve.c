@@ -0,0 +1,1302 @@
+# include "de.h"
+# include "deint.h"
+# include <time.h>
+
+char *de_strat[] =        /* strategy-indicator                 */
+{
+         "",
+         "DE/best/1/exp",
+         "DE/rand/1/exp",
+         "DE/rand-to-best/1/exp",
+         "DE/best/2/exp",
+         "DE/rand/2/exp",
+         "DE/best/1/bin",
+         "DE/rand/1/bin",
+         "DE/rand-to-best/1/bin",
+         "DE/best/2/bin",
+         "DE/rand/2/bin"
+};
+
+char *de_adapt_name[] =   /* adaptation of F and CR             */
+{
+         "none",
+         "jde",
+         "shade"
+};
+
+char *de_stop_name[] =    /* reasons for the end of a run       */
+{
+         "genmax",
+         "vtr",
+         "stall",
+         "cvar",
+         "nfeval",
+         "wall",
+         "user"
+};
+
+char *de_bound_name[] =   /* handling of out-of-bounds trials   */
+{
+         "none",
+         "clamp",
+         "reflect",
+         "bounce",
+         "reinit"
+};
+
+char *de_mode_name[] =    /* iteration modes                    */
+{
+         "sync",
+         "async"
+};
+
+/*---------Function definitions-----------------------------------------*/
+
+void  assignd(int D, double a[], const double b[])
+/**C*F****************************************************************
+**                                                                  **
+** Assigns D-dimensional vector b to vector a.                      **
+** You might encounter problems with the macro ASSIGND on some      **
+** machines. If yes, better use this function although it's slower. **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j;
+   for (j=0; j<D; j++)
+   {
+      a[j] = b[j];
+   }
+}
+
+
+void  assignr(int D, de_real a[], const de_real b[])
+/**C*F****************************************************************
+**                                                                  **
+** Assigns D-dimensional population row b to row a.                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j;
+   for (j=0; j<D; j++)
+   {
+      a[j] = b[j];
+   }
+}
+
+
+void  de_widen(int D, double a[], const de_real b[])
+/**C*F****************************************************************
+**                                                                  **
+** Assigns population row b to the vector of doubles a.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j;
+   for (j=0; j<D; j++)
+   {
+      a[j] = b[j];
+   }
+}
+
+
+void  de_narrow(int D, de_real a[], const double b[])
+/**C*F****************************************************************
+**                                                                  **
+** Assigns the vector of doubles b to population row a, rounded to  **
+** de_real.                                                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j;
+   for (j=0; j<D; j++)
+   {
+      a[j] = (de_real)b[j];
+   }
+}
+
+
+double *de_wide(de_ctx *x, const de_real *r)
+/**C*F****************************************************************
+**                                                                  **
+** Converts population row r into the first wide row of the calling **
+** thread and returns it, for passing to the objective. Only used   **
+** with DE_FLOAT; see WIDE in deint.h.                              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   double *w = x->wide + (size_t)de_pool_self(x->pool)*x->wrows*x->wstride;
+
+   de_widen(x->cfg->D,w,r);
+   return w;
+}
+
+
+void de_defaults(de_config *cfg)
+/**C*F****************************************************************
+**                                                                  **
+** Fills cfg with the settings of the distributed dj9.dat.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   memset(cfg,0,sizeof(*cfg));
+   cfg->strategy   = 2;
+   cfg->genmax     = 3000;
+   cfg->D          = 3;
+   cfg->NP         = 5;
+   cfg->inibound_h = 5.12;
+   cfg->inibound_l = -5.12;
+   cfg->F          = 0.9;
+   cfg->CR         = 0.1;
+   cfg->seed       = 123;
+   cfg->threads    = 1;
+   cfg->rng        = DE_RNG_RAN2;
+   cfg->mode       = DE_MODE_SYNC;
+   cfg->trace_every = 1;
+   cfg->surr_keep  = 0.5;
+   cfg->local_every = 100;
+   cfg->vtr        = -HUGE_VAL;
+}
+
+
+int de_check(const de_config *cfg, char *msg, int len)
+/**C*F****************************************************************
+**                                                                  **
+** Checks the input variables for proper range. Returns DE_OK or    **
+** DE_EINVAL; in the latter case an error text is put into msg.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+  int j;
+  int npmin = (cfg->strategy%5 == 0) ? 6 : 5;  /* i and r1..r4 or r1..r5 */
+
+  if (cfg->D <= 0)
+  {
+     snprintf(msg,len,"Error! D=%d, should be > 0",cfg->D);
+     return DE_EINVAL;
+  }
+  if (cfg->NP < npmin)
+  {
+     snprintf(msg,len,"Error! NP=%d, should be >= %d for strategy %d",cfg->NP,
+              npmin,cfg->strategy);
+     return DE_EINVAL;
+  }
+  if ((cfg->CR < 0) || (cfg->CR > 1.0))
+  {
+     snprintf(msg,len,"Error! CR=%f, should be ex [0,1]",cfg->CR);
+     return DE_EINVAL;
+  }
+  if (cfg->seed <= 0)
+  {
+     snprintf(msg,len,"Error! seed=%d, should be > 0",cfg->seed);
+     return DE_EINVAL;
+  }
+  if (cfg->threads <= 0)
+  {
+     snprintf(msg,len,"Error! threads=%d, should be > 0",cfg->threads);
+     return DE_EINVAL;
+  }
+  if ((cfg->rng != DE_RNG_RAN2) && (cfg->rng != DE_RNG_XOSHIRO))
+  {
+     snprintf(msg,len,"Error! rng=%d, should be ex {%d,%d}",cfg->rng,
+              DE_RNG_RAN2,DE_RNG_XOSHIRO);
+     return DE_EINVAL;
+  }
+  if ((cfg->mode != DE_MODE_SYNC) && (cfg->mode != DE_MODE_ASYNC))
+  {
+     snprintf(msg,len,"Error! mode=%d, should be ex {%d,%d}",cfg->mode,
+              DE_MODE_SYNC,DE_MODE_ASYNC);
+     return DE_EINVAL;
+  }
+  if (cfg->migrate != NULL && (cfg->migrate_every <= 0 || cfg->nimm <= 0))
+  {
+     snprintf(msg,len,"Error! migrate_every=%d, nimm=%d, should be > 0",
+              cfg->migrate_every,cfg->nimm);
+     return DE_EINVAL;
+  }
+  if (cfg->checkpoint != NULL && cfg->checkpoint_every <= 0)
+  {
+     snprintf(msg,len,"Error! checkpoint_every=%d, should be > 0",
+              cfg->checkpoint_every);
+     return DE_EINVAL;
+  }
+  if (cfg->resume && cfg->checkpoint == NULL)
+  {
+     snprintf(msg,len,"Error! resume needs a checkpoint file");
+     return DE_EINVAL;
+  }
+  if (cfg->trace != NULL && (cfg->trace_every <= 0 || cfg->trace_pop < 0))
+  {
+     snprintf(msg,len,"Error! trace_every=%d, trace_pop=%d, should be > 0, >= 0",
+              cfg->trace_every,cfg->trace_pop);
+     return DE_EINVAL;
+  }
+  if (cfg->stall < 0 || cfg->cvar_min < 0 || cfg->max_nfeval < 0 ||
+      cfg->max_wall < 0)
+  {
+     snprintf(msg,len,"Error! stall, cvar_min, max_nfeval and max_wall should be >= 0");
+     return DE_EINVAL;
+  }
+  if ((cfg->adapt < DE_ADAPT_NONE) || (cfg->adapt > DE_ADAPT_SHADE))
+  {
+     snprintf(msg,len,"Error! adapt=%d, should be ex {%d,%d,%d}",cfg->adapt,
+              DE_ADAPT_NONE,DE_ADAPT_JDE,DE_ADAPT_SHADE);
+     return DE_EINVAL;
+  }
+  if (cfg->np_min != 0 && (cfg->np_min < npmin || cfg->np_min > cfg->NP ||
+                           cfg->mode != DE_MODE_SYNC))
+  {
+     snprintf(msg,len,"Error! np_min=%d, should be ex [%d,NP] in sync mode",
+              cfg->np_min,npmin);
+     return DE_EINVAL;
+  }
+  if (cfg->delta != NULL && (cfg->delta_state <= 0 || cfg->batch != NULL ||
+                             cfg->mode != DE_MODE_SYNC))
+  {
+     snprintf(msg,len,"Error! delta needs delta_state > 0, no batch, sync mode");
+     return DE_EINVAL;
+  }
+  if ((cfg->bound < DE_BOUND_NONE) || (cfg->bound > DE_BOUND_REINIT))
+  {
+     snprintf(msg,len,"Error! bound=%d, should be ex [%d,%d]",cfg->bound,
+              DE_BOUND_NONE,DE_BOUND_REINIT);
+     return DE_EINVAL;
+  }
+  if (cfg->surr_k != 0 && (cfg->surr_k < 0 || cfg->surr_k > DE_SURR_KMAX ||
+                           !(cfg->surr_keep > 0 && cfg->surr_keep <= 1) ||
+                           cfg->surr_archive < 0 || cfg->mode != DE_MODE_SYNC))
+  {
+     snprintf(msg,len,"Error! surr_k=%d, surr_keep=%f, should be ex [0,%d], (0,1], sync mode",
+              cfg->surr_k,cfg->surr_keep,DE_SURR_KMAX);
+     return DE_EINVAL;
+  }
+  if (cfg->local != DE_LOCAL_NONE &&
+      (cfg->local < DE_LOCAL_NONE || cfg->local > DE_LOCAL_LBFGS ||
+       cfg->local_every < 0 || cfg->local_stall < 0 || cfg->local_budget < 0 ||
+       cfg->local_every + cfg->local_stall == 0 || cfg->mode != DE_MODE_SYNC))
+  {
+     snprintf(msg,len,"Error! local=%d, local_every=%d, local_stall=%d, should be ex [0,%d], >= 0, not both 0, sync mode",
+              cfg->local,cfg->local_every,cfg->local_stall,DE_LOCAL_LBFGS);
+     return DE_EINVAL;
+  }
+  for (j=0; cfg->quant != NULL && j<cfg->D; j++)
+  {
+     if (!(cfg->quant[j] >= 0) || isinf(cfg->quant[j]))
+     {
+        snprintf(msg,len,"Error! quant[%d]=%f, should be >= 0",j,cfg->quant[j]);
+        return DE_EINVAL;
+     }
+  }
+  if (cfg->cache < 0 || (cfg->cache > 0 && cfg->delta != NULL) ||
+      (cfg->quant != NULL && cfg->local != DE_LOCAL_NONE))
+  {
+     snprintf(msg,len,"Error! cache=%ld, should be >= 0, not with delta; quant not with local",
+              cfg->cache);
+     return DE_EINVAL;
+  }
+  if ((cfg->lo == NULL) != (cfg->hi == NULL))
+  {
+     snprintf(msg,len,"Error! lo and hi should both be given or both be NULL");
+     return DE_EINVAL;
+  }
+  for (j=0; cfg->lo != NULL && j<cfg->D; j++)
+  {
+     if (!(cfg->lo[j] <= cfg->hi[j]))
+     {
+        snprintf(msg,len,"Error! hi[%d]=%f < lo[%d]=%f",j,cfg->hi[j],j,cfg->lo[j]);
+        return DE_EINVAL;
+     }
+  }
+  if (cfg->genmax <= 0)
+  {
+     snprintf(msg,len,"Error! genmax=%d, should be > 0",cfg->genmax);
+     return DE_EINVAL;
+  }
+  if ((cfg->strategy < 0) || (cfg->strategy > 10))
+  {
+     snprintf(msg,len,"Error! strategy=%d, should be ex {1,2,3,4,5,6,7,8,9,10}",
+              cfg->strategy);
+     return DE_EINVAL;
+  }
+  if (cfg->inibound_h < cfg->inibound_l)
+  {
+     snprintf(msg,len,"Error! inibound_h=%f < inibound_l=%f",
+              cfg->inibound_h,cfg->inibound_l);
+     return DE_EINVAL;
+  }
+  return DE_OK;
+}
+
+
+double de_time(void)
+/**C*F****************************************************************
+**                                                                  **
+** Seconds on a monotonic clock, for wall time measurements.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC,&ts);
+   return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+
+void de_busy(de_ctx *x, double t)
+/**C*F****************************************************************
+**                                                                  **
+** Adds the time since t to the time spent in the objective. May    **
+** be called from several threads at once.                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   __atomic_fetch_add(&x->busy_ns,(long)(1e9*(de_time()-t)),__ATOMIC_RELAXED);
+}
+
+
+size_t de_stride(int D)
+/**C*F****************************************************************
+**                                                                  **
+** Number of de_reals per population row: D padded so that every    **
+** row starts on a DE_ALIGN byte boundary.                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t n = DE_ALIGN/sizeof(de_real);
+   return ((size_t)D + n-1)/n*n;
+}
+
+
+#define DE_INIT_TRIES 100 /* draws of an initial member       */
+#define DE_WIDE_BYTES 65536 /* DE_FLOAT: wide rows per thread   */
+
+
+static size_t carve(size_t *used, size_t bytes)
+/**C*F****************************************************************
+**                                                                  **
+** Reserves bytes, rounded up to DE_ALIGN, at offset *used of the   **
+** arena and returns the offset of the reserved block.              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t off = *used;
+   *used += (bytes + DE_ALIGN-1)/DE_ALIGN*DE_ALIGN;
+   return off;
+}
+
+
+static de_ctx *alloc_ctx(const de_config *cfg)
+/**C*F****************************************************************
+**                                                                  **
+** Allocates the context and all run-sized buffers as one DE_ALIGN  **
+** aligned block. Returns NULL if that does not fit in memory.      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t stride = de_stride(cfg->D);
+   size_t NP = (size_t)cfg->NP;
+   size_t used = 0, o_pop, o_slot, o_best, o_bestit, o_cost, o_tcost;
+   size_t o_imm, o_icost, o_ad, o_st, o_tlo, o_lo, o_ax, o_pm, o_skip;
+   size_t o_wide, o_lw, o_cmiss;
+   size_t nl   = de_local_size(cfg);
+   size_t nimm = (cfg->migrate != NULL) ? (size_t)cfg->nimm : 0;
+   size_t nad  = (cfg->adapt != DE_ADAPT_NONE) ? NP : 0;
+   size_t ns   = (cfg->delta != NULL) ? (size_t)cfg->delta_state : 0;
+   size_t nt   = (cfg->delta != NULL) ? NP : 0;
+   size_t na   = (cfg->surr_k == 0) ? 0 :
+                 (cfg->surr_archive > 0) ? (size_t)cfg->surr_archive :
+                                           DE_SURR_ARCHIVE*NP;
+   size_t nsr  = (cfg->surr_k > 0) ? NP : 0;
+   size_t nc   = (cfg->cache > 0) ? NP : 0;
+   size_t wstride = (size_t)(cfg->D + 7)/8*8;   /* doubles, DE_ALIGN */
+   size_t wrows = DE_WIDE_BYTES/sizeof(double)/wstride;
+   size_t nw;
+   char  *a;
+   de_ctx *x;
+
+   if (NP > ((size_t)-1)/8/sizeof(double)/stride) return NULL;
+   if (ns > 0 && NP > ((size_t)-1)/8/sizeof(double)/ns) return NULL;
+   if (na > ((size_t)-1)/8/sizeof(double)/(cfg->D+1)) return NULL;
+   if (nl > ((size_t)-1)/8/sizeof(double)) return NULL;
+
+   if (wrows < 1)  wrows = 1;
+   if (wrows > NP) wrows = NP;
+   nw = (sizeof(de_real) < sizeof(double)) ? wrows*cfg->threads : 0;
+
+   carve(&used,sizeof(de_ctx));
+   o_pop    = carve(&used,2*NP*stride*sizeof(de_real));
+   o_slot   = carve(&used,2*NP*sizeof(int));
+   o_best   = carve(&used,(size_t)cfg->D*sizeof(double));
+   o_bestit = carve(&used,stride*sizeof(de_real));
+   o_wide   = carve(&used,nw*wstride*sizeof(double));
+   o_cost   = carve(&used,NP*sizeof(double));
+   o_tcost  = carve(&used,NP*sizeof(double));
+   o_imm    = carve(&used,nimm*cfg->D*sizeof(double));
+   o_icost  = carve(&used,nimm*sizeof(double));
+   o_ad     = carve(&used,(7*nad + 2*DE_ADAPT_H)*sizeof(double));
+   o_st     = carve(&used,2*NP*ns*sizeof(double));
+   o_tlo    = carve(&used,2*nt*sizeof(int));
+   o_lo     = carve(&used,2*(size_t)cfg->D*sizeof(double));
+   o_ax     = carve(&used,(na*(cfg->D+1) + (nsr ? cfg->D : 0))*sizeof(double));
+   o_pm     = carve(&used,nsr*(2 + cfg->D)*sizeof(double));
+   o_skip   = carve(&used,nsr);
+   o_lw     = carve(&used,nl*sizeof(double));
+   o_cmiss  = carve(&used,nc);
+
+   if (posix_memalign((void **)&a,DE_ALIGN,used) != 0) return NULL;
+   memset(a,0,sizeof(de_ctx));
+   x = (de_ctx *)a;
+   x->arena  = a;
+   x->stride = stride;
+   x->pop    = (de_real *)(a + o_pop);
+   x->slot   = (int *)(a + o_slot);
+   x->tslot  = x->slot + NP;
+   x->best   = (double *)(a + o_best);
+   x->bestit = (de_real *)(a + o_bestit);
+   x->wide   = (double *)(a + o_wide);
+   x->wstride = wstride;
+   x->wrows  = (int)wrows;
+   x->cost   = (double *)(a + o_cost);
+   x->tcost  = (double *)(a + o_tcost);
+   x->imm    = (double *)(a + o_imm);
+   x->icost  = (double *)(a + o_icost);
+   x->mF     = (double *)(a + o_ad);   /* mF,mCR,tF,tCR,sF,sCR,sW,hF,hCR */
+   x->mCR    = x->mF  + nad;
+   x->tF     = x->mCR + nad;
+   x->tCR    = x->tF  + nad;
+   x->sF     = x->tCR + nad;
+   x->sCR    = x->sF  + nad;
+   x->sW     = x->sCR + nad;
+   x->hF     = x->sW  + nad;
+   x->hCR    = x->hF  + DE_ADAPT_H;
+   x->st     = (double *)(a + o_st);
+   x->tlo    = (int *)(a + o_tlo);
+   x->tlen   = x->tlo + nt;
+   x->lo     = (double *)(a + o_lo);
+   x->hi     = x->lo + cfg->D;
+   x->acap   = (int)na;
+   x->ax     = (double *)(a + o_ax);  /* ax,acost,rs */
+   x->acost  = x->ax + na*cfg->D;
+   x->rs     = x->acost + na;
+   x->pm     = (double *)(a + o_pm);
+   x->ps     = x->pm + nsr;           /* pm,ps,ts */
+   x->ts     = x->ps + nsr;
+   x->skip   = a + o_skip;
+   x->lw     = (double *)(a + o_lw);
+   x->cmiss  = a + o_cmiss;
+   return x;
+}
+
+
+static int screen(de_ctx *x, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Asks cfg->feasible about trial i, except for the initial         **
+** population. Returns 1 if it is to be evaluated; otherwise sets   **
+** its cost to NaN and counts it. So are the trials the surrogate   **
+** held back, see desurr.c. A trial found in the evaluation cache   **
+** gets the stored cost instead; one that is to be evaluated is     **
+** marked in cmiss for de_cache_add(). May run on several threads.  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+
+   if (x->cache != NULL) x->cmiss[i] = 0;
+   if (cfg->surr_k > 0 && !x->full && x->skip[i])
+   {
+      x->tcost[i] = NAN;
+      __atomic_fetch_add(&x->nscreen,1,__ATOMIC_RELAXED);
+      return 0;
+   }
+   if (x->cache != NULL && de_cache_find(x->cache,TRIAL(i),&x->tcost[i]))
+   {
+      __atomic_fetch_add(&x->nhit,1,__ATOMIC_RELAXED);
+      return 0;
+   }
+   if (cfg->feasible != NULL && !x->full &&
+       !cfg->feasible(cfg->D,WIDE(TRIAL(i)),cfg->feasible_user))
+   {
+      x->tcost[i] = NAN;
+      __atomic_fetch_add(&x->nreject,1,__ATOMIC_RELAXED);
+      return 0;
+   }
+   if (x->cache != NULL) x->cmiss[i] = 1;
+   return 1;
+}
+
+
+static void evaluate_trial(void *arg, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: evaluates the trial vector of member i. Runs          **
+** concurrently with the other trials, so it only writes tcost[i]   **
+** and the state of the trial; de_solve() counts the evaluations    **
+** afterwards. An incremental objective gets the changed parameters **
+** and the state of the parent, unless x->full is set. A trial that **
+** cfg->feasible rejects gets cost NaN instead, which never wins    **
+** the selection.                                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ctx *x = (de_ctx *)arg;
+   double t;
+   DE_PROF_T(pt);
+
+   if (screen(x,i))
+   {
+      t = de_time();
+      if (x->cfg->delta != NULL)
+      {
+         x->tcost[i] = x->cfg->delta(x->cfg->D,WIDE(TRIAL(i)),x->tlo[i],x->tlen[i],
+                                     x->full ? NULL : SROW(x->slot[i]),
+                                     SROW(x->tslot[i]),x->user);
+      }
+      else x->tcost[i] = x->fn(x->cfg->D,WIDE(TRIAL(i)),x->user);
+      de_busy(x,t);
+   }
+   DE_PROF_ADD(DE_PH_EVAL,pt);
+}
+
+
+void de_delta_full(de_ctx *x, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Recomputes the cached state of member i from scratch,            **
+** after the member was set by other means than selection. The cost **
+** is known already, so this is not counted as an evaluation.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   x->cfg->delta(x->cfg->D,WIDE(MEM(i)),0,x->cfg->D,NULL,SROW(x->slot[i]),
+                 x->user);
+}
+
+
+static void batch_run(de_ctx *x, int lo, int n)
+/**C*F****************************************************************
+**                                                                  **
+** Passes the trials of members lo..lo+n-1 to the batch objective.  **
+** With DE_FLOAT they are widened into the wide rows of the calling **
+** thread and passed on wrows at a time.                            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+#ifdef DE_FLOAT
+   double *w = x->wide + (size_t)de_pool_self(x->pool)*x->wrows*x->wstride;
+   int m, k;
+
+   for (; n>0; lo+=m, n-=m)
+   {
+      m = (n < x->wrows) ? n : x->wrows;
+      for (k=0; k<m; k++) de_widen(x->cfg->D,w+(size_t)k*x->wstride,TRIAL(lo+k));
+      x->cfg->batch(x->cfg->D,m,w,x->wstride,x->tcost+lo,x->user);
+   }
+#else
+   x->cfg->batch(x->cfg->D,n,TRIAL(lo),x->stride,x->tcost+lo,x->user);
+#endif
+}
+
+
+static void evaluate_chunk(void *arg, int k)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: passes chunk k of the nchunk chunks of the trials to  **
+** the batch objective. With cfg->batch the trial rows stay in one  **
+** block, see de_accept(). Trials rejected by cfg->feasible split   **
+** the chunk into runs that are passed on separately.               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ctx *x = (de_ctx *)arg;
+   int NP = x->NP;
+   int lo = (int)((long)k*NP/x->nchunk);
+   int hi = (int)((long)(k+1)*NP/x->nchunk);
+   int b;
+   double t = de_time();
+   DE_PROF_T(pt);
+
+   for (; lo<hi; lo=b+1)
+   {
+      for (b=lo; b<hi && screen(x,b); b++);   /* run of feasible trials */
+      if (b > lo) batch_run(x,lo,b-lo);
+   }
+   de_busy(x,t);
+   DE_PROF_ADD(DE_PH_EVAL,pt);
+}
+
+
+static void evaluate_all(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Evaluates all NP trials into tcost[]. A batch objective          **
+** gets one contiguous chunk per thread, otherwise the trials are   **
+** handed to the threads one by one. Rejected and held back trials  **
+** and those found in the cache are not counted as evaluations.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int NP = x->NP;
+   long r0 = x->nreject + x->nscreen + x->nhit;
+
+   if (x->cfg->batch != NULL)
+   {
+      x->nchunk = de_pool_size(x->pool);
+      if (x->nchunk > NP) x->nchunk = NP;
+      de_pool_run(x->pool,x->nchunk,evaluate_chunk,x);
+   }
+   else
+   {
+      de_pool_run(x->pool,NP,evaluate_trial,x);
+   }
+   x->nfeval += NP - (x->nreject + x->nscreen + x->nhit - r0);
+}
+
+
+static void bound_trial(de_ctx *x, const de_trial *t, de_rng *rnd)
+/**C*F****************************************************************
+**                                                                  **
+** Brings the parameters the kernel changed back into [lo,hi] as    **
+** cfg->bound says. Random numbers are only drawn for parameters    **
+** that are out of bounds.                                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int    D = t->D, k, j;
+   double v, l, h;
+
+   for (k=0, j=t->lo; k<t->len; k++, j=(j+1 == D) ? 0 : j+1)
+   {
+      v = t->tmp[j];
+      l = x->lo[j];
+      h = x->hi[j];
+      if (v >= l && v <= h) continue;
+      switch (x->cfg->bound)
+      {
+         case DE_BOUND_REFLECT: v = (v < l) ? 2.0*l - v : 2.0*h - v;
+                                break;
+         case DE_BOUND_BOUNCE:  v = (v < l) ? l + de_rng_uni(rnd)*(t->old[j] - l)
+                                           : h - de_rng_uni(rnd)*(h - t->old[j]);
+                                break;
+         case DE_BOUND_REINIT:  v = l + de_rng_uni(rnd)*(h - l);
+                                break;
+      }
+      t->tmp[j] = (v < l) ? l : (v > h) ? h : v;  /* clamp whatever is left */
+   }
+}
+
+
+void de_build_trial(de_ctx *x, int i, de_rng *rnd)
+/**C*F****************************************************************
+**                                                                  **
+** Builds the trial vector for member i into its row tslot[i] from  **
+** the population and bestit[], drawing from rnd, and applies the   **
+** boundary handling. Only reads shared state, so trials may be     **
+** built concurrently.                                              **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int   r1, r2, r3, r4;  /* placeholders for random indexes    */
+   int   r5;              /* placeholders for random indexes    */
+   int   NP = x->NP;      /* number of population members       */
+   de_trial t;
+   DE_PROF_T(pt);
+
+   r5 = 0;
+   if (x->cfg->adapt != DE_ADAPT_NONE) de_adapt_sample(x,i,rnd);
+
+   do                        /* Pick a random population member */
+   {                         /* Endless loop for NP < 2 !!!     */
+      r1 = (int)(de_rng_uni(rnd)*NP);
+   }while(r1==i);
+
+   do                        /* Pick a random population member */
+   {                         /* Endless loop for NP < 3 !!!     */
+      r2 = (int)(de_rng_uni(rnd)*NP);
+   }while((r2==i) || (r2==r1));
+
+   do                        /* Pick a random population member */
+   {                         /* Endless loop for NP < 4 !!!     */
+      r3 = (int)(de_rng_uni(rnd)*NP);
+   }while((r3==i) || (r3==r1) || (r3==r2));
+
+   do                        /* Pick a random population member */
+   {                         /* Endless loop for NP < 5 !!!     */
+      r4 = (int)(de_rng_uni(rnd)*NP);
+   }while((r4==i) || (r4==r1) || (r4==r2) || (r4==r3));
+
+   if (NP >= 6)
+   {
+      do                     /* Pick a random population member */
+      {                      /* Endless loop for NP < 6 !!!     */
+         r5 = (int)(de_rng_uni(rnd)*NP);
+      }while((r5==i) || (r5==r1) || (r5==r2) || (r5==r3) || (r5==r4));
+   }
+
+   DE_PROF_ADD(DE_PH_SAMPLE,pt);
+
+   t.D      = x->cfg->D;
+   t.F      = (x->cfg->adapt != DE_ADAPT_NONE) ? x->tF[i]  : x->cfg->F;
+   t.CR     = (x->cfg->adapt != DE_ADAPT_NONE) ? x->tCR[i] : x->cfg->CR;
+   t.old    = MEM(i);
+   t.bestit = x->bestit;
+   t.p1     = MEM(r1);
+   t.p2     = MEM(r2);
+   t.p3     = MEM(r3);
+   t.p4     = MEM(r4);
+   t.p5     = MEM(r5);
+   t.tmp    = TRIAL(i);        /* trial is built in place       */
+   x->kernel(&t,rnd);
+   if (x->cfg->bound != DE_BOUND_NONE) bound_trial(x,&t,rnd);
+   de_quantize(x,t.tmp,t.lo,t.len);
+   if (x->cfg->delta != NULL)
+   {
+      x->tlo[i]  = t.lo;
+      x->tlen[i] = t.len;
+   }
+   DE_PROF_ADD(DE_PH_MUTATE,pt);
+}
+
+
+void de_accept(de_ctx *x, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Makes the trial of member i the member: swaps slot[i] and        **
+** tslot[i], so the old member's row takes the next trial. A batch  **
+** objective needs the trials as one strided block, so there the    **
+** trial is copied instead.                                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   if (x->cfg->batch != NULL)
+   {
+      assignr(x->cfg->D,MEM(i),TRIAL(i));
+      return;
+   }
+   k           = x->slot[i];
+   x->slot[i]  = x->tslot[i];
+   x->tslot[i] = k;
+}
+
+
+static void build_trial_task(void *arg, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task for DE_RNG_XOSHIRO: builds trial i with its own        **
+** stream, numbered by generation and member, so the result does    **
+** not depend on which thread runs it. Without a batch objective    **
+** or surrogate the trial is evaluated right away.                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ctx *x = (de_ctx *)arg;
+   de_rng rnd;
+
+   de_rng_init(&rnd,DE_RNG_XOSHIRO,x->cfg->seed,(long)x->gen*x->cfg->NP+i+1);
+   de_build_trial(x,i,&rnd);
+   if (x->cfg->batch == NULL && x->cfg->surr_k == 0) evaluate_trial(x,i);
+}
+
+
+void de_stats(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Computes the energy variance (just for monitoring purposes).     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int j, NP = x->NP;
+   double *cost = x->cost;
+
+   x->cmean = 0.;          /* compute the mean value first */
+   for (j=0; j<NP; j++)
+   {
+      x->cmean += cost[j];
+   }
+   x->cmean = x->cmean/NP;
+
+   x->cvar = 0.;           /* now the variance              */
+   for (j=0; j<NP; j++)
+   {
+      x->cvar += (cost[j] - x->cmean)*(cost[j] - x->cmean);
+   }
+   x->cvar = x->cvar/(NP-1);
+}
+
+
+void de_report(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Reports progress to the trace file and the caller after a        **
+** generation.                                                      **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_progress p;
+
+   de_trace_step(x);
+   if (x->cfg->monitor == NULL) return;
+   p.gen    = x->gen;
+   p.nfeval = x->nfeval;
+   p.D      = x->cfg->D;
+   p.NP     = x->NP;
+   p.cmin   = x->cmin;
+   p.cmean  = x->cmean;
+   p.cvar   = x->cvar;
+   p.best   = x->best;
+   x->cfg->monitor(&p,x->cfg->monitor_user);
+}
+
+
+void de_migrate_step(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Offers best[] to cfg->migrate() and lets each immigrant it       **
+** returns replace the worst member, if it is better.               **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   int D = cfg->D, NP = x->NP;
+   int n, k, i, w;
+
+   n = cfg->migrate(x->gen,D,x->best,x->cmin,x->imm,x->icost,cfg->nimm,
+                    cfg->migrate_user);
+   for (k=0; k<n; k++)
+   {
+      w = 0;
+      for (i=1; i<NP; i++)
+      {
+         if (x->cost[i] > x->cost[w]) w = i;
+      }
+      if (x->icost[k] >= x->cost[w]) continue;
+      de_narrow(D,MEM(w),x->imm+(size_t)k*D);
+      x->cost[w] = x->icost[k];
+      if (cfg->delta != NULL) de_delta_full(x,w);
+      if (x->cost[w] < x->cmin)
+      {
+         x->cmin = x->cost[w];
+         x->imin = w;
+         de_widen(D,x->best,MEM(w));
+         assignr(D,x->bestit,MEM(w));
+      }
+   }
+}
+
+
+int de_done(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Checks the stop conditions after a generation. Returns nonzero   **
+** and sets x->stop to the reason if the run is to end.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+
+   if (x->cmin < x->last_cmin)
+   {
+      x->last_cmin = x->cmin;
+      x->last_imp  = x->gen;
+   }
+   if (cfg->stop != NULL && *cfg->stop)                  x->stop = DE_STOP_USER;
+   else if (x->cmin <= cfg->vtr)                         x->stop = DE_STOP_VTR;
+   else if (cfg->max_nfeval > 0 && x->nfeval >= cfg->max_nfeval)
+                                                         x->stop = DE_STOP_NFEVAL;
+   else if (cfg->max_wall > 0 && de_time()-x->t0 >= cfg->max_wall)
+                                                         x->stop = DE_STOP_WALL;
+   else if (cfg->cvar_min > 0 && x->cvar < cfg->cvar_min) x->stop = DE_STOP_CVAR;
+   else if (cfg->stall > 0 && x->gen-x->last_imp >= cfg->stall)
+                                                         x->stop = DE_STOP_STALL;
+   else if (x->gen >= cfg->genmax)                       x->stop = DE_STOP_GENMAX;
+   return x->stop >= 0;
+}
+
+
+static void run_sync(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Generation-synchronous iteration loop.                           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   int   i;               /* counting variable                  */
+   int   D  = cfg->D;     /* Dimension of parameter vector      */
+   int   NP;              /* number of population members       */
+   double trial_cost;      /* buffer variable                    */
+   de_real *tmp;           /* the selected trial, now a member   */
+   double *cost = x->cost;
+   long  r0;              /* trials not evaluated before a gen.  */
+   DE_PROF_T(pt);         /* ticks of the phases on this thread */
+
+/*=======================================================================*/
+/*=========Iteration loop================================================*/
+/*=======================================================================*/
+
+/*=======A generation runs in three passes: all NP trial vectors are built=*/
+/*=======into the free rows first, then evaluated, possibly on several===*/
+/*=======threads, and finally selection is done in member order. Trials==*/
+/*=======only read members and bestit[], so the result does not depend===*/
+/*=======on threads. A selected trial becomes its member by swapping row=*/
+/*=======indexes; a rejected one is simply overwritten next generation.==*/
+
+/*=======With DE_RNG_RAN2 the trials must be built one after another from=*/
+/*=======the single stream; with DE_RNG_XOSHIRO every trial has its own===*/
+/*=======stream and building is done on the threads as well.=============*/
+
+   while (!de_done(x))
+   {
+      DE_PROF_HW(DE_PH_OTHER);
+      x->gen++;
+      x->imin = 0;
+      NP = x->NP;
+
+      r0 = x->nreject + x->nhit;
+      if (cfg->rng == DE_RNG_RAN2)
+      {
+         for (i=0; i<NP; i++)      /* Start of loop through ensemble  */
+         {
+            de_build_trial(x,i,&x->rnd);
+         }                         /* End mutation loop through pop.  */
+         DE_PROF_HW(DE_PH_MUTATE);
+         de_surr_screen(x);
+         evaluate_all(x);
+      }
+      else
+      {
+         de_pool_run(x->pool,NP,build_trial_task,x);
+         DE_PROF_HW(DE_PH_MUTATE);
+         if (cfg->batch != NULL || cfg->surr_k > 0)
+         {
+            de_surr_screen(x);
+            evaluate_all(x);
+         }
+         else x->nfeval += NP - (x->nreject + x->nhit - r0);
+      }
+      de_surr_add(x);
+      de_cache_add(x);
+      DE_PROF_HW(DE_PH_EVAL);
+
+/*=======Trial mutations now in tslot[]. Test how good these choices really were.===========*/
+
+      DE_PROF_START(pt);
+      for (i=0; i<NP; i++)
+      {
+	 trial_cost = x->tcost[i];
+
+	 if (trial_cost <= cost[i])   /* improved objective function value ? */
+	 {
+	    if (cfg->adapt != DE_ADAPT_NONE) de_adapt_success(x,i,trial_cost,cost[i]);
+	    cost[i]=trial_cost;
+	    de_accept(x,i);
+	    tmp = MEM(i);
+	    if (trial_cost<x->cmin)       /* Was this a new minimum? */
+	    {                               /* if so...*/
+	       x->cmin=trial_cost;        /* reset cmin to new low...*/
+	       x->imin=i;
+	       de_widen(D,x->best,tmp);
+	    }
+	 }
+      }   /* End selection loop through pop. */
+
+      de_narrow(D,x->bestit,x->best);  /* Save best population member of current iteration */
+      DE_PROF_ADD(DE_PH_SELECT,pt);
+      DE_PROF_HW(DE_PH_SELECT);
+
+
+      de_adapt_update(x);
+      de_lpsr(x);
+      if (cfg->migrate != NULL && x->gen%cfg->migrate_every == 0) de_migrate_step(x);
+      de_local_step(x);
+      DE_PROF_ADD(DE_PH_OTHER,pt);
+      DE_PROF_HW(DE_PH_OTHER);
+      de_stats(x);
+      DE_PROF_ADD(DE_PH_STATS,pt);
+      DE_PROF_HW(DE_PH_STATS);
+      de_report(x);
+      de_ckpt_save(x);
+      DE_PROF_ADD(DE_PH_OTHER,pt);
+      DE_PROF_GEN();
+   }
+/*=======================================================================*/
+/*=========End of iteration loop=========================================*/
+/*=======================================================================*/
+}
+
+
+int de_solve(const de_config *cfg, de_objective fn, void *user, de_result *res)
+/**C*F****************************************************************
+**                                                                  **
+** SRC-FUNCTION   :de_solve()                                       **
+** LONG_NAME      :differential evolution solver                    **
+** AUTHOR         :Rainer Storn, Kenneth Price                      **
+**                                                                  **
+** DESCRIPTION    :minimizes fn() with the strategy, control vari-  **
+**                 ables and seed given in cfg. All state is kept   **
+**                 in a private context, so de_solve() may be       **
+**                 called concurrently from several threads.        **
+**                 With cfg->threads > 1 the trials of a generation **
+**                 are evaluated in parallel; fn must then be       **
+**                 thread-safe. Results do not depend on threads.   **
+**                 If cfg->batch is set, it evaluates the trials    **
+**                 instead of fn, a whole generation per call or    **
+**                 one chunk per thread; fn may then be NULL.       **
+**                 Likewise cfg->delta, which is told the parameters**
+**                 a trial changed and keeps a state per member, so **
+**                 that its cost can follow the change only.        **
+**                 cfg->bound keeps trials within cfg->lo, cfg->hi, **
+**                 and cfg->feasible rejects trials before they are **
+**                 evaluated; see de_result.nrejected. cfg->surr_k  **
+**                 holds back trials a k-NN surrogate predicts to   **
+**                 lose, see desurr.c and de_result.nscreened.      **
+**                 cfg->init_pop and cfg->final_pop hand in the     **
+**                 first population and take out the last one.      **
+**                 cfg->local polishes the best member now and then **
+**                 with a local search, see delocal.c.              **
+**                 cfg->quant rounds trials to grids, and cfg->cache**
+**                 keeps the costs of evaluated ones, see decache.c.**
+**                 cfg->mode selects the generation-synchronous     **
+**                 loop or the asynchronous steady-state one.       **
+**                 cfg->checkpoint and cfg->resume save and restore **
+**                 the solver state, see deckpt.c; cfg->trace       **
+**                 records the progress, see detrace.c.             **
+**                 The run ends after genmax generations or when    **
+**                 one of the stop conditions in cfg is met, see    **
+**                 de_done().                                       **
+**                                                                  **
+** FUNCTIONS      :de_rng_uni(), evaluate_all(), run_sync(),        **
+**                 de_local_step(), de_run_async().                 **
+**                                                                  **
+** GLOBALS        :none                                             **
+**                                                                  **
+** PARAMETERS     :cfg             solver configuration             **
+**                 fn, user        objective function and its data  **
+**                 res             receives the final results       **
+**                                                                  **
+** PRECONDITIONS  :res->best is NULL or points to D doubles.        **
+**                                                                  **
+** POSTCONDITIONS :returns DE_OK and fills res, or an error code.   **
+**                 DE_EIO: cfg->resume failed or cfg->trace cannot  **
+**                 be opened, or res is filled but a checkpoint or  **
+**                 the trace could not be written.                  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   char  msg[128];
+   de_ctx *x;
+
+   int   i, j, k;         /* counting variables                 */
+   int   D;               /* Dimension of parameter vector      */
+   int   NP;              /* number of population members       */
+   double *cost;
+   double wall;
+   de_rng *rnd;
+   int   ret;
+
+   if (de_check(cfg,msg,sizeof(msg)) != DE_OK) return DE_EINVAL;
+   if (fn == NULL && cfg->batch == NULL && cfg->delta == NULL) return DE_EINVAL;
+
+   x = alloc_ctx(cfg);
+   if (x == NULL) return DE_ENOMEM;
+   x->cfg  = cfg;
+   x->fn   = fn;
+   x->user = user;
+   x->pool = NULL;
+   x->kernel = de_kernels[cfg->strategy];
+   if (cfg->threads > 1 && (x->pool = de_pool_create(cfg->threads)) == NULL)
+   {
+      free(x->arena);
+      return DE_ENOMEM;
+   }
+   if (cfg->cache > 0 && (x->cache = de_cache_create(cfg->D,cfg->cache)) == NULL)
+   {
+      de_pool_free(x->pool);
+      free(x->arena);
+      return DE_ENOMEM;
+   }
+
+   D        = cfg->D;
+   NP       = cfg->NP;
+   cost     = x->cost;
+   rnd      = &x->rnd;
+   x->t0    = de_time();
+
+/*-----Initialize random number generator-----------------------------*/
+
+ de_rng_init(rnd,cfg->rng,cfg->seed,0);  /* stream 0 of the seed */
+ x->nfeval    =  0;  /* reset number of function evaluations */
+ x->nreject   =  0;
+ x->nscreen   =  0;
+ x->nlocal    =  0;
+ x->nhit      =  0;
+ x->nmiss     =  0;
+ for (j=0; j<D; j++)  /* bounds of every parameter            */
+ {
+    x->lo[j] = (cfg->lo != NULL) ? cfg->lo[j] : cfg->inibound_l;
+    x->hi[j] = (cfg->hi != NULL) ? cfg->hi[j] : cfg->inibound_h;
+ }
+ x->gen       =  0;  /* generation counter reset */
+ x->NP        = NP;
+ de_adapt_init(x);
+ de_surr_init(x);
+ for (i=0; i<NP; i++)
+ {
+    x->slot[i]  = i;  /* members in rows 0..NP-1, trials after them */
+    x->tslot[i] = NP + i;
+ }
+ x->cmean = x->cvar = 0.;
+
+/*------A resumed run takes population, costs, counters and the-------*/
+/*------generator state from the checkpoint instead.------------------*/
+
+ if (cfg->resume && (ret = de_ckpt_load(x)) != DE_OK)
+ {
+    de_cache_free(x->cache);
+    de_pool_free(x->pool);
+    free(x->arena);
+    return ret;
+ }
+ if (cfg->resume && cfg->delta != NULL)
+ {
+    for (i=0; i<NP; i++) de_delta_full(x,i);
+ }
+
+/*------Initialization------------------------------------------------*/
+/*------Right now this part is kept fairly simple and just generates--*/
+/*------random numbers in the range [-initfac, +initfac]. You might---*/
+/*------want to extend the init part such that you can initialize-----*/
+/*------each parameter separately.------------------------------------*/
+/*------Each parameter is now drawn within its own bounds, and with----*/
+/*------cfg->feasible a member is drawn up to DE_INIT_TRIES times------*/
+/*------until it is feasible; the last draw is evaluated regardless.--*/
+/*------cfg->init_pop gives the members instead; they are evaluated---*/
+/*------as they are. All are rounded to the grids of cfg->quant.------*/
+
+ if (!cfg->resume)
+ {
+   for (i=0; i<NP && cfg->init_pop != NULL; i++)
+   {
+      de_narrow(D,TRIAL(i),cfg->init_pop + (size_t)i*D);
+      de_quantize(x,TRIAL(i),0,D);
+   }
+   for (i=0; i<NP && cfg->init_pop == NULL; i++)
+   {
+      k = 0;
+      do                  /* drawn again while not feasible    */
+      {
+	 for (j=0; j<D; j++) /* spread initial population members */
+	 {
+	    TRIAL(i)[j] = x->lo[j] + de_rng_uni(rnd)*(x->hi[j] - x->lo[j]);
+	 }
+	 de_quantize(x,TRIAL(i),0,D);
+      }while(cfg->feasible != NULL && ++k < DE_INIT_TRIES &&
+             !cfg->feasible(D,WIDE(TRIAL(i)),cfg->feasible_user));
+   }
+   x->full = 1;                      /* no parent states   */
+   for (i=0; i<NP && cfg->delta != NULL; i++)
+   {
+      x->tlo[i]  = 0;
+      x->tlen[i] = D;
+   }
+   evaluate_all(x);                  /* obj. funct. values */
+   de_surr_add(x);
+   de_cache_add(x);
+   x->full = 0;
+   for (i=0; i<NP; i++)
+   {
+      cost[i] = x->tcost[i];
+      j = x->slot[i];                /* all trials become members */
+      x->slot[i]  = x->tslot[i];
+      x->tslot[i] = j;
+   }
+   x->cmin = cost[0];
+   x->imin = 0;
+   for (i=1; i<NP; i++)
+   {
+      if (cost[i]<x->cmin)
+      {
+	 x->cmin = cost[i];
+	 x->imin = i;
+      }
+   }
+
+   de_widen(D,x->best,MEM(x->imin));         /* save best member ever          */
+   assignr(D,x->bestit,MEM(x->imin));        /* save best member of generation */
+   de_stats(x);
+   x->last_imp  = x->gen;
+   x->last_cmin = x->cmin;
+   x->lpol      = x->gen;
+ }
+ x->stop      = -1;
+
+ if (de_ckpt_open(x) != DE_OK)
+ {
+    de_cache_free(x->cache);
+    de_pool_free(x->pool);
+    free(x->arena);
+    return DE_ENOMEM;
+ }
+ if ((ret = de_trace_open(x)) != DE_OK)
+ {
+    de_ckpt_close(x);
+    de_cache_free(x->cache);
+    de_pool_free(x->pool);
+    free(x->arena);
+    return ret;
+ }
+
+#ifdef DE_PROFILE
+   de_prof_start(x);
+#endif
+   if (cfg->mode == DE_MODE_ASYNC)
+   {
+      if (de_run_async(x) != DE_OK)
+      {
+#ifdef DE_PROFILE
+         de_prof_stop(x,&res->prof);
+#endif
+         de_trace_close(x);
+         de_ckpt_close(x);
+         de_cache_free(x->cache);
+         de_pool_free(x->pool);
+         free(x->arena);
+         return DE_ENOMEM;
+      }
+   }
+   else run_sync(x);
+#ifdef DE_PROFILE
+   de_prof_stop(x,&res->prof);
+#endif
+   ret = de_trace_close(x);
+   if (de_ckpt_close(x) != DE_OK) ret = DE_EIO;
+
+   wall = de_time() - x->t0;
+   res->cmin   = x->cmin;
+   res->gen    = x->gen;
+   res->nfeval = x->nfeval;
+   res->cmean  = x->cmean;
+   res->cvar   = x->cvar;
+   res->stop   = x->stop;
+   res->nrejected = x->nreject;
+   res->nscreened = x->nscreen;
+   res->nlocal = x->nlocal;
+   res->nhit   = x->nhit;
+   res->nmiss  = x->nmiss;
+   res->wall   = wall;
+   res->evals_per_sec = (wall > 0) ? x->nfeval/wall : 0;
+   res->utilization   = (wall > 0) ?
+                        1e-9*x->busy_ns/(wall*de_pool_size(x->pool)) : 0;
+   if (res->best != NULL) assignd(D,res->best,x->best);
+   for (i=0; i<x->NP && cfg->final_pop != NULL; i++)
+   {
+      de_widen(D,cfg->final_pop + (size_t)i*D,MEM(i));
+   }
+
+   de_cache_free(x->cache);
+   de_pool_free(x->pool);
+   free(x->arena);
+   return ret;
+}
+
+/*-----------End of de_solve()--------------------------------------*/
@@ -0,0 +1,161 @@
+# include "de.h"
+# include "deint.h"
+
+/*------------------------Surrogate pre-screening-----------------------*/
+/*------With cfg->surr_k > 0 every evaluated point (x, cost) goes into--*/
+/*------an archive of the last cfg->surr_archive evaluations. Before----*/
+/*------the trials of a generation are evaluated, each one's cost is----*/
+/*------predicted by the inverse distance weighted mean of its surr_k---*/
+/*------nearest archive points, distances taken in units of the bounds.-*/
+/*------Only the share cfg->surr_keep of the trials whose prediction----*/
+/*------beats their member by most are passed to the objective; the----*/
+/*------others get cost NaN like trials cfg->feasible rejects, lose the-*/
+/*------selection and are counted in x->nscreen, not in nfeval. The----*/
+/*------model is refitted by simply adding points, so it follows the----*/
+/*------population at no cost. Synchronous mode only: the trials of a--*/
+/*------generation must all be known before any is evaluated.----------*/
+
+#define SURR_EPS  1e-24   /* keeps the weights finite           */
+
+
+void de_surr_init(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Empties the archive, clears the marks of held back trials and    **
+** sets the scales of the distances from the bounds.                **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i;
+
+   x->an   = 0;
+   x->apos = 0;
+   if (x->cfg->surr_k == 0) return;
+   for (i=0; i<x->cfg->NP; i++) x->skip[i] = 0;
+   for (i=0; i<x->cfg->D; i++)   /* distances in units of the bounds */
+   {
+      x->rs[i] = (x->hi[i] > x->lo[i]) ? 1.0/(x->hi[i] - x->lo[i]) : 1.0;
+   }
+}
+
+
+void de_surr_add(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Adds the trials evaluated in the last pass with their costs to   **
+** the archive, replacing the oldest points once it is full.        **
+** Trials that were not evaluated (cost NaN) are left out.          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int D = x->cfg->D, i, j;
+   double *a;
+   DE_PROF_T(pt);
+
+   if (x->cfg->surr_k == 0) return;
+   for (i=0; i<x->NP; i++)
+   {
+      if (isnan(x->tcost[i])) continue;
+      a = x->ax + (size_t)x->apos*D;  /* kept in units of the bounds */
+      for (j=0; j<D; j++) a[j] = TRIAL(i)[j]*x->rs[j];
+      x->acost[x->apos] = x->tcost[i];
+      x->apos = (x->apos+1)%x->acap;
+      if (x->an < x->acap) x->an++;
+   }
+   DE_PROF_ADD(DE_PH_EVAL,pt);
+}
+
+
+static void predict(void *arg, int i)
+/**C*F****************************************************************
+**                                                                  **
+** Pool task: predicts the cost of trial i from its k nearest       **
+** archive points and stores by how much it is expected to beat     **
+** member i in pm[i] (negative: better). The k best distances are   **
+** kept sorted by insertion; k is at most DE_SURR_KMAX. Distances   **
+** are summed in four independent parts and abandoned, after every  **
+** 8 parameters, once they exceed the k-th best so far.             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_ctx *x = (de_ctx *)arg;
+   const double *a;
+   double *t = x->ts + (size_t)i*x->cfg->D;
+   double dk[DE_SURR_KMAX], ck[DE_SURR_KMAX];
+   double d, d0, d1, d2, d3, w, lim = HUGE_VAL, sw = 0, sc = 0;
+   int    D = x->cfg->D, k = x->cfg->surr_k, n = 0, m, j, e;
+
+   if (k > x->an) k = x->an;
+   for (j=0; j<D; j++) t[j] = TRIAL(i)[j]*x->rs[j];
+   for (m=0; m<x->an; m++)
+   {
+      a = x->ax + (size_t)m*D;
+      d0 = d1 = d2 = d3 = 0;
+      for (j=0; j<D; j=e)
+      {
+         for (e=(j+8 < D) ? j+8 : D; j+4<=e; j+=4)
+         {
+            d0 += (t[j]   - a[j]  )*(t[j]   - a[j]  );
+            d1 += (t[j+1] - a[j+1])*(t[j+1] - a[j+1]);
+            d2 += (t[j+2] - a[j+2])*(t[j+2] - a[j+2]);
+            d3 += (t[j+3] - a[j+3])*(t[j+3] - a[j+3]);
+         }
+         for (; j<e; j++) d0 += (t[j] - a[j])*(t[j] - a[j]);
+         if ((d0 + d1) + (d2 + d3) >= lim) break;
+      }
+      d = (d0 + d1) + (d2 + d3);
+      if (d >= lim) continue;
+      if (n < k) n++;
+      for (j=n-1; j>0 && dk[j-1] > d; j--)   /* insert, dropping the last */
+      {
+         dk[j] = dk[j-1];
+         ck[j] = ck[j-1];
+      }
+      dk[j] = d;
+      ck[j] = x->acost[m];
+      if (n == k) lim = dk[k-1];
+   }
+   for (j=0; j<n; j++)
+   {
+      w   = 1.0/(dk[j] + SURR_EPS);
+      sw += w;
+      sc += w*ck[j];
+   }
+   x->pm[i] = sc/sw - x->cost[i];
+   if (isnan(x->pm[i])) x->pm[i] = HUGE_VAL;
+}
+
+
+static int cmp_double(const void *a, const void *b)
+{
+   double u = *(const double *)a, v = *(const double *)b;
+   return (u < v) ? -1 : (u > v) ? 1 : 0;
+}
+
+
+void de_surr_screen(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Marks in skip[] the trials of this generation that are not to be **
+** evaluated: all but the ceil(surr_keep*NP) with the lowest        **
+** predicted margins. Ties at the threshold are all evaluated.      **
+** Nothing is held back while the archive is empty.                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   int NP = x->NP, keep, i;
+   double thr;
+   DE_PROF_T(pt);
+
+   if (cfg->surr_k == 0 || x->an == 0) return;
+   de_pool_run(x->pool,NP,predict,x);
+
+   keep = (int)ceil(cfg->surr_keep*NP);
+   if (keep > NP) keep = NP;
+   for (i=0; i<NP; i++) x->ps[i] = x->pm[i];
+   qsort(x->ps,NP,sizeof(double),cmp_double);
+   thr = x->ps[keep-1];
+   for (i=0; i<NP; i++) x->skip[i] = (x->pm[i] > thr);
+   DE_PROF_ADD(DE_PH_EVAL,pt);
+}
@@ -0,0 +1,188 @@
+# include "de.h"
+# include <pthread.h>
+
+/*------------------------Thread pool-----------------------------------*/
+/*------A fixed set of workers executes fn(arg,i) for i=0..n-1. The----*/
+/*------indexes are handed out one by one from a shared counter, so-----*/
+/*------a worker that finishes early simply takes the next index.------*/
+
+struct de_pool
+{
+   int   nthreads;        /* workers plus the calling thread    */
+   pthread_t *tid;
+   pthread_mutex_t lock;
+   pthread_cond_t  wake;  /* a new job was posted               */
+   pthread_cond_t  done;  /* a worker finished the job          */
+   long  job;             /* job counter, changes on every post */
+   int   busy;            /* workers still inside the job       */
+   int   quit;
+   de_task fn;            /* current job                        */
+   void  *arg;
+   int   n;
+   int   next;            /* next index to hand out             */
+   int   started;         /* workers numbered so far            */
+};
+
+static __thread const de_pool *self_pool;  /* pool of a worker thread */
+static __thread int self_index;            /* its number in the pool  */
+
+
+static void run_job(de_pool *p)
+/**C*F****************************************************************
+**                                                                  **
+** Takes indexes of the current job until none are left.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i;
+   while ((i = __atomic_fetch_add(&p->next,1,__ATOMIC_RELAXED)) < p->n)
+   {
+      p->fn(p->arg,i);
+   }
+}
+
+
+static void *worker(void *arg)
+/**C*F****************************************************************
+**                                                                  **
+** Main loop of a pool thread: wait for a job, work on it, report.  **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_pool *p = (de_pool *)arg;
+   long seen = 0;
+
+   self_pool  = p;
+   self_index = __atomic_add_fetch(&p->started,1,__ATOMIC_RELAXED);
+
+   pthread_mutex_lock(&p->lock);
+   for (;;)
+   {
+      while (!p->quit && p->job == seen) pthread_cond_wait(&p->wake,&p->lock);
+      if (p->quit) break;
+      seen = p->job;
+      pthread_mutex_unlock(&p->lock);
+
+      run_job(p);
+
+      pthread_mutex_lock(&p->lock);
+      if (--p->busy == 0) pthread_cond_signal(&p->done);
+   }
+   pthread_mutex_unlock(&p->lock);
+   return NULL;
+}
+
+
+de_pool *de_pool_create(int nthreads)
+/**C*F****************************************************************
+**                                                                  **
+** Creates a pool of nthreads threads; the thread calling           **
+** de_pool_run() counts as one of them. Returns NULL on failure.    **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_pool *p;
+   int k;
+
+   p = (de_pool *)calloc(1,sizeof(de_pool));
+   if (p == NULL) return NULL;
+   if (nthreads < 1) nthreads = 1;
+   p->tid = (pthread_t *)calloc(nthreads,sizeof(pthread_t));
+   if (p->tid == NULL)
+   {
+      free(p);
+      return NULL;
+   }
+   pthread_mutex_init(&p->lock,NULL);
+   pthread_cond_init(&p->wake,NULL);
+   pthread_cond_init(&p->done,NULL);
+   p->nthreads = 1;
+   for (k=1; k<nthreads; k++)
+   {
+      if (pthread_create(&p->tid[k],NULL,worker,p) != 0) break;
+      p->nthreads++;
+   }
+   return p;
+}
+
+
+void de_pool_run(de_pool *p, int n, de_task fn, void *arg)
+/**C*F****************************************************************
+**                                                                  **
+** Executes fn(arg,i) for i=0..n-1 on all threads of the pool and   **
+** returns when every call has finished. p may be NULL, in which    **
+** case the calls are made one after another by the caller.         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int i;
+
+   if (p == NULL || p->nthreads == 1 || n == 1)
+   {
+      for (i=0; i<n; i++) fn(arg,i);
+      return;
+   }
+
+   pthread_mutex_lock(&p->lock);
+   p->fn   = fn;
+   p->arg  = arg;
+   p->n    = n;
+   p->next = 0;
+   p->busy = p->nthreads - 1;
+   p->job++;
+   pthread_cond_broadcast(&p->wake);
+   pthread_mutex_unlock(&p->lock);
+
+   run_job(p);
+
+   pthread_mutex_lock(&p->lock);
+   while (p->busy > 0) pthread_cond_wait(&p->done,&p->lock);
+   pthread_mutex_unlock(&p->lock);
+}
+
+
+int de_pool_size(const de_pool *p)
+/**C*F****************************************************************
+**                                                                  **
+** Number of threads working on a job, including the caller.        **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   return (p == NULL) ? 1 : p->nthreads;
+}
+
+
+int de_pool_self(const de_pool *p)
+/**C*F****************************************************************
+**                                                                  **
+** Number of the calling thread in pool p, 0..de_pool_size(p)-1;    **
+** 0 for the thread that calls de_pool_run(), whichever pool it may **
+** be a worker of itself.                                           **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   return (p != NULL && self_pool == p) ? self_index : 0;
+}
+
+
+void de_pool_free(de_pool *p)
+/**C*F****************************************************************
+**                                                                  **
+** Stops the workers and releases the pool.                         **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   int k;
+
+   if (p == NULL) return;
+   pthread_mutex_lock(&p->lock);
+   p->quit = 1;
+   pthread_cond_broadcast(&p->wake);
+   pthread_mutex_unlock(&p->lock);
+   for (k=1; k<p->nthreads; k++) pthread_join(p->tid[k],NULL);
+   pthread_mutex_destroy(&p->lock);
+   pthread_cond_destroy(&p->wake);
+   pthread_cond_destroy(&p->done);
+   free(p->tid);
+   free(p);
+}
@@ -0,0 +1,233 @@
+# include "de.h"
+# include "deint.h"
+# include <pthread.h>
+
+/*------------------------Binary trace writer---------------------------*/
+/*------Every cfg->trace_every generations a de_trace_gen record, and---*/
+/*------every cfg->trace_pop generations a snapshot of the population,--*/
+/*------is put into a ring buffer. A writer thread takes the bytes out--*/
+/*------and writes them to cfg->trace, so the generation loop neither---*/
+/*------formats text nor waits for the disk. Only if the ring is full---*/
+/*------does the loop wait for the writer. tools/tracecsv.c converts----*/
+/*------the file to CSV; the format is described in de.h.---------------*/
+
+#define TRACE_RING (1 << 20)   /* minimum ring size in bytes            */
+
+struct de_tracer
+{
+   FILE  *fp;
+   pthread_t tid;
+   pthread_mutex_t lock;
+   pthread_cond_t  more;  /* bytes were put into the ring       */
+   pthread_cond_t  room;  /* bytes were taken out of the ring   */
+   char  *ring;
+   size_t cap;            /* size of ring                       */
+   size_t head, tail;     /* bytes put in and taken out so far  */
+   int    stop;           /* writer shall drain and exit        */
+   int    failed;         /* a write went wrong                 */
+};
+
+
+static void trace_put(de_tracer *t, const void *p, size_t n)
+/**C*F****************************************************************
+**                                                                  **
+** Appends n bytes to the ring, waiting for room if necessary. n    **
+** must not exceed t->cap.                                          **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   size_t at, m;
+
+   pthread_mutex_lock(&t->lock);
+   while (t->cap - (t->head - t->tail) < n) pthread_cond_wait(&t->room,&t->lock);
+   at = t->head % t->cap;
+   m  = (t->cap - at < n) ? t->cap - at : n;
+   memcpy(t->ring+at,p,m);
+   memcpy(t->ring,(const char *)p+m,n-m);
+   t->head += n;
+   pthread_cond_signal(&t->more);
+   pthread_mutex_unlock(&t->lock);
+}
+
+
+static void *trace_writer(void *arg)
+/**C*F****************************************************************
+**                                                                  **
+** Writer thread: writes out the ring until trace_close() asks it   **
+** to stop and the ring is empty.                                   **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_tracer *t = (de_tracer *)arg;
+   size_t head, at, n;
+
+   pthread_mutex_lock(&t->lock);
+   for (;;)
+   {
+      while (t->head == t->tail && !t->stop) pthread_cond_wait(&t->more,&t->lock);
+      if (t->head == t->tail) break;
+      head = t->head;
+      pthread_mutex_unlock(&t->lock);
+
+      at = t->tail % t->cap;                /* [tail,head) is ours */
+      n  = head - t->tail;
+      if (n > t->cap - at) n = t->cap - at;
+      if (fwrite(t->ring+at,1,n,t->fp) != n) t->failed = 1;
+
+      pthread_mutex_lock(&t->lock);
+      t->tail += n;
+      pthread_cond_signal(&t->room);
+   }
+   pthread_mutex_unlock(&t->lock);
+   return NULL;
+}
+
+
+int de_trace_open(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Opens cfg->trace, writes the file header unless a resumed run    **
+** appends, and starts the writer. Returns DE_OK, DE_EIO if the     **
+** file cannot be opened, or DE_ENOMEM.                             **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   de_tracer *t;
+   de_trace_head h;
+   size_t pop;
+
+   x->trace = NULL;
+   if (cfg->trace == NULL) return DE_OK;
+
+   t = (de_tracer *)calloc(1,sizeof(de_tracer));
+   if (t == NULL) return DE_ENOMEM;
+   pop = sizeof(de_trace_rec) + sizeof(de_trace_pop) +
+         (size_t)cfg->NP*(cfg->D+1)*sizeof(double);
+   t->cap  = (cfg->trace_pop > 0 && 2*pop > TRACE_RING) ? 2*pop : TRACE_RING;
+   t->ring = (char *)malloc(t->cap);
+   if (t->ring == NULL)
+   {
+      free(t);
+      return DE_ENOMEM;
+   }
+   t->fp = fopen(cfg->trace,cfg->resume ? "ab" : "wb");
+   if (t->fp == NULL)
+   {
+      free(t->ring);
+      free(t);
+      return DE_EIO;
+   }
+   if (ftell(t->fp) == 0)
+   {
+      memset(&h,0,sizeof(h));
+      memcpy(h.magic,DE_TRACE_MAGIC,8);
+      h.version  = DE_TRACE_VERSION;
+      h.D        = cfg->D;
+      h.NP       = cfg->NP;
+      h.strategy = cfg->strategy;
+      if (fwrite(&h,sizeof(h),1,t->fp) != 1) t->failed = 1;
+   }
+   pthread_mutex_init(&t->lock,NULL);
+   pthread_cond_init(&t->more,NULL);
+   pthread_cond_init(&t->room,NULL);
+   if (pthread_create(&t->tid,NULL,trace_writer,t) != 0)
+   {
+      pthread_mutex_destroy(&t->lock);
+      pthread_cond_destroy(&t->more);
+      pthread_cond_destroy(&t->room);
+      fclose(t->fp);
+      free(t->ring);
+      free(t);
+      return DE_ENOMEM;
+   }
+   x->trace = t;
+   return DE_OK;
+}
+
+
+void de_trace_step(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Records generation x->gen, if it is due, and the population if a **
+** snapshot is due.                                                 **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   const de_config *cfg = x->cfg;
+   de_tracer *t = x->trace;
+   de_trace_rec r;
+   de_trace_gen g;
+   de_trace_pop p;
+   double v;
+   int i, j;
+
+   if (t == NULL) return;
+   if (x->gen%cfg->trace_every == 0)
+   {
+      r.type   = DE_TRACE_GEN;
+      r.len    = sizeof(g);
+      g.gen    = x->gen;
+      g.pad    = 0;
+      g.nfeval = x->nfeval;
+      g.cmin   = x->cmin;
+      g.cmean  = x->cmean;
+      g.cvar   = x->cvar;
+      g.wall   = de_time() - x->t0;
+      trace_put(t,&r,sizeof(r));
+      trace_put(t,&g,sizeof(g));
+   }
+   if (cfg->trace_pop > 0 && x->gen%cfg->trace_pop == 0)
+   {
+      r.type = DE_TRACE_POP;
+      r.len  = sizeof(p) + (size_t)x->NP*(cfg->D+1)*sizeof(double);
+      p.gen  = x->gen;
+      p.NP   = x->NP;
+      trace_put(t,&r,sizeof(r));
+      trace_put(t,&p,sizeof(p));
+      for (i=0; i<x->NP; i++)
+      {
+         if (sizeof(de_real) == sizeof(double))
+         {
+            trace_put(t,MEM(i),cfg->D*sizeof(double));
+            continue;
+         }
+         for (j=0; j<cfg->D; j++)   /* rows are always doubles */
+         {
+            v = MEM(i)[j];
+            trace_put(t,&v,sizeof(double));
+         }
+      }
+      trace_put(t,x->cost,x->NP*sizeof(double));
+   }
+}
+
+
+int de_trace_close(de_ctx *x)
+/**C*F****************************************************************
+**                                                                  **
+** Lets the writer drain the ring, stops it and closes the file.    **
+** Returns DE_OK, or DE_EIO if anything could not be written.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   de_tracer *t = x->trace;
+   int ret;
+
+   if (t == NULL) return DE_OK;
+   pthread_mutex_lock(&t->lock);
+   t->stop = 1;
+   pthread_cond_signal(&t->more);
+   pthread_mutex_unlock(&t->lock);
+   pthread_join(t->tid,NULL);
+
+   if (fclose(t->fp) != 0) t->failed = 1;
+   ret = t->failed ? DE_EIO : DE_OK;
+   pthread_mutex_destroy(&t->lock);
+   pthread_cond_destroy(&t->more);
+   pthread_cond_destroy(&t->room);
+   free(t->ring);
+   free(t);
+   x->trace = NULL;
+   return ret;
+}
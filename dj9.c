@@ -10,3 +10,87 @@ double evaluate(int D, double tmp[], long *nfeval)
     s += tmp[i] * tmp[i];
   return s;
 }
+
+void evaluate_batch(int D, int n, const double *X, size_t stride, double *costs)
+{
+/* same function for n members at once, row i of X starts at X+i*stride. */
+/* Four members are summed side by side, each in the order of evaluate(), */
+/* which hides the latency of the additions and packs into SIMD lanes.    */
+  double s0, s1, s2, s3;
+  const double *x0, *x1, *x2, *x3;
+  int i, j;
+  for (i = 0; i + 4 <= n; i += 4)
+  {
+    x0 = X + (size_t)i * stride;
+    x1 = x0 + stride;
+    x2 = x1 + stride;
+    x3 = x2 + stride;
+    s0 = s1 = s2 = s3 = 0;
+    for (j = 0; j < D; j++)
+    {
+      s0 += x0[j] * x0[j];
+      s1 += x1[j] * x1[j];
+      s2 += x2[j] * x2[j];
+      s3 += x3[j] * x3[j];
+    }
+    costs[i] = s0;
+    costs[i + 1] = s1;
+    costs[i + 2] = s2;
+    costs[i + 3] = s3;
+  }
+  for (; i < n; i++)
+    costs[i] = evaluate(D, (double *)(X + (size_t)i * stride), NULL);
+}
+
+/* Incremental version for exponential crossover: the sum is kept in     */
+/* blocks of DJ9_BLOCK squares, so that a trial which changes parameters */
+/* lo..lo+len-1 (mod D) only resums the blocks they fall into. Blocks    */
+/* are resummed rather than corrected, so the cached sums do not drift.  */
+#define DJ9_BLOCK 32
+
+int evaluate_delta_state(int D)
+{
+/* doubles of state per member: one sum per block */
+  return (D + DJ9_BLOCK - 1) / DJ9_BLOCK;
+}
+
+static void dj9_blocks(int D, const double tmp[], double state[], int lo, int hi)
+{
+/* resums the blocks holding parameters lo..hi-1 */
+  int b, j, e;
+  for (b = lo / DJ9_BLOCK; b * DJ9_BLOCK < hi; b++)
+  {
+    e = (b + 1) * DJ9_BLOCK < D ? (b + 1) * DJ9_BLOCK : D;
+    state[b] = 0;
+    for (j = b * DJ9_BLOCK; j < e; j++)
+      state[b] += tmp[j] * tmp[j];
+  }
+}
+
+double evaluate_delta(int D, const double tmp[], int lo, int len,
+                      const double *pstate, double *state)
+{
+/* same function, from the block sums of the parent in pstate (or from */
+/* scratch if NULL); the block sums of tmp are left in state.           */
+  double s;
+  int nb = evaluate_delta_state(D);
+  int b;
+  if (pstate == NULL || len >= D)
+    dj9_blocks(D, tmp, state, 0, D);
+  else
+  {
+    for (b = 0; b < nb; b++)
+      state[b] = pstate[b];
+    if (lo + len <= D)
+      dj9_blocks(D, tmp, state, lo, lo + len);
+    else
+    {
+      dj9_blocks(D, tmp, state, lo, D);
+      dj9_blocks(D, tmp, state, 0, lo + len - D);
+    }
+  }
+  s = 0;
+  for (b = 0; b < nb; b++)
+    s += state[b];
+  return s;
+}
@@ -0,0 +1,106 @@
+# include "../de.h"
+# include <string.h>
+
+/*------------------------Trace to CSV converter------------------------*/
+/*------Reads a trace written with --trace (format in de.h) and prints--*/
+/*------gen,nfeval,cmin,cmean,cvar,wall per generation record. With-----*/
+/*-------p the population snapshots are printed instead, one line-------*/
+/*------gen,member,cost,x0,...,x(D-1) per member.----------------------*/
+/*                                                                      */
+/*------cc -O2 tools/tracecsv.c -o tracecsv-----------------------------*/
+
+
+static int read_head(FILE *fp, de_trace_head *h)
+/**C*F****************************************************************
+**                                                                  **
+** Reads and checks a file header. Returns 0 on success.            **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   if (fread(h,sizeof(*h),1,fp) != 1) return -1;
+   if (memcmp(h->magic,DE_TRACE_MAGIC,8) != 0) return -1;
+   if (h->version != DE_TRACE_VERSION || h->D <= 0 || h->NP <= 0) return -1;
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   de_trace_head h;
+   de_trace_rec r;
+   de_trace_gen g;
+   de_trace_pop p;
+   double *buf;
+   FILE  *fp;
+   int   pop, n, i, j;
+
+   pop = (argc == 3 && strcmp(argv[1],"-p") == 0);
+   if (argc != 2 + pop)
+   {
+      printf("\nUsage : tracecsv [-p] <trace-file>\n");
+      exit(1);
+   }
+   fp = fopen(argv[1+pop],"rb");
+   if (fp == NULL)
+   {
+      printf("\nCannot open trace file\n");
+      exit(1);
+   }
+   if (read_head(fp,&h) != 0)
+   {
+      printf("\nNot a trace file: %s\n",argv[1+pop]);
+      exit(1);
+   }
+   buf = (double *)malloc((size_t)h.NP*(h.D+1)*sizeof(double));
+   if (buf == NULL)
+   {
+      printf("\nOut of memory\n");
+      exit(1);
+   }
+
+   if (pop)
+   {
+      printf("gen,member,cost");
+      for (j=0; j<h.D; j++) printf(",x%d",j);
+      printf("\n");
+   }
+   else printf("gen,nfeval,cmin,cmean,cvar,wall\n");
+
+   while (fread(&r,sizeof(r),1,fp) == 1)
+   {
+      if (memcmp(&r,DE_TRACE_MAGIC,sizeof(r)) == 0)   /* appended by a resumed run */
+      {
+         fseek(fp,-(long)sizeof(r),SEEK_CUR);
+         if (read_head(fp,&h) != 0) break;
+         continue;
+      }
+      if (r.type == DE_TRACE_GEN && r.len == (int)sizeof(g))
+      {
+         if (fread(&g,sizeof(g),1,fp) != 1) break;
+         if (!pop)
+         {
+            printf("%d,%ld,%.17g,%.17g,%.17g,%.9g\n",g.gen,(long)g.nfeval,
+                   g.cmin,g.cmean,g.cvar,g.wall);
+         }
+      }
+      else if (r.type == DE_TRACE_POP && r.len >= (int)sizeof(p))
+      {
+         if (fread(&p,sizeof(p),1,fp) != 1) break;
+         n = p.NP;
+         if (n < 1 || n > h.NP ||
+             r.len != (int)(sizeof(p) + (size_t)n*(h.D+1)*sizeof(double))) break;
+         if (fread(buf,sizeof(double),(size_t)n*(h.D+1),fp) != (size_t)n*(h.D+1)) break;
+         for (i=0; pop && i<n; i++)
+         {
+            printf("%d,%d,%.17g",p.gen,i,buf[(size_t)n*h.D+i]);
+            for (j=0; j<h.D; j++) printf(",%.17g",buf[(size_t)i*h.D+j]);
+            printf("\n");
+         }
+      }
+      else if (fseek(fp,r.len,SEEK_CUR) != 0) break;   /* unknown record */
+   }
+
+   fclose(fp);
+   free(buf);
+   return(0);
+}
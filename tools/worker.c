@@ -0,0 +1,112 @@
+# include "../de.h"
+# include <string.h>
+# include <unistd.h>
+
+/*------------------------Reference evaluator worker--------------------*/
+/*------Serves the frames of deext.c on stdin/stdout with evaluate()----*/
+/*------of the linked objective file until stdin is closed; the---------*/
+/*------protocol is described in deext.c. A simulator wrapper does the--*/
+/*------same around its own evaluation. For testing the pool, the-------*/
+/*------worker can be told to crash (exit) or hang (sleep forever) when-*/
+/*------it has answered a given number of frames.----------------------*/
+/*                                                                      */
+/*------cc -O2 tools/worker.c dj9.c -o deworker-------------------------*/
+/*------./de dj9.dat out --eval-cmd=./deworker --eval-workers=4---------*/
+/*------deworker [--crash-after=n] [--hang-after=n] [--delay=us]--------*/
+
+double extern evaluate(int D, double tmp[], long *nfeval);
+
+
+static int get(void *p, size_t n)
+/**C*F****************************************************************
+**                                                                  **
+** Reads exactly n bytes from stdin. Returns 0, or -1 at EOF.       **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   ssize_t r;
+
+   while (n > 0)
+   {
+      r = read(0,p,n);
+      if (r <= 0) return -1;
+      p  = (char *)p + r;
+      n -= r;
+   }
+   return 0;
+}
+
+
+static int put(const void *p, size_t n)
+/**C*F****************************************************************
+**                                                                  **
+** Writes exactly n bytes to stdout. Returns 0, or -1 on error.     **
+**                                                                  **
+***C*F*E*************************************************************/
+{
+   ssize_t r;
+
+   while (n > 0)
+   {
+      r = write(1,p,n);
+      if (r <= 0) return -1;
+      p  = (const char *)p + r;
+      n -= r;
+   }
+   return 0;
+}
+
+
+int main(int argc, char *argv[])
+{
+   de_ext_hello h;
+   uint32_t n, cap = 0;
+   double  *X = NULL, *costs = NULL;
+   long    nfeval = 0, frames = 0, crash = -1, hang = -1, delay = 0;
+   int     k, i;
+
+   for (k=1; k<argc; k++)
+   {
+      if      (strncmp(argv[k],"--crash-after=",14) == 0) crash = atol(argv[k]+14);
+      else if (strncmp(argv[k],"--hang-after=",13) == 0)  hang  = atol(argv[k]+13);
+      else if (strncmp(argv[k],"--delay=",8) == 0)        delay = atol(argv[k]+8);
+      else
+      {
+         fprintf(stderr,"\nError! unknown option %s\n",argv[k]);
+         return 1;
+      }
+   }
+
+   if (get(&h,sizeof(h)) != 0 || memcmp(h.magic,DE_EXT_MAGIC,8) != 0 || h.D <= 0)
+   {
+      fprintf(stderr,"\nError! not started by the evaluator pool\n");
+      return 1;
+   }
+   if (put(DE_EXT_MAGIC,8) != 0) return 1;
+
+   while (get(&n,sizeof(n)) == 0)
+   {
+      if (n > cap)
+      {
+         free(X);
+         free(costs);
+         cap   = n;
+         X     = (double *)malloc((size_t)cap*h.D*sizeof(double));
+         costs = (double *)malloc((size_t)cap*sizeof(double));
+         if (X == NULL || costs == NULL) return 1;
+      }
+      if (get(X,(size_t)n*h.D*sizeof(double)) != 0) break;
+      if (frames == crash) return 2;
+      if (frames == hang) for (;;) pause();
+      for (i=0; i<(int)n; i++)
+      {
+         costs[i] = evaluate(h.D,X+(size_t)i*h.D,&nfeval);
+         if (delay > 0) usleep(delay);
+      }
+      if (put(costs,(size_t)n*sizeof(double)) != 0) return 1;
+      frames++;
+   }
+   free(X);
+   free(costs);
+   return 0;
+}